@@ -0,0 +1,127 @@
+#include "book_columns.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace app {
+    namespace {
+        // Деление с округлением вниз: интервалы лет до нашей эры тоже начинаются с кратного bucket
+        int FloorDiv(int value, int divisor) {
+            int quotient = value / divisor;
+            return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+        }
+    }
+
+    BookColumns::BookColumns(const std::vector<domain::BookData>& books) {
+        std::unordered_map<std::string, std::uint32_t> author_index;
+        authors_.reserve(books.size());
+        years_.reserve(books.size());
+        title_offsets_.reserve(books.size() + 1);
+        title_offsets_.push_back(0);
+        for (const auto& book : books) {
+            auto [it, inserted] = author_index.try_emplace(book.author_id, static_cast<std::uint32_t>(author_ids_.size()));
+            if (inserted) {
+                author_ids_.push_back(book.author_id);
+                author_names_.push_back(book.author_name);
+            }
+            authors_.push_back(it->second);
+
+            if (book.year < std::numeric_limits<std::int16_t>::min() || book.year > std::numeric_limits<std::int16_t>::max()) {
+                throw std::out_of_range("Publication year does not fit the columnar snapshot");
+            }
+            years_.push_back(static_cast<std::int16_t>(book.year));
+
+            titles_ += book.title;
+            title_offsets_.push_back(static_cast<std::uint32_t>(titles_.size()));
+        }
+        if (!years_.empty()) {
+            auto [min, max] = std::minmax_element(years_.begin(), years_.end());
+            min_year_ = *min;
+            max_year_ = *max;
+        }
+    }
+
+    std::string_view BookColumns::GetTitle(std::size_t book) const {
+        auto begin = title_offsets_.at(book);
+        return std::string_view{titles_}.substr(begin, title_offsets_.at(book + 1) - begin);
+    }
+
+    std::size_t BookColumns::CountInYearRange(int from, int to) const {
+        std::size_t count = 0;
+        for (auto year : years_) {
+            count += static_cast<std::size_t>((year >= from) & (year <= to));
+        }
+        return count;
+    }
+
+    std::vector<std::pair<int, std::size_t>> BookColumns::CountByYear(int from, int to) const {
+        std::vector<std::pair<int, std::size_t>> result;
+        auto counts = CountYears();
+        from = std::max<int>(from, min_year_);
+        to = std::min<int>(to, max_year_);
+        for (int year = from; year <= to && !counts.empty(); ++year) {
+            if (auto count = counts[year - min_year_]) {
+                result.emplace_back(year, count);
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::pair<int, std::size_t>> BookColumns::CountByYearBucket(int bucket_years) const {
+        if (bucket_years <= 0) {
+            throw std::invalid_argument("Bucket width must be positive");
+        }
+        std::vector<std::pair<int, std::size_t>> result;
+        auto counts = CountYears();
+        if (counts.empty()) {
+            return result;
+        }
+        const int first_bucket = FloorDiv(min_year_, bucket_years);
+        result.resize(FloorDiv(max_year_, bucket_years) - first_bucket + 1);
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            result[i].first = (first_bucket + static_cast<int>(i)) * bucket_years;
+        }
+        for (int year = min_year_; year <= max_year_; ++year) {
+            result[FloorDiv(year, bucket_years) - first_bucket].second += counts[year - min_year_];
+        }
+        return result;
+    }
+
+    std::vector<std::size_t> BookColumns::CountByAuthor() const {
+        std::vector<std::size_t> counts(author_ids_.size());
+        for (auto author : authors_) {
+            ++counts[author];
+        }
+        return counts;
+    }
+
+    std::vector<std::pair<int, int>> BookColumns::YearSpanByAuthor() const {
+        std::vector<std::int16_t> first(author_ids_.size(), std::numeric_limits<std::int16_t>::max());
+        std::vector<std::int16_t> last(author_ids_.size(), std::numeric_limits<std::int16_t>::min());
+        for (std::size_t i = 0; i < years_.size(); ++i) {
+            first[authors_[i]] = std::min(first[authors_[i]], years_[i]);
+            last[authors_[i]] = std::max(last[authors_[i]], years_[i]);
+        }
+        std::vector<std::pair<int, int>> spans;
+        spans.reserve(first.size());
+        for (std::size_t author = 0; author < first.size(); ++author) {
+            spans.emplace_back(first[author], last[author]);
+        }
+        return spans;
+    }
+
+    // Счётчики по всем годам от min_year_ до max_year_: год - смещение в массиве, без хеширования
+    std::vector<std::uint32_t> BookColumns::CountYears() const {
+        if (years_.empty()) {
+            return {};
+        }
+        std::vector<std::uint32_t> counts(static_cast<std::size_t>(max_year_ - min_year_) + 1);
+        for (auto year : years_) {
+            ++counts[year - min_year_];
+        }
+        return counts;
+    }
+
+}  // namespace app
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../domain/book.h"
+
+namespace app {
+
+    /**
+     * Колоночный снимок книг для аналитики (struct-of-arrays):
+     *  - плотный номер автора (uint32) вместо строк id и имени,
+     *  - год издания (int16),
+     *  - названия - смещения в одну общую строку.
+     * Агрегаты проходят по плотным массивам простыми циклами без ветвлений,
+     * которые компилятор векторизует. Снимок неизменяем; при изменении каталога строится заново.
+     */
+    class BookColumns {
+    public:
+        // std::out_of_range, если год издания не помещается в int16
+        explicit BookColumns(const std::vector<domain::BookData>& books);
+
+        std::size_t GetBookCount() const noexcept {
+            return years_.size();
+        }
+        std::size_t GetAuthorCount() const noexcept {
+            return author_names_.size();
+        }
+        const std::string& GetAuthorId(std::uint32_t author) const {
+            return author_ids_.at(author);
+        }
+        const std::string& GetAuthorName(std::uint32_t author) const {
+            return author_names_.at(author);
+        }
+        std::string_view GetTitle(std::size_t book) const;
+
+        // Число книг с годом издания в [from, to]
+        std::size_t CountInYearRange(int from, int to) const;
+        // Год, число книг - только годы из [from, to], в которых есть книги, по возрастанию
+        std::vector<std::pair<int, std::size_t>> CountByYear(int from, int to) const;
+        // Начало интервала в bucket_years лет, число книг - все интервалы от самой старой книги до самой новой
+        std::vector<std::pair<int, std::size_t>> CountByYearBucket(int bucket_years) const;
+        // Число книг по номеру автора
+        std::vector<std::size_t> CountByAuthor() const;
+        // Самый ранний и самый поздний год издания по номеру автора
+        std::vector<std::pair<int, int>> YearSpanByAuthor() const;
+
+    private:
+        std::vector<std::uint32_t> CountYears() const;
+
+        std::vector<std::string> author_ids_;
+        std::vector<std::string> author_names_;
+        std::vector<std::uint32_t> authors_;
+        std::vector<std::int16_t> years_;
+        std::vector<std::uint32_t> title_offsets_;  // book_count + 1 смещений в titles_
+        std::string titles_;
+        std::int16_t min_year_ = 0;
+        std::int16_t max_year_ = 0;
+    };
+
+}  // namespace app
@@ -0,0 +1,19 @@
+#pragma once
+#include "export_writer.h"
+
+namespace app {
+
+    /**
+     * Выгрузка всех книг с именами авторов и тегами в порядке ShowBooks (по названию, автору
+     * и году), одним согласованным чтением. Книги передаются в writer по одной, весь каталог
+     * в памяти не собирается.
+     */
+    class CatalogExporter {
+    public:
+        virtual void Export(ExportWriter& writer) = 0;
+
+    protected:
+        ~CatalogExporter() = default;
+    };
+
+}  // namespace app
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "import_reader.h"
+#include "unit_of_work.h"
+
+namespace app {
+
+    struct ImportStats {
+        std::size_t records = 0;    // прочитано записей
+        std::size_t authors = 0;    // добавлено авторов
+        std::size_t books = 0;      // добавлено книг
+        std::size_t book_tags = 0;  // добавлено пар книга-тег
+    };
+
+    using ImportProgress = std::function<void(const ImportStats&)>;
+
+    /**
+     * Слияние пачки записей с каталогом одной транзакцией. Авторы ищутся по имени и создаются,
+     * если их нет; книга, уже существующая у автора с тем же названием и годом, не дублируется,
+     * а только получает новые теги. Записи в пачке различны по (автор, название, год).
+     */
+    class CatalogImporter {
+    public:
+        // records в результате не заполняется
+        virtual ImportStats ImportBatch(const std::vector<ImportRecord>& records,
+                                        Durability durability = Durability::kStrict) = 0;
+
+    protected:
+        ~CatalogImporter() = default;
+    };
+
+}  // namespace app
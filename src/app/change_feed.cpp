@@ -0,0 +1,37 @@
+#include "change_feed.h"
+
+#include <utility>
+
+namespace app {
+
+    CompositeChangeFeed::CompositeChangeFeed(std::vector<ChangeFeed*> feeds)
+        : feeds_{std::move(feeds)} {
+    }
+
+    std::size_t CompositeChangeFeed::Subscribe(ChangeHandler handler) {
+        std::vector<std::size_t> subscriptions;
+        for (auto* feed : feeds_) {
+            subscriptions.push_back(feed->Subscribe(handler));
+        }
+        std::lock_guard lock{mutex_};
+        subscriptions_.emplace(next_subscription_, std::move(subscriptions));
+        return next_subscription_++;
+    }
+
+    void CompositeChangeFeed::Unsubscribe(std::size_t subscription) {
+        std::vector<std::size_t> subscriptions;
+        {
+            std::lock_guard lock{mutex_};
+            auto it = subscriptions_.find(subscription);
+            if (it == subscriptions_.end()) {
+                return;
+            }
+            subscriptions = std::move(it->second);
+            subscriptions_.erase(it);
+        }
+        for (std::size_t i = 0; i < feeds_.size(); ++i) {
+            feeds_[i]->Unsubscribe(subscriptions[i]);
+        }
+    }
+
+}  // namespace app
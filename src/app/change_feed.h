@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace app {
+
+    enum class EntityType {
+        kAuthor,
+        kBook,
+        kBookTags,
+        kCatalog    // для kReset: изменения могли быть пропущены, сбросить всё
+    };
+
+    enum class ChangeOp {
+        kInsert,
+        kUpdate,
+        kDelete,
+        kReset
+    };
+
+    struct ChangeEvent {
+        EntityType entity = EntityType::kCatalog;
+        ChangeOp op = ChangeOp::kReset;
+        std::string id;         // id автора или книги (для book_tags - id книги)
+        std::string name;       // имя автора или название книги (при удалении - прежнее); пусто, если неизвестно
+        bool local = false;     // изменение сделано этим же процессом
+    };
+
+    using ChangeHandler = std::function<void(const ChangeEvent&)>;
+
+    // Поток изменений каталога, сделанных любым экземпляром приложения.
+    // Обработчики вызываются из фонового потока; после Unsubscribe вызовов больше нет.
+    class ChangeFeed {
+    public:
+        virtual std::size_t Subscribe(ChangeHandler handler) = 0;
+        virtual void Unsubscribe(std::size_t subscription) = 0;
+
+    protected:
+        ~ChangeFeed() = default;
+    };
+
+    // Несколько потоков изменений (базы шардов, журнал записи) как один. Обработчик вызывается
+    // из фоновых потоков всех источников, в том числе одновременно
+    class CompositeChangeFeed : public ChangeFeed {
+    public:
+        explicit CompositeChangeFeed(std::vector<ChangeFeed*> feeds);
+
+        std::size_t Subscribe(ChangeHandler handler) override;
+        void Unsubscribe(std::size_t subscription) override;
+
+    private:
+        std::vector<ChangeFeed*> feeds_;
+        std::mutex mutex_;
+        std::map<std::size_t, std::vector<std::size_t>> subscriptions_;    // подписки в feeds_ по порядку
+        std::size_t next_subscription_ = 1;
+    };
+
+}  // namespace app
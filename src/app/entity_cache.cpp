@@ -0,0 +1,198 @@
+#include "entity_cache.h"
+
+namespace app {
+    namespace {
+        // Примерный размер занимаемой памяти, достаточный для учёта ёмкости кэша
+        std::size_t SizeOf(const std::string& str) {
+            return sizeof(std::string) + (str.size() > 15 ? str.capacity() : 0);
+        }
+
+        std::size_t SizeOf(const domain::BookData& book) {
+            return sizeof(book) + SizeOf(book.id) + SizeOf(book.author_id)
+                   + SizeOf(book.author_name) + SizeOf(book.title);
+        }
+
+        std::size_t SizeOf(const CachedBook& book) {
+            std::size_t size = sizeof(book) + SizeOf(book.data);
+            for (const auto& tag : book.tags) {
+                size += SizeOf(tag);
+            }
+            return size;
+        }
+
+        std::optional<domain::BookId> ParseBookId(const std::string& book_id) {
+            try {
+                return domain::BookId::FromString(book_id);
+            } catch (const std::exception&) {
+                return std::nullopt;
+            }
+        }
+
+        std::optional<domain::AuthorId> ParseAuthorId(const std::string& author_id) {
+            try {
+                return domain::AuthorId::FromString(author_id);
+            } catch (const std::exception&) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    // Половина ёмкости отводится под книги и авторов (3:1), по четверти - под списки авторов и книг
+    EntityCache::EntityCache(std::size_t capacity_bytes)
+        : capacity_bytes_(capacity_bytes), books_(capacity_bytes / 8 * 3), authors_(capacity_bytes / 8) {
+    }
+
+    EntityCache::Generation EntityCache::GetGeneration() {
+        std::lock_guard lock{mutex_};
+        return generation_;
+    }
+
+    std::optional<CachedBook> EntityCache::FindBook(const std::string &book_id) {
+        auto id = ParseBookId(book_id);
+        if (!IsEnabled() || !id) {
+            return std::nullopt;
+        }
+        std::lock_guard lock{mutex_};
+        return books_.Get(*id);
+    }
+
+    void EntityCache::PutBook(Generation loaded_at, const CachedBook &book) {
+        auto id = ParseBookId(book.data.id);
+        if (!IsEnabled() || !id) {
+            return;
+        }
+        std::lock_guard lock{mutex_};
+        if (generation_ == loaded_at) {
+            books_.Put(*id, book, SizeOf(book));
+        }
+    }
+
+    std::optional<std::string> EntityCache::FindAuthor(const std::string &author_id) {
+        auto id = ParseAuthorId(author_id);
+        if (!IsEnabled() || !id) {
+            return std::nullopt;
+        }
+        std::lock_guard lock{mutex_};
+        return authors_.Get(*id);
+    }
+
+    void EntityCache::PutAuthor(Generation loaded_at, const std::string &author_id, const std::string &name) {
+        auto id = ParseAuthorId(author_id);
+        if (!IsEnabled() || !id) {
+            return;
+        }
+        std::lock_guard lock{mutex_};
+        if (generation_ == loaded_at) {
+            authors_.Put(*id, name, sizeof(domain::AuthorId) + SizeOf(name));
+        }
+    }
+
+    std::optional<EntityCache::AuthorList> EntityCache::FindAuthors() {
+        std::lock_guard lock{mutex_};
+        return author_list_;
+    }
+
+    void EntityCache::PutAuthors(Generation loaded_at, const AuthorList &authors) {
+        std::size_t size = sizeof(authors);
+        for (const auto& [id, name] : authors) {
+            size += SizeOf(id) + SizeOf(name);
+        }
+        if (!FitsListing(size)) {
+            return;
+        }
+        std::lock_guard lock{mutex_};
+        if (generation_ == loaded_at) {
+            author_list_ = authors;
+        }
+    }
+
+    std::optional<EntityCache::BookList> EntityCache::FindBooks() {
+        std::lock_guard lock{mutex_};
+        return book_list_;
+    }
+
+    void EntityCache::PutBooks(Generation loaded_at, const BookList &books) {
+        std::size_t size = sizeof(books);
+        for (const auto& book : books) {
+            size += SizeOf(book);
+        }
+        if (!FitsListing(size)) {
+            return;
+        }
+        std::lock_guard lock{mutex_};
+        if (generation_ == loaded_at) {
+            book_list_ = books;
+        }
+    }
+
+    void EntityCache::InvalidateBook(const std::string &book_id) {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+        if (auto id = ParseBookId(book_id)) {
+            books_.Erase(*id);
+        }
+        book_list_.reset();
+    }
+
+    void EntityCache::InvalidateBooksByTitle(const std::string &title) {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+        books_.EraseIf([&title](const domain::BookId&, const CachedBook& book) {
+            return book.data.title == title;
+        });
+        book_list_.reset();
+    }
+
+    // Имя автора входит в данные его книг, поэтому вместе с автором сбрасываются и они
+    void EntityCache::InvalidateAuthor(const std::string &author_id) {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+        books_.EraseIf([&author_id](const domain::BookId&, const CachedBook& book) {
+            return book.data.author_id == author_id;
+        });
+        if (auto id = ParseAuthorId(author_id)) {
+            authors_.Erase(*id);
+        }
+        author_list_.reset();
+        book_list_.reset();
+    }
+
+    void EntityCache::InvalidateAuthorByName(const std::string &name) {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+        books_.EraseIf([&name](const domain::BookId&, const CachedBook& book) {
+            return book.data.author_name == name;
+        });
+        authors_.EraseIf([&name](const domain::AuthorId&, const std::string& author_name) {
+            return author_name == name;
+        });
+        author_list_.reset();
+        book_list_.reset();
+    }
+
+    void EntityCache::InvalidateAuthorList() {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+        author_list_.reset();
+    }
+
+    void EntityCache::InvalidateBookList() {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+        book_list_.reset();
+    }
+
+    void EntityCache::Clear() {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+        books_.Clear();
+        authors_.Clear();
+        author_list_.reset();
+        book_list_.reset();
+    }
+
+    bool EntityCache::FitsListing(std::size_t size_bytes) const noexcept {
+        return IsEnabled() && size_bytes <= capacity_bytes_ / 4;
+    }
+
+}  // namespace app
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/uuid/uuid_hash.hpp>
+
+#include "../domain/author.h"
+#include "../domain/book.h"
+#include "../util/lru_cache.h"
+
+namespace app {
+
+    struct CachedBook {
+        domain::BookData data;
+        std::vector<std::string> tags;
+    };
+
+    /**
+     * Read-through кэш сущностей между UseCasesImpl и репозиториями.
+     * Книги и авторы хранятся по BookId/AuthorId, списки авторов и книг (для SelectAuthor/SelectBook) -
+     * целиком. Заполняется при чтении, сбрасывается use case'ами записи после коммита.
+     * Чтение, начатое до сброса, в кэш не попадает: Put* принимают GetGeneration() до чтения.
+     * Ёмкость задаётся в байтах, 0 отключает кэш. Потокобезопасен.
+     */
+    class EntityCache {
+    public:
+        using AuthorList = std::vector<std::pair<std::string, std::string>>;
+        using BookList = std::vector<domain::BookData>;
+        using Generation = std::uint64_t;
+
+        explicit EntityCache(std::size_t capacity_bytes);
+
+        bool IsEnabled() const noexcept {
+            return capacity_bytes_ > 0;
+        }
+
+        // Значение для Put*: если после него кэш что-то сбросил, прочитанное не сохраняется
+        Generation GetGeneration();
+
+        std::optional<CachedBook> FindBook(const std::string& book_id);
+        void PutBook(Generation loaded_at, const CachedBook& book);
+        std::optional<std::string> FindAuthor(const std::string& author_id);
+        void PutAuthor(Generation loaded_at, const std::string& author_id, const std::string& name);
+        std::optional<AuthorList> FindAuthors();
+        void PutAuthors(Generation loaded_at, const AuthorList& authors);
+        std::optional<BookList> FindBooks();
+        void PutBooks(Generation loaded_at, const BookList& books);
+
+        void InvalidateBook(const std::string& book_id);
+        void InvalidateBooksByTitle(const std::string& title);
+        void InvalidateAuthor(const std::string& author_id);
+        void InvalidateAuthorByName(const std::string& name);
+        void InvalidateAuthorList();
+        void InvalidateBookList();
+        void Clear();
+
+    private:
+        using BookCache = util::LruCache<domain::BookId, CachedBook, util::TaggedHasher<domain::BookId>>;
+        using AuthorCache = util::LruCache<domain::AuthorId, std::string, util::TaggedHasher<domain::AuthorId>>;
+
+        bool FitsListing(std::size_t size_bytes) const noexcept;
+
+        std::size_t capacity_bytes_;
+        std::mutex mutex_;
+        BookCache books_;
+        AuthorCache authors_;
+        std::optional<AuthorList> author_list_;
+        std::optional<BookList> book_list_;
+        Generation generation_ = 0;     // растёт при каждом сбросе
+    };
+
+}  // namespace app
@@ -0,0 +1,103 @@
+#include "export_writer.h"
+
+#include <array>
+
+namespace app {
+
+    namespace {
+
+        // RFC 4180: поле в кавычках, если в нём есть разделитель, кавычка или перевод строки
+        void AppendCsvField(std::string& line, std::string_view field) {
+            if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+                line += field;
+                return;
+            }
+            line += '"';
+            for (char c : field) {
+                if (c == '"') {
+                    line += '"';
+                }
+                line += c;
+            }
+            line += '"';
+        }
+
+        void AppendJsonString(std::string& line, std::string_view value) {
+            static constexpr std::array<char, 16> HEX{'0', '1', '2', '3', '4', '5', '6', '7',
+                                                      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+            line += '"';
+            for (char c : value) {
+                switch (c) {
+                    case '"': line += "\\\""; break;
+                    case '\\': line += "\\\\"; break;
+                    case '\n': line += "\\n"; break;
+                    case '\r': line += "\\r"; break;
+                    case '\t': line += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            line += "\\u00";
+                            line += HEX[(c >> 4) & 0xF];
+                            line += HEX[c & 0xF];
+                        } else {
+                            // UTF-8 пишется как есть
+                            line += c;
+                        }
+                }
+            }
+            line += '"';
+        }
+
+    }  // namespace
+
+    ExportWriter::ExportWriter(std::ostream &output, ImportFormat format)
+            : output_(output), format_(format) {
+        if (format_ == ImportFormat::kCsv) {
+            output_ << "author,title,year,tags\n";
+        }
+    }
+
+    void ExportWriter::Write(const ExportRecord &record) {
+        line_.clear();
+        if (format_ == ImportFormat::kCsv) {
+            WriteCsv(record);
+        } else {
+            WriteNdjson(record);
+        }
+        line_ += '\n';
+        output_.write(line_.data(), static_cast<std::streamsize>(line_.size()));
+        ++count_;
+    }
+
+    void ExportWriter::WriteCsv(const ExportRecord &record) {
+        AppendCsvField(line_, record.author_name);
+        line_ += ',';
+        AppendCsvField(line_, record.title);
+        line_ += ',';
+        if (record.year) {
+            line_ += std::to_string(*record.year);
+        }
+        line_ += ',';
+        AppendCsvField(line_, record.tags);
+    }
+
+    void ExportWriter::WriteNdjson(const ExportRecord &record) {
+        line_ += "{\"author\": ";
+        AppendJsonString(line_, record.author_name);
+        line_ += ", \"title\": ";
+        AppendJsonString(line_, record.title);
+        line_ += ", \"year\": ";
+        line_ += record.year ? std::to_string(*record.year) : "null";
+        line_ += ", \"tags\": [";
+        std::string_view tags = record.tags;
+        for (bool first = true; !tags.empty(); first = false) {
+            auto comma = tags.find(',');
+            if (!first) {
+                line_ += ", ";
+            }
+            AppendJsonString(line_, tags.substr(0, comma));
+            tags = comma == std::string_view::npos ? std::string_view{} : tags.substr(comma + 1);
+        }
+        line_ += "]}";
+    }
+
+}  // namespace app
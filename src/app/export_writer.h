@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "import_reader.h"
+
+namespace app {
+
+    // Поля действительны только на время вызова ExportWriter::Write
+    struct ExportRecord {
+        std::string_view author_name;
+        std::string_view title;
+        std::optional<int> year;
+        std::string_view tags;      // через запятую, по алфавиту
+    };
+
+    /**
+     * Запись книг в поток в формате импорта, чтобы выгрузку можно было снова загрузить командой
+     * Import. Строки пишутся сразу, без накопления в памяти; CSV начинается с заголовка
+     * author,title,year,tags.
+     */
+    class ExportWriter {
+    public:
+        ExportWriter(std::ostream& output, ImportFormat format);
+
+        void Write(const ExportRecord& record);
+
+        std::size_t GetCount() const noexcept {
+            return count_;
+        }
+
+    private:
+        void WriteCsv(const ExportRecord& record);
+        void WriteNdjson(const ExportRecord& record);
+
+        std::ostream& output_;
+        ImportFormat format_;
+        std::size_t count_ = 0;
+        std::string line_;      // буфер строки, переиспользуется между записями
+    };
+
+}  // namespace app
@@ -0,0 +1,409 @@
+#include "import_reader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace app {
+    namespace {
+        std::string Trim(std::string_view value) {
+            auto begin = value.find_first_not_of(" \t\r");
+            if (begin == value.npos) {
+                return {};
+            }
+            auto end = value.find_last_not_of(" \t\r");
+            return std::string{value.substr(begin, end - begin + 1)};
+        }
+
+        // Как detail::ParseTags в меню
+        std::vector<std::string> NormalizeTags(const std::vector<std::string>& raw_tags) {
+            std::vector<std::string> tags;
+            for (const auto& raw_tag : raw_tags) {
+                std::string tag;
+                for (char c : Trim(raw_tag)) {
+                    if (c != ' ' || tag.empty() || tag.back() != ' ') {
+                        tag.push_back(c);
+                    }
+                }
+                if (!tag.empty()) {
+                    tags.push_back(std::move(tag));
+                }
+            }
+            std::sort(tags.begin(), tags.end());
+            tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+            return tags;
+        }
+
+        std::vector<std::string> SplitTags(std::string_view value) {
+            std::vector<std::string> tags;
+            std::size_t begin = 0;
+            while (begin <= value.size()) {
+                auto end = std::min(value.find(',', begin), value.size());
+                tags.emplace_back(value.substr(begin, end - begin));
+                begin = end + 1;
+            }
+            return tags;
+        }
+
+        int ParseYear(std::string_view value) {
+            int year = 0;
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), year);
+            if (error != std::errc{} || end != value.data() + value.size()) {
+                throw std::invalid_argument("invalid year");
+            }
+            return year;
+        }
+
+        void AppendUtf8(std::string& out, std::uint32_t code_point) {
+            if (code_point < 0x80) {
+                out.push_back(static_cast<char>(code_point));
+            } else if (code_point < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            } else if (code_point < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            } else {
+                out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            }
+        }
+
+        // Разбор одной строки NDJSON. Нужны только строки, числа и массивы строк;
+        // прочие значения неизвестных полей пропускаются
+        class JsonParser {
+        public:
+            explicit JsonParser(std::string_view text)
+                : text_{text} {
+            }
+
+            void SkipSpaces() {
+                while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+                    ++pos_;
+                }
+            }
+
+            bool Consume(char c) {
+                SkipSpaces();
+                if (pos_ < text_.size() && text_[pos_] == c) {
+                    ++pos_;
+                    return true;
+                }
+                return false;
+            }
+
+            void Expect(char c) {
+                if (!Consume(c)) {
+                    throw std::invalid_argument(std::string{"expected '"} + c + "'");
+                }
+            }
+
+            bool AtEnd() {
+                SkipSpaces();
+                return pos_ == text_.size();
+            }
+
+            std::string ParseString() {
+                Expect('"');
+                std::string result;
+                while (true) {
+                    if (pos_ >= text_.size()) {
+                        throw std::invalid_argument("unterminated string");
+                    }
+                    char c = text_[pos_++];
+                    if (c == '"') {
+                        return result;
+                    }
+                    if (c != '\\') {
+                        result.push_back(c);
+                        continue;
+                    }
+                    if (pos_ >= text_.size()) {
+                        throw std::invalid_argument("unterminated string");
+                    }
+                    switch (char escaped = text_[pos_++]) {
+                        case '"': case '\\': case '/': result.push_back(escaped); break;
+                        case 'b': result.push_back('\b'); break;
+                        case 'f': result.push_back('\f'); break;
+                        case 'n': result.push_back('\n'); break;
+                        case 'r': result.push_back('\r'); break;
+                        case 't': result.push_back('\t'); break;
+                        case 'u': AppendUtf8(result, ParseCodePoint()); break;
+                        default: throw std::invalid_argument("invalid escape");
+                    }
+                }
+            }
+
+            std::string_view ParseNumber() {
+                SkipSpaces();
+                auto begin = pos_;
+                while (pos_ < text_.size() && (std::isdigit(static_cast<unsigned char>(text_[pos_]))
+                                               || std::string_view{"+-.eE"}.find(text_[pos_]) != std::string_view::npos)) {
+                    ++pos_;
+                }
+                if (begin == pos_) {
+                    throw std::invalid_argument("expected number");
+                }
+                return text_.substr(begin, pos_ - begin);
+            }
+
+            std::vector<std::string> ParseStringArray() {
+                Expect('[');
+                std::vector<std::string> values;
+                if (Consume(']')) {
+                    return values;
+                }
+                do {
+                    values.push_back(ParseString());
+                } while (Consume(','));
+                Expect(']');
+                return values;
+            }
+
+            void SkipValue() {
+                SkipSpaces();
+                if (pos_ >= text_.size()) {
+                    throw std::invalid_argument("expected value");
+                }
+                char c = text_[pos_];
+                if (c == '"') {
+                    ParseString();
+                } else if (c == '[' || c == '{') {
+                    char close = c == '[' ? ']' : '}';
+                    ++pos_;
+                    if (Consume(close)) {
+                        return;
+                    }
+                    do {
+                        if (c == '{') {
+                            ParseString();
+                            Expect(':');
+                        }
+                        SkipValue();
+                    } while (Consume(','));
+                    Expect(close);
+                } else if (std::isalpha(static_cast<unsigned char>(c))) {
+                    for (std::string_view literal : {"true", "false", "null"}) {
+                        if (text_.substr(pos_, literal.size()) == literal) {
+                            pos_ += literal.size();
+                            return;
+                        }
+                    }
+                    throw std::invalid_argument("invalid literal");
+                } else {
+                    ParseNumber();
+                }
+            }
+
+        private:
+            std::uint32_t ParseHex4() {
+                if (pos_ + 4 > text_.size()) {
+                    throw std::invalid_argument("invalid escape");
+                }
+                std::uint32_t value = 0;
+                auto [end, error] = std::from_chars(text_.data() + pos_, text_.data() + pos_ + 4, value, 16);
+                if (error != std::errc{} || end != text_.data() + pos_ + 4) {
+                    throw std::invalid_argument("invalid escape");
+                }
+                pos_ += 4;
+                return value;
+            }
+
+            // \uXXXX, в том числе суррогатная пара \uD8xx\uDCxx
+            std::uint32_t ParseCodePoint() {
+                auto high = ParseHex4();
+                if (high < 0xD800 || high > 0xDBFF) {
+                    return high;
+                }
+                if (text_.substr(pos_, 2) != "\\u") {
+                    throw std::invalid_argument("invalid surrogate pair");
+                }
+                pos_ += 2;
+                auto low = ParseHex4();
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    throw std::invalid_argument("invalid surrogate pair");
+                }
+                return 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+            std::string_view text_;
+            std::size_t pos_ = 0;
+        };
+    }
+
+    ImportReader::ImportReader(std::istream &input, ImportFormat format)
+        : input_{input}, format_{format} {
+    }
+
+    std::optional<ImportRecord> ImportReader::Next() {
+        return format_ == ImportFormat::kCsv ? NextCsv() : NextNdjson();
+    }
+
+    std::optional<ImportRecord> ImportReader::NextCsv() {
+        std::vector<std::string> fields;
+        if (!header_read_) {
+            if (!ReadCsvRow(fields)) {
+                return std::nullopt;
+            }
+            std::optional<std::size_t> author, title, year;
+            for (std::size_t i = 0; i < fields.size(); ++i) {
+                auto name = Trim(fields[i]);
+                std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+                    return static_cast<char>(std::tolower(c));
+                });
+                if (name == "author") {
+                    author = i;
+                } else if (name == "title") {
+                    title = i;
+                } else if (name == "year") {
+                    year = i;
+                } else if (name == "tags") {
+                    tags_column_ = i;
+                }
+            }
+            if (!author || !title || !year) {
+                Fail("CSV header must contain author, title and year");
+            }
+            author_column_ = *author;
+            title_column_ = *title;
+            year_column_ = *year;
+            header_read_ = true;
+        }
+        if (!ReadCsvRow(fields)) {
+            return std::nullopt;
+        }
+        auto required = std::max({author_column_, title_column_, year_column_, tags_column_.value_or(0)});
+        if (fields.size() <= required) {
+            Fail("missing CSV fields");
+        }
+        ImportRecord record;
+        record.author_name = Trim(fields[author_column_]);
+        record.title = Trim(fields[title_column_]);
+        try {
+            record.year = ParseYear(Trim(fields[year_column_]));
+        } catch (const std::invalid_argument& e) {
+            Fail(e.what());
+        }
+        if (tags_column_) {
+            record.tags = NormalizeTags(SplitTags(fields[*tags_column_]));
+        }
+        if (record.author_name.empty() || record.title.empty()) {
+            Fail("empty author or title");
+        }
+        return record;
+    }
+
+    std::optional<ImportRecord> ImportReader::NextNdjson() {
+        std::string line;
+        while (std::getline(input_, line)) {
+            ++line_;
+            JsonParser parser{line};
+            if (parser.AtEnd()) {
+                continue;
+            }
+            ImportRecord record;
+            bool has_year = false;
+            try {
+                parser.Expect('{');
+                if (!parser.Consume('}')) {
+                    do {
+                        auto key = parser.ParseString();
+                        parser.Expect(':');
+                        if (key == "author") {
+                            record.author_name = Trim(parser.ParseString());
+                        } else if (key == "title") {
+                            record.title = Trim(parser.ParseString());
+                        } else if (key == "year") {
+                            record.year = ParseYear(parser.ParseNumber());
+                            has_year = true;
+                        } else if (key == "tags") {
+                            record.tags = NormalizeTags(parser.ParseStringArray());
+                        } else {
+                            parser.SkipValue();
+                        }
+                    } while (parser.Consume(','));
+                    parser.Expect('}');
+                }
+                if (!parser.AtEnd()) {
+                    throw std::invalid_argument("unexpected data after object");
+                }
+            } catch (const std::invalid_argument& e) {
+                Fail(e.what());
+            }
+            if (record.author_name.empty() || record.title.empty() || !has_year) {
+                Fail("author, title and year are required");
+            }
+            return record;
+        }
+        return std::nullopt;
+    }
+
+    // RFC 4180: поля в кавычках могут содержать запятые, переводы строк и удвоенные кавычки.
+    // Пустые строки пропускаются
+    bool ImportReader::ReadCsvRow(std::vector<std::string> &fields) {
+        fields.clear();
+        std::string field;
+        bool quoted = false;
+        bool any = false;
+        std::istream::int_type next;
+        while ((next = input_.get()) != std::istream::traits_type::eof()) {
+            char c = static_cast<char>(next);
+            if (quoted) {
+                if (c == '"') {
+                    if (input_.peek() == '"') {
+                        input_.get();
+                        field.push_back('"');
+                    } else {
+                        quoted = false;
+                    }
+                } else {
+                    if (c == '\n') {
+                        ++line_;
+                    }
+                    field.push_back(c);
+                }
+                continue;
+            }
+            if (c == '\n') {
+                ++line_;
+                if (!any && field.empty()) {
+                    continue;
+                }
+                fields.push_back(std::move(field));
+                return true;
+            }
+            if (c == '\r') {
+                continue;
+            }
+            any = true;
+            if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.push_back(std::move(field));
+                field.clear();
+            } else {
+                field.push_back(c);
+            }
+        }
+        if (quoted) {
+            Fail("unterminated quoted field");
+        }
+        if (!any && field.empty()) {
+            return false;
+        }
+        ++line_;
+        fields.push_back(std::move(field));
+        return true;
+    }
+
+    void ImportReader::Fail(const std::string &message) const {
+        throw std::invalid_argument("Line " + std::to_string(line_) + ": " + message);
+    }
+
+}  // namespace app
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace app {
+
+    struct ImportRecord {
+        std::string author_name;
+        std::string title;
+        int year = 0;
+        std::vector<std::string> tags;     // без повторов, по алфавиту
+    };
+
+    enum class ImportFormat {
+        kCsv,       // заголовок author,title,year[,tags]; теги в поле через запятую
+        kNdjson     // по объекту на строку: {"author": ..., "title": ..., "year": ..., "tags": [...]}
+    };
+
+    /**
+     * Потоковое чтение записей каталога для импорта: в памяти только текущая запись.
+     * Теги нормализуются как при вводе в меню: пробелы по краям убираются, повторы пробелов
+     * схлопываются, пустые и повторяющиеся теги отбрасываются.
+     * Ошибка формата - std::invalid_argument с номером строки файла.
+     */
+    class ImportReader {
+    public:
+        ImportReader(std::istream& input, ImportFormat format);
+
+        // std::nullopt - записей больше нет
+        std::optional<ImportRecord> Next();
+
+        // Номер последней прочитанной строки файла, с единицы
+        std::size_t GetLine() const noexcept {
+            return line_;
+        }
+
+    private:
+        std::optional<ImportRecord> NextCsv();
+        std::optional<ImportRecord> NextNdjson();
+        bool ReadCsvRow(std::vector<std::string>& fields);
+        [[noreturn]] void Fail(const std::string& message) const;
+
+        std::istream& input_;
+        ImportFormat format_;
+        std::size_t line_ = 0;
+        // Позиции столбцов CSV из заголовка
+        std::size_t author_column_ = 0;
+        std::size_t title_column_ = 0;
+        std::size_t year_column_ = 0;
+        std::optional<std::size_t> tags_column_;
+        bool header_read_ = false;
+    };
+
+}  // namespace app
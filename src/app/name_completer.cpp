@@ -0,0 +1,118 @@
+#include "name_completer.h"
+
+namespace app {
+
+    NameCompleter::Generation NameCompleter::GetGeneration() {
+        std::lock_guard lock{mutex_};
+        return generation_;
+    }
+
+    void NameCompleter::Rebuild(Generation loaded_at, const Entries &entries) {
+        std::vector<std::string> names;
+        names.reserve(entries.size());
+        std::unordered_multimap<std::string, std::string> ids;
+        ids.reserve(entries.size());
+        for (const auto& [id, name] : entries) {
+            names.push_back(name);
+            ids.emplace(name, id);
+        }
+        util::PrefixIndex index;
+        index.Assign(names);
+        std::lock_guard lock{mutex_};
+        if (generation_ != loaded_at) {
+            return;
+        }
+        index_ = std::move(index);
+        ids_ = std::move(ids);
+        built_ = true;
+    }
+
+    void NameCompleter::Add(const std::string &id, const std::string &name) {
+        std::lock_guard lock{mutex_};
+        if (AcceptsUpdates()) {
+            index_.Add(name);
+            ids_.emplace(name, id);
+        }
+    }
+
+    void NameCompleter::Remove(const std::string &id, const std::string &name) {
+        std::lock_guard lock{mutex_};
+        if (!AcceptsUpdates()) {
+            return;
+        }
+        auto [begin, end] = ids_.equal_range(name);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second == id) {
+                ids_.erase(it);
+                index_.Remove(name);
+                return;
+            }
+        }
+    }
+
+    void NameCompleter::Erase(const std::string &name) {
+        std::lock_guard lock{mutex_};
+        if (AcceptsUpdates()) {
+            index_.Erase(name);
+            ids_.erase(name);
+        }
+    }
+
+    void NameCompleter::Rename(const std::string &old_name, const std::string &new_name) {
+        std::lock_guard lock{mutex_};
+        if (!AcceptsUpdates() || old_name == new_name) {
+            return;
+        }
+        auto [begin, end] = ids_.equal_range(old_name);
+        std::vector<std::string> renamed;
+        for (auto it = begin; it != end; ++it) {
+            renamed.push_back(it->second);
+        }
+        index_.Erase(old_name);
+        ids_.erase(old_name);
+        for (auto& id : renamed) {
+            index_.Add(new_name);
+            ids_.emplace(new_name, std::move(id));
+        }
+    }
+
+    void NameCompleter::MarkStale() {
+        std::lock_guard lock{mutex_};
+        built_ = false;
+        ++generation_;
+    }
+
+    std::optional<NameCompleter::Found> NameCompleter::Complete(const std::string &prefix, std::size_t limit) {
+        std::lock_guard lock{mutex_};
+        if (!built_) {
+            return std::nullopt;
+        }
+        Found found;
+        found.names = index_.Find(prefix, limit);
+        for (const auto& name : found.names) {
+            auto [begin, end] = ids_.equal_range(name);
+            for (auto it = begin; it != end && found.ids.size() < limit; ++it) {
+                found.ids.push_back(it->second);
+            }
+        }
+        return found;
+    }
+
+    std::optional<std::size_t> NameCompleter::GetCount() {
+        std::lock_guard lock{mutex_};
+        if (!built_) {
+            return std::nullopt;
+        }
+        return ids_.size();
+    }
+
+    // Непостроенный индекс не обновляется, но идущее построение могло не увидеть изменение
+    bool NameCompleter::AcceptsUpdates() {
+        if (!built_) {
+            ++generation_;
+            return false;
+        }
+        return true;
+    }
+
+}  // namespace app
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../util/prefix_index.h"
+
+namespace app {
+
+    /**
+     * Автодополнение имён авторов или названий книг по префиксу, вместе с id найденных сущностей.
+     * Строится из списков авторов/книг и поддерживается use case'ами записи; изменения,
+     * после которых нельзя точно обновить индекс (в том числе из других процессов), помечают его
+     * устаревшим, и Complete() возвращает nullopt до перестроения. Потокобезопасен.
+     */
+    class NameCompleter {
+    public:
+        using Generation = std::uint64_t;
+        using Entries = std::vector<std::pair<std::string, std::string>>;     // id, имя
+
+        struct Found {
+            std::vector<std::string> names;
+            std::vector<std::string> ids;   // сущностей с этими именами, в порядке имён
+        };
+
+        // Значение для Rebuild: если до него индекс изменён или помечен устаревшим, построение не применяется
+        Generation GetGeneration();
+        void Rebuild(Generation loaded_at, const Entries& entries);
+        void Add(const std::string& id, const std::string& name);
+        void Remove(const std::string& id, const std::string& name);
+        // Убирает все сущности с этим именем
+        void Erase(const std::string& name);
+        // Все сущности с именем old_name получают имя new_name
+        void Rename(const std::string& old_name, const std::string& new_name);
+        void MarkStale();
+
+        // Не более limit имён и не более limit id
+        std::optional<Found> Complete(const std::string& prefix, std::size_t limit);
+        // Число сущностей
+        std::optional<std::size_t> GetCount();
+
+    private:
+        bool AcceptsUpdates();
+
+        std::mutex mutex_;
+        bool built_ = false;
+        Generation generation_ = 0;
+        util::PrefixIndex index_;
+        std::unordered_multimap<std::string, std::string> ids_;     // имя -> id
+    };
+
+}  // namespace app
@@ -0,0 +1,77 @@
+#include "name_filter.h"
+
+#include <algorithm>
+
+namespace app {
+    namespace {
+        // Запас под добавления: после его исчерпания фильтр перестраивается, чтобы
+        // доля ложных срабатываний не росла
+        constexpr std::size_t MIN_CAPACITY = 1024;
+        constexpr std::size_t GROWTH_FACTOR = 2;
+        // При частых изменениях из других процессов фильтр не перестраивается на каждый запрос
+        constexpr auto MIN_REBUILD_INTERVAL = std::chrono::seconds{5};
+    }
+
+    NameFilter::NameFilter(double false_positive_rate, std::size_t max_bytes)
+        : false_positive_rate_(false_positive_rate), max_bytes_(max_bytes) {
+    }
+
+    bool NameFilter::NeedsRebuild() {
+        std::lock_guard lock{mutex_};
+        auto now = std::chrono::steady_clock::now();
+        if (!IsEnabled() || filter_ || (last_rebuild_ && now - *last_rebuild_ < MIN_REBUILD_INTERVAL)) {
+            return false;
+        }
+        last_rebuild_ = now;
+        return true;
+    }
+
+    NameFilter::Generation NameFilter::GetGeneration() {
+        std::lock_guard lock{mutex_};
+        return generation_;
+    }
+
+    void NameFilter::Rebuild(Generation loaded_at, const std::vector<std::string> &names) {
+        if (!IsEnabled()) {
+            return;
+        }
+        auto capacity = std::max(MIN_CAPACITY, names.size() * GROWTH_FACTOR);
+        util::BloomFilter filter{capacity, false_positive_rate_, max_bytes_};
+        for (const auto& name : names) {
+            filter.Add(name);
+        }
+        std::lock_guard lock{mutex_};
+        if (generation_ != loaded_at) {
+            return;
+        }
+        filter_ = std::move(filter);
+        capacity_ = capacity;
+        count_ = names.size();
+    }
+
+    void NameFilter::Add(const std::string &name) {
+        std::lock_guard lock{mutex_};
+        if (!filter_) {
+            ++generation_;  // идущее построение могло не увидеть это имя
+            return;
+        }
+        if (++count_ > capacity_) {
+            filter_.reset();
+            ++generation_;
+            return;
+        }
+        filter_->Add(name);
+    }
+
+    void NameFilter::MarkStale() {
+        std::lock_guard lock{mutex_};
+        filter_.reset();
+        ++generation_;
+    }
+
+    bool NameFilter::MayContain(const std::string &name) {
+        std::lock_guard lock{mutex_};
+        return !filter_ || filter_->MayContain(name);
+    }
+
+}  // namespace app
@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../util/bloom_filter.h"
+
+namespace app {
+
+    /**
+     * Фильтр Блума над именами авторов или названиями книг, позволяющий use case'ам
+     * отвечать на заведомые промахи без обращения к БД.
+     * Пока фильтр не построен или помечен устаревшим (изменения другого процесса),
+     * MayContain() отвечает "возможно есть". Потокобезопасен.
+     */
+    class NameFilter {
+    public:
+        using Generation = std::uint64_t;
+
+        NameFilter(double false_positive_rate, std::size_t max_bytes);
+
+        bool IsEnabled() const noexcept {
+            return max_bytes_ > 0;
+        }
+
+        // true не чаще раза в несколько секунд, если фильтр не построен или устарел
+        bool NeedsRebuild();
+        // Значение для Rebuild: если до него вызван MarkStale, построенный фильтр не применяется
+        Generation GetGeneration();
+        void Rebuild(Generation loaded_at, const std::vector<std::string>& names);
+        void Add(const std::string& name);
+        void MarkStale();
+
+        bool MayContain(const std::string& name);
+
+    private:
+        double false_positive_rate_;
+        std::size_t max_bytes_;
+
+        std::mutex mutex_;
+        std::optional<util::BloomFilter> filter_;
+        std::size_t capacity_ = 0;
+        std::size_t count_ = 0;
+        Generation generation_ = 0;
+        std::optional<std::chrono::steady_clock::time_point> last_rebuild_;
+    };
+
+}  // namespace app
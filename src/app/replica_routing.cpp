@@ -0,0 +1,94 @@
+#include "replica_routing.h"
+
+#include <exception>
+#include <utility>
+
+namespace app {
+
+    class ReplicaRoutingUnitOfWorkFactory::WriteUnitOfWork : public UnitOfWork {
+    public:
+        WriteUnitOfWork(ReplicaRoutingUnitOfWorkFactory& factory, std::unique_ptr<UnitOfWork> unit)
+            : factory_{factory}, unit_{std::move(unit)} {
+        }
+
+        domain::AuthorRepository* Author() override {
+            return unit_->Author();
+        }
+        domain::BookRepository* Book() override {
+            return unit_->Book();
+        }
+        domain::BookTagsRepository* BookTags() override {
+            return unit_->BookTags();
+        }
+        void Commit() override {
+            unit_->Commit();
+            factory_.OnWriteCommitted();
+        }
+
+    private:
+        ReplicaRoutingUnitOfWorkFactory& factory_;
+        std::unique_ptr<UnitOfWork> unit_;
+    };
+
+    ReplicaRoutingUnitOfWorkFactory::ReplicaRoutingUnitOfWorkFactory(UnitOfWorkFactory &primary,
+                                                                     const std::vector<UnitOfWorkFactory*> &replicas,
+                                                                     const ReplicaRoutingConfig &config)
+            : primary_{primary}, config_{config} {
+        for (auto* replica : replicas) {
+            replicas_.push_back({replica, Clock::time_point{}});
+        }
+    }
+
+    std::unique_ptr<UnitOfWork> ReplicaRoutingUnitOfWorkFactory::CreateUnitOfWork(const UnitOfWorkOptions &options) {
+        if (!options.read_only) {
+            return std::make_unique<WriteUnitOfWork>(*this, primary_.CreateUnitOfWork(options));
+        }
+        if (options.primary || ReadsOwnWrites()) {
+            return primary_.CreateUnitOfWork(options);
+        }
+        return CreateReadUnit(options);
+    }
+
+    // Транзакция открывается вне mutex_: BEGIN на реплике - сетевой запрос
+    std::unique_ptr<UnitOfWork> ReplicaRoutingUnitOfWorkFactory::CreateReadUnit(const UnitOfWorkOptions &options) {
+        for (std::size_t attempt = 0; attempt < replicas_.size(); ++attempt) {
+            Replica* replica = nullptr;
+            {
+                std::lock_guard lock{mutex_};
+                replica = &replicas_[next_++ % replicas_.size()];
+                if (Clock::now() < replica->down_until) {
+                    continue;
+                }
+            }
+            try {
+                return replica->factory->CreateUnitOfWork(options);
+            } catch (const std::exception&) {
+                std::lock_guard lock{mutex_};
+                replica->down_until = Clock::now() + config_.retry_after;
+            }
+        }
+        return primary_.CreateUnitOfWork(options);
+    }
+
+    bool ReplicaRoutingUnitOfWorkFactory::ReadsOwnWrites() {
+        std::lock_guard lock{mutex_};
+        auto it = sticky_until_.find(std::this_thread::get_id());
+        if (it == sticky_until_.end()) {
+            return false;
+        }
+        if (Clock::now() < it->second) {
+            return true;
+        }
+        sticky_until_.erase(it);
+        return false;
+    }
+
+    void ReplicaRoutingUnitOfWorkFactory::OnWriteCommitted() {
+        if (config_.sticky_for.count() <= 0) {
+            return;
+        }
+        std::lock_guard lock{mutex_};
+        sticky_until_[std::this_thread::get_id()] = Clock::now() + config_.sticky_for;
+    }
+
+}  // namespace app
@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "unit_of_work.h"
+
+namespace app {
+
+    struct ReplicaRoutingConfig {
+        // После своей записи поток читает с primary столько времени, пока реплики догоняют; 0 - сразу с реплик
+        std::chrono::milliseconds sticky_for{2000};
+        // Реплика, не открывшая транзакцию, столько времени пропускается
+        std::chrono::milliseconds retry_after{5000};
+    };
+
+    /**
+     * Распределение чтения по репликам. Read_only unit of work открываются на репликах по кругу;
+     * если реплика не смогла открыть транзакцию (нет соединения), берётся следующая, а если не
+     * смогла ни одна - primary. Пишущие unit of work и unit of work с primary всегда идут на primary. После Commit
+     * пишущего unit of work поток ещё sticky_for читает с primary, чтобы видеть свою запись,
+     * которую асинхронные реплики могли не получить.
+     */
+    class ReplicaRoutingUnitOfWorkFactory : public UnitOfWorkFactory {
+    public:
+        ReplicaRoutingUnitOfWorkFactory(UnitOfWorkFactory& primary, const std::vector<UnitOfWorkFactory*>& replicas,
+                                        const ReplicaRoutingConfig& config = {});
+
+        std::unique_ptr<UnitOfWork> CreateUnitOfWork(const UnitOfWorkOptions& options = {}) override;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        class WriteUnitOfWork;
+
+        struct Replica {
+            UnitOfWorkFactory* factory;
+            Clock::time_point down_until;
+        };
+
+        std::unique_ptr<UnitOfWork> CreateReadUnit(const UnitOfWorkOptions& options);
+        bool ReadsOwnWrites();
+        void OnWriteCommitted();
+
+        UnitOfWorkFactory& primary_;
+        ReplicaRoutingConfig config_;
+        std::mutex mutex_;
+        std::vector<Replica> replicas_;
+        std::size_t next_ = 0;
+        std::unordered_map<std::thread::id, Clock::time_point> sticky_until_;
+    };
+
+}  // namespace app
@@ -0,0 +1,464 @@
+#include "sharding.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "../domain/author.h"
+#include "../domain/book.h"
+#include "../util/kway_merge.h"
+#include "../util/text_match.h"
+
+namespace app {
+
+    namespace {
+
+        // Без ограничения: LIMIT в Postgres - bigint
+        constexpr std::size_t ALL_ROWS = std::numeric_limits<std::int64_t>::max();
+
+        std::size_t AddLimits(std::size_t limit, std::size_t offset) {
+            return limit > ALL_ROWS - std::min(offset, ALL_ROWS) ? ALL_ROWS : limit + offset;
+        }
+
+        // Порядок book_listing: название, автор, год
+        bool ListingLess(const domain::BookData& lhs, const domain::BookData& rhs) {
+            return std::tie(lhs.title, lhs.author_name, lhs.year) < std::tie(rhs.title, rhs.author_name, rhs.year);
+        }
+
+        // Порядок Search: ранг по убыванию, затем порядок списка
+        bool RankedLess(const domain::RankedBook& lhs, const domain::RankedBook& rhs) {
+            if (lhs.rank != rhs.rank) {
+                return lhs.rank > rhs.rank;
+            }
+            return ListingLess(lhs.data, rhs.data);
+        }
+
+        bool YearLess(const domain::BookData& lhs, const domain::BookData& rhs) {
+            return std::tie(lhs.year, lhs.title, lhs.author_name, lhs.id)
+                   < std::tie(rhs.year, rhs.title, rhs.author_name, rhs.id);
+        }
+
+        // Результаты шардов, ранжированные по общей оценке: по убыванию, затем в порядке списка
+        std::vector<domain::BookData> TakeRanked(std::vector<std::pair<double, domain::BookData>> ranked,
+                                                 std::size_t offset, std::size_t limit) {
+            std::sort(ranked.begin(), ranked.end(), [](const auto& lhs, const auto& rhs) {
+                if (lhs.first != rhs.first) {
+                    return lhs.first > rhs.first;
+                }
+                return ListingLess(lhs.second, rhs.second);
+            });
+            std::vector<domain::BookData> books;
+            for (std::size_t i = offset; i < ranked.size() && books.size() < limit; ++i) {
+                books.push_back(std::move(ranked[i].second));
+            }
+            return books;
+        }
+
+    }  // namespace
+
+    //===============ShardedUnitOfWork=====
+    class ShardedUnitOfWorkFactory::ShardedUnitOfWork : public UnitOfWork {
+    public:
+        ShardedUnitOfWork(ShardedUnitOfWorkFactory& factory, const UnitOfWorkOptions& options)
+            : factory_{factory}, options_{options}, units_(factory.shards_.size()),
+              authors_{*this}, books_{*this}, book_tags_{*this} {
+        }
+
+        domain::AuthorRepository* Author() override {
+            return &authors_;
+        }
+        domain::BookRepository* Book() override {
+            return &books_;
+        }
+        domain::BookTagsRepository* BookTags() override {
+            return &book_tags_;
+        }
+
+        void Commit() override {
+            for (auto& unit : units_) {
+                if (unit) {
+                    unit->Commit();
+                }
+            }
+        }
+
+    private:
+        class Authors : public domain::AuthorRepository {
+        public:
+            explicit Authors(ShardedUnitOfWork& unit)
+                : unit_{unit} {
+            }
+
+            void Save(const domain::Author& author) override {
+                auto shard = unit_.factory_.GetAuthorShard(author.GetId().ToString());
+                CheckNameIsFree(author.GetName(), shard);
+                unit_.Shard(shard).Author()->Save(author);
+            }
+
+            std::vector<std::pair<std::string, std::string>> Read() override {
+                std::vector<std::vector<std::pair<std::string, std::string>>> runs;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    runs.push_back(unit_.ReadShard(shard, [](UnitOfWork& unit) {
+                        return unit.Author()->Read();
+                    }));
+                }
+                return util::MergeSorted(std::move(runs), [](const auto& lhs, const auto& rhs) {
+                    return lhs.second < rhs.second;
+                });
+            }
+
+            std::optional<std::string> ReadNameById(const std::string& id) override {
+                return unit_.ReadShard(unit_.factory_.GetAuthorShard(id), [&id](UnitOfWork& unit) {
+                    return unit.Author()->ReadNameById(id);
+                });
+            }
+
+            std::optional<std::string> ReadIdByName(const std::string& name) override {
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    if (auto id = ReadIdByName(name, shard)) {
+                        return id;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            std::vector<std::pair<std::string, std::string>> FindSimilar(const std::string& name, double threshold,
+                                                                         std::size_t limit) override {
+                std::vector<std::pair<double, std::pair<std::string, std::string>>> similar;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    auto shard_authors = unit_.ReadShard(shard, [&](UnitOfWork& unit) {
+                        return unit.Author()->FindSimilar(name, threshold, limit);
+                    });
+                    for (auto& author : shard_authors) {
+                        auto similarity = util::TrigramSimilarity(author.second, name);
+                        similar.emplace_back(similarity, std::move(author));
+                    }
+                }
+                std::sort(similar.begin(), similar.end(), [](const auto& lhs, const auto& rhs) {
+                    if (lhs.first != rhs.first) {
+                        return lhs.first > rhs.first;
+                    }
+                    return lhs.second.second < rhs.second.second;
+                });
+                std::vector<std::pair<std::string, std::string>> authors;
+                for (std::size_t i = 0; i < similar.size() && i < limit; ++i) {
+                    authors.push_back(std::move(similar[i].second));
+                }
+                return authors;
+            }
+
+            void DeleteByName(const std::string& name) override {
+                unit_.AuthorShardByName(name).Author()->DeleteByName(name);
+            }
+            void DeleteById(const std::string& id) override {
+                unit_.AuthorShard(id).Author()->DeleteById(id);
+            }
+            void EditByName(const std::string& old_name, const std::string& new_name) override {
+                auto id = ReadIdByName(old_name);
+                auto shard = id ? unit_.factory_.GetAuthorShard(*id) : 0;
+                CheckNameIsFree(new_name, shard);
+                unit_.Shard(shard).Author()->EditByName(old_name, new_name);
+            }
+            void EditById(const std::string& id, const std::string& new_name) override {
+                auto shard = unit_.factory_.GetAuthorShard(id);
+                CheckNameIsFree(new_name, shard);
+                unit_.Shard(shard).Author()->EditById(id, new_name);
+            }
+
+        private:
+            std::optional<std::string> ReadIdByName(const std::string& name, std::size_t shard) {
+                return unit_.ReadShard(shard, [&name](UnitOfWork& unit) {
+                    return unit.Author()->ReadIdByName(name);
+                });
+            }
+
+            // Имя уникально внутри шарда, а на остальных шардах проверяется перед записью. Проверка
+            // не блокирует другие шарды: одновременная запись того же имени на другом шарде её обходит
+            void CheckNameIsFree(const std::string& name, std::size_t own_shard) {
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    if (shard != own_shard && ReadIdByName(name, shard)) {
+                        throw std::logic_error("Author name already exists");
+                    }
+                }
+            }
+
+            ShardedUnitOfWork& unit_;
+        };
+
+        class Books : public domain::BookRepository {
+        public:
+            explicit Books(ShardedUnitOfWork& unit)
+                : unit_{unit} {
+            }
+
+            void Save(const domain::Book& book) override {
+                auto shard = unit_.factory_.GetAuthorShard(book.GetAuthorId());
+                unit_.Shard(shard).Book()->Save(book);
+                unit_.factory_.RememberBookShard(book.GetId().ToString(), shard);
+            }
+
+            std::vector<domain::BookData> Read() override {
+                return MergeListing([](domain::BookRepository& books) {
+                    return books.Read();
+                });
+            }
+            std::vector<domain::BookData> ReadByName(const std::string& book_name) override {
+                return MergeListing([&book_name](domain::BookRepository& books) {
+                    return books.ReadByName(book_name);
+                });
+            }
+
+            domain::BookData ReadById(const std::string& book_id) override {
+                if (auto shard = unit_.FindBookShard(book_id)) {
+                    return unit_.ReadShard(*shard, [&book_id](UnitOfWork& unit) {
+                        return unit.Book()->ReadById(book_id);
+                    });
+                }
+                return {};
+            }
+
+            std::vector<domain::BookData> ReadAuthorBooks(const std::string& author_id) override {
+                return unit_.ReadShard(unit_.factory_.GetAuthorShard(author_id), [&author_id](UnitOfWork& unit) {
+                    return unit.Book()->ReadAuthorBooks(author_id);
+                });
+            }
+
+            // Ранги шардов сравнимы, и каждый шард отдаёт книги в том же порядке, что и слияние,
+            // поэтому общую страницу дают первые limit + offset книг каждого шарда
+            std::vector<domain::RankedBook> Search(const std::string& query, std::size_t limit,
+                                                   std::size_t offset) override {
+                std::vector<std::vector<domain::RankedBook>> runs;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    runs.push_back(unit_.ReadShard(shard, [&](UnitOfWork& unit) {
+                        return unit.Book()->Search(query, AddLimits(limit, offset), 0);
+                    }));
+                }
+                return util::MergeSorted(std::move(runs), RankedLess, offset, limit);
+            }
+
+            std::vector<domain::BookData> ReadByYearRange(int from, int to, std::size_t limit,
+                                                          std::size_t offset) override {
+                std::vector<std::vector<domain::BookData>> runs;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    runs.push_back(unit_.ReadShard(shard, [&](UnitOfWork& unit) {
+                        return unit.Book()->ReadByYearRange(from, to, AddLimits(limit, offset), 0);
+                    }));
+                }
+                return util::MergeSorted(std::move(runs), YearLess, offset, limit);
+            }
+
+            std::vector<domain::BookData> FindSimilar(const std::string& title, double threshold,
+                                                      std::size_t limit) override {
+                std::vector<std::pair<double, domain::BookData>> ranked;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    auto shard_books = unit_.ReadShard(shard, [&](UnitOfWork& unit) {
+                        return unit.Book()->FindSimilar(title, threshold, limit);
+                    });
+                    for (auto& book : shard_books) {
+                        ranked.emplace_back(util::TrigramSimilarity(book.title, title), std::move(book));
+                    }
+                }
+                return TakeRanked(std::move(ranked), 0, limit);
+            }
+
+            // Книги с таким названием могут быть на нескольких шардах; удаление с нескольких шардов
+            // в одном unit of work отклоняет Shard
+            void DeleteByName(const std::string& book_name) override {
+                bool found = false;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    auto exists = unit_.ReadShard(shard, [&book_name](UnitOfWork& unit) {
+                        return !unit.Book()->ReadByName(book_name).empty();
+                    });
+                    if (exists) {
+                        unit_.Shard(shard).Book()->DeleteByName(book_name);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    unit_.Shard(0).Book()->DeleteByName(book_name);
+                }
+            }
+            void DeleteById(const std::string& book_id) override {
+                unit_.BookShard(book_id).Book()->DeleteById(book_id);
+            }
+            void EditTitleById(const std::string& id, const std::string& new_name) override {
+                unit_.BookShard(id).Book()->EditTitleById(id, new_name);
+            }
+            void EditYearById(const std::string& id, int new_year) override {
+                unit_.BookShard(id).Book()->EditYearById(id, new_year);
+            }
+            void Patch(const std::string& id, const std::optional<std::string>& new_title,
+                       const std::optional<int>& new_year) override {
+                unit_.BookShard(id).Book()->Patch(id, new_title, new_year);
+            }
+
+        private:
+            template <typename ReadShard>
+            std::vector<domain::BookData> MergeListing(ReadShard read_shard) {
+                std::vector<std::vector<domain::BookData>> runs;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    runs.push_back(unit_.ReadShard(shard, [&read_shard](UnitOfWork& unit) {
+                        return read_shard(*unit.Book());
+                    }));
+                }
+                return util::MergeSorted(std::move(runs), ListingLess);
+            }
+
+            ShardedUnitOfWork& unit_;
+        };
+
+        class Tags : public domain::BookTagsRepository {
+        public:
+            explicit Tags(ShardedUnitOfWork& unit)
+                : unit_{unit} {
+            }
+
+            void Save(const domain::BookTags& book_tags) override {
+                unit_.BookShard(book_tags.GetBookId()).BookTags()->Save(book_tags);
+            }
+
+            std::vector<std::pair<std::string, std::string>> Read() override {
+                std::vector<std::pair<std::string, std::string>> book_tags;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    auto shard_tags = unit_.ReadShard(shard, [](UnitOfWork& unit) {
+                        return unit.BookTags()->Read();
+                    });
+                    book_tags.insert(book_tags.end(), std::make_move_iterator(shard_tags.begin()),
+                                     std::make_move_iterator(shard_tags.end()));
+                }
+                return book_tags;
+            }
+
+            std::vector<std::string> ReadById(const std::string& book_id) override {
+                if (auto shard = unit_.FindBookShard(book_id)) {
+                    return unit_.ReadShard(*shard, [&book_id](UnitOfWork& unit) {
+                        return unit.BookTags()->ReadById(book_id);
+                    });
+                }
+                return {};
+            }
+            void Update(const domain::BookTags& book_tags) override {
+                unit_.BookShard(book_tags.GetBookId()).BookTags()->Update(book_tags);
+            }
+            void DeleteById(const std::string& book_id) override {
+                unit_.BookShard(book_id).BookTags()->DeleteById(book_id);
+            }
+
+            // Первые top_k по шардам не дают общих первых top_k, поэтому счётчики суммируются целиком
+            std::vector<std::pair<std::string, std::size_t>> ReadTopTags(std::size_t top_k) override {
+                std::map<std::string, std::size_t> counts;
+                for (std::size_t shard = 0; shard < unit_.ShardCount(); ++shard) {
+                    auto shard_tags = unit_.ReadShard(shard, [](UnitOfWork& unit) {
+                        return unit.BookTags()->ReadTopTags(ALL_ROWS);
+                    });
+                    for (const auto& [tag, count] : shard_tags) {
+                        counts[tag] += count;
+                    }
+                }
+                std::vector<std::pair<std::string, std::size_t>> top_tags(counts.begin(), counts.end());
+                std::stable_sort(top_tags.begin(), top_tags.end(), [](const auto& lhs, const auto& rhs) {
+                    return lhs.second > rhs.second;
+                });
+                top_tags.resize(std::min(top_tags.size(), top_k));
+                return top_tags;
+            }
+
+        private:
+            ShardedUnitOfWork& unit_;
+        };
+
+        std::size_t ShardCount() const noexcept {
+            return units_.size();
+        }
+
+        // Транзакция шарда. Без двухфазной фиксации пишущий unit of work работает только с одним шардом
+        UnitOfWork& Shard(std::size_t shard) {
+            auto& unit = units_[shard];
+            if (!unit) {
+                if (!options_.read_only && std::any_of(units_.begin(), units_.end(), [](const auto& other) {
+                        return other != nullptr;
+                    })) {
+                    throw std::logic_error("A writing unit of work cannot span several shards");
+                }
+                unit = factory_.shards_[shard]->CreateUnitOfWork(options_);
+            }
+            return *unit;
+        }
+
+        // Чтение с шарда. Пишущий unit of work, ещё не открывший этот шард, читает его отдельной
+        // короткой read-only транзакцией: так поиск по всем шардам не открывает на них запись
+        template <typename Read>
+        std::invoke_result_t<Read&, UnitOfWork&> ReadShard(std::size_t shard, Read read) {
+            if (options_.read_only || units_[shard]) {
+                return read(Shard(shard));
+            }
+            auto unit = factory_.shards_[shard]->CreateUnitOfWork({.read_only = true});
+            auto result = read(*unit);
+            unit->Commit();
+            return result;
+        }
+
+        UnitOfWork& AuthorShard(const std::string& author_id) {
+            return Shard(factory_.GetAuthorShard(author_id));
+        }
+
+        // Шард автора с таким именем; нет такого - первый шард, чтобы ошибку выдало само хранилище
+        UnitOfWork& AuthorShardByName(const std::string& name) {
+            auto id = authors_.ReadIdByName(name);
+            return id ? AuthorShard(*id) : Shard(0);
+        }
+
+        std::optional<std::size_t> FindBookShard(const std::string& book_id) {
+            if (auto shard = factory_.FindBookShard(book_id)) {
+                return shard;
+            }
+            for (std::size_t shard = 0; shard < ShardCount(); ++shard) {
+                auto found = ReadShard(shard, [&book_id](UnitOfWork& unit) {
+                    return !unit.Book()->ReadById(book_id).id.empty();
+                });
+                if (found) {
+                    factory_.RememberBookShard(book_id, shard);
+                    return shard;
+                }
+            }
+            return std::nullopt;
+        }
+
+        UnitOfWork& BookShard(const std::string& book_id) {
+            return Shard(FindBookShard(book_id).value_or(0));
+        }
+
+        ShardedUnitOfWorkFactory& factory_;
+        UnitOfWorkOptions options_;
+        std::vector<std::unique_ptr<UnitOfWork>> units_;
+        Authors authors_;
+        Books books_;
+        Tags book_tags_;
+    };
+
+    //===============ShardedUnitOfWorkFactory=====
+    ShardedUnitOfWorkFactory::ShardedUnitOfWorkFactory(const std::vector<UnitOfWorkFactory*> &shards,
+                                                       std::size_t location_cache_bytes)
+            : shards_{shards}, ring_{shards.size()}, book_shards_{location_cache_bytes} {
+    }
+
+    std::unique_ptr<UnitOfWork> ShardedUnitOfWorkFactory::CreateUnitOfWork(const UnitOfWorkOptions &options) {
+        return std::make_unique<ShardedUnitOfWork>(*this, options);
+    }
+
+    std::optional<std::size_t> ShardedUnitOfWorkFactory::FindBookShard(const std::string &book_id) {
+        std::lock_guard lock{book_shards_mutex_};
+        return book_shards_.Get(book_id);
+    }
+
+    void ShardedUnitOfWorkFactory::RememberBookShard(const std::string &book_id, std::size_t shard) {
+        std::lock_guard lock{book_shards_mutex_};
+        book_shards_.Put(book_id, shard, book_id.size() + sizeof(shard));
+    }
+
+}  // namespace app
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../util/consistent_hash.h"
+#include "../util/lru_cache.h"
+#include "unit_of_work.h"
+
+namespace app {
+
+    /**
+     * Каталог, разбитый по авторам на несколько хранилищ (шардов). Автор попадает на шард по
+     * согласованному хешу AuthorId, его книги и их теги лежат там же, поэтому операции над одним
+     * автором и его книгами выполняются на одном шарде. Общие списки (ShowAuthors, ShowBooks,
+     * поиск по году, полнотекстовый поиск) собираются со всех шардов слиянием по ключам сортировки
+     * списка; поиск по сходству переранжируется так же, как в хранилище в памяти.
+     *
+     * Операции по id книги находят её шард чтением со всех шардов, найденное запоминается в кэше.
+     * Unit of work открывает транзакции шардов по мере обращения. Двухфазной фиксации нет, поэтому
+     * пишущий unit of work пишет только в один шард (второй - std::logic_error), а остальные шарды
+     * читает отдельными read-only транзакциями. Имя автора перед записью ищется на всех шардах
+     * запросом по имени; между шардами проверка не блокирующая.
+     */
+    class ShardedUnitOfWorkFactory : public UnitOfWorkFactory {
+    public:
+        explicit ShardedUnitOfWorkFactory(const std::vector<UnitOfWorkFactory*>& shards,
+                                          std::size_t location_cache_bytes = 1024 * 1024);
+
+        std::unique_ptr<UnitOfWork> CreateUnitOfWork(const UnitOfWorkOptions& options = {}) override;
+
+        std::size_t GetAuthorShard(const std::string& author_id) const {
+            return ring_.GetNode(author_id);
+        }
+
+    private:
+        class ShardedUnitOfWork;
+
+        std::optional<std::size_t> FindBookShard(const std::string& book_id);
+        void RememberBookShard(const std::string& book_id, std::size_t shard);
+
+        std::vector<UnitOfWorkFactory*> shards_;
+        util::ConsistentHashRing ring_;
+        std::mutex book_shards_mutex_;
+        util::LruCache<std::string, std::size_t> book_shards_;  // book_id -> шард; книга не меняет автора
+    };
+
+}  // namespace app
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../domain/book.h"
+
+namespace app {
+
+    /**
+     * Снимок каталога, общий для нескольких процессов на одной машине.
+     * Чтение никогда не блокируется: std::nullopt означает, что снимка нет или он устарел,
+     * и данные нужно взять из репозиториев.
+     * Публикация: GetGeneration() до чтения из БД, затем Publish() с этим значением -
+     * если между ними был Invalidate(), снимок не публикуется.
+     */
+    class SharedCatalog {
+    public:
+        using Generation = std::uint64_t;
+
+        virtual std::optional<std::vector<std::pair<std::string, std::string>>> ReadAuthors() = 0;
+        virtual std::optional<std::vector<domain::BookData>> ReadBooks() = 0;
+        virtual std::optional<std::vector<domain::BookData>> ReadAuthorBooks(const std::string& author_id) = 0;
+        virtual std::optional<std::pair<domain::BookData, std::vector<std::string>>> ReadBook(const std::string& book_id) = 0;
+
+        virtual Generation GetGeneration() = 0;
+        virtual bool Publish(Generation loaded_at,
+                             const std::vector<std::pair<std::string, std::string>>& authors,
+                             const std::vector<domain::BookData>& books,
+                             const std::vector<std::pair<std::string, std::string>>& book_tags) = 0;
+        virtual void Invalidate() = 0;
+
+    protected:
+        ~SharedCatalog() = default;
+    };
+
+}  // namespace app
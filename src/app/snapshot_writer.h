@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../domain/book.h"
+
+namespace app {
+
+    // Запись снимка каталога (авторы, книги, теги) в файл
+    class SnapshotWriter {
+    public:
+        virtual void Write(const std::string& path,
+                           const std::vector<std::pair<std::string, std::string>>& authors,
+                           const std::vector<domain::BookData>& books,
+                           const std::vector<std::pair<std::string, std::string>>& book_tags) = 0;
+
+    protected:
+        ~SnapshotWriter() = default;
+    };
+
+}  // namespace app
@@ -0,0 +1,173 @@
+#include "tag_index.h"
+
+#include <algorithm>
+
+namespace app {
+
+    TagIndex::Generation TagIndex::GetGeneration() {
+        std::lock_guard lock{mutex_};
+        return generation_;
+    }
+
+    bool TagIndex::Rebuild(Generation loaded_at, const std::vector<std::string> &book_ids,
+                           const BookTagPairs &book_tags) {
+        // Строится без блокировки, под ней только подменяется
+        TagIndex fresh;
+        for (const auto& book_id : book_ids) {
+            util::Insert(fresh.books_, fresh.GetOrdinal(book_id));
+        }
+        for (const auto& [book_id, tag] : book_tags) {
+            auto book = fresh.GetOrdinal(book_id);
+            util::Insert(fresh.books_, book);
+            fresh.AddTagsLocked(book, {tag});
+        }
+        std::lock_guard lock{mutex_};
+        if (generation_ != loaded_at) {
+            return false;
+        }
+        book_ids_ = std::move(fresh.book_ids_);
+        ordinals_ = std::move(fresh.ordinals_);
+        books_ = std::move(fresh.books_);
+        postings_ = std::move(fresh.postings_);
+        book_tags_ = std::move(fresh.book_tags_);
+        built_ = true;
+        return true;
+    }
+
+    void TagIndex::AddBook(const std::string &book_id) {
+        std::lock_guard lock{mutex_};
+        if (AcceptsUpdates()) {
+            util::Insert(books_, GetOrdinal(book_id));
+        }
+    }
+
+    void TagIndex::RemoveBook(const std::string &book_id) {
+        std::lock_guard lock{mutex_};
+        if (!AcceptsUpdates()) {
+            return;
+        }
+        auto it = ordinals_.find(book_id);
+        if (it == ordinals_.end()) {
+            return;
+        }
+        ClearTagsLocked(it->second);
+        util::Erase(books_, it->second);
+    }
+
+    void TagIndex::AddTags(const std::string &book_id, const std::vector<std::string> &tags) {
+        std::lock_guard lock{mutex_};
+        if (AcceptsUpdates()) {
+            auto book = GetOrdinal(book_id);
+            util::Insert(books_, book);
+            AddTagsLocked(book, tags);
+        }
+    }
+
+    void TagIndex::SetTags(const std::string &book_id, const std::vector<std::string> &tags) {
+        std::lock_guard lock{mutex_};
+        if (!AcceptsUpdates()) {
+            return;
+        }
+        auto book = GetOrdinal(book_id);
+        util::Insert(books_, book);
+        ClearTagsLocked(book);
+        AddTagsLocked(book, tags);
+    }
+
+    void TagIndex::MarkStale() {
+        std::lock_guard lock{mutex_};
+        built_ = false;
+        ++generation_;
+    }
+
+    std::optional<std::vector<std::string>> TagIndex::Find(const std::vector<std::string> &all_of,
+                                                           const std::vector<std::string> &any_of,
+                                                           const std::vector<std::string> &none_of) {
+        std::lock_guard lock{mutex_};
+        if (!built_) {
+            return std::nullopt;
+        }
+        // Пересечение начинается с самого короткого списка, чтобы промежуточные результаты были минимальны
+        std::vector<const util::PostingList*> required;
+        for (const auto& tag : all_of) {
+            auto it = postings_.find(tag);
+            if (it == postings_.end()) {
+                return std::vector<std::string>{};
+            }
+            required.push_back(&it->second);
+        }
+        std::sort(required.begin(), required.end(), [](const auto* lhs, const auto* rhs) {
+            return lhs->size() < rhs->size();
+        });
+
+        util::PostingList result = any_of.empty() ? books_ : UniteLocked(any_of);
+        for (const auto* list : required) {
+            if (result.empty()) {
+                break;
+            }
+            result = util::Intersect(result, *list);
+        }
+        if (!none_of.empty() && !result.empty()) {
+            result = util::Subtract(result, UniteLocked(none_of));
+        }
+
+        std::vector<std::string> book_ids;
+        book_ids.reserve(result.size());
+        for (auto book : result) {
+            book_ids.push_back(book_ids_[book]);
+        }
+        return book_ids;
+    }
+
+    std::uint32_t TagIndex::GetOrdinal(const std::string &book_id) {
+        auto [it, inserted] = ordinals_.try_emplace(book_id, static_cast<std::uint32_t>(book_ids_.size()));
+        if (inserted) {
+            book_ids_.push_back(book_id);
+        }
+        return it->second;
+    }
+
+    void TagIndex::AddTagsLocked(std::uint32_t book, const std::vector<std::string> &tags) {
+        auto& book_tags = book_tags_[book];
+        for (const auto& tag : tags) {
+            if (util::Insert(postings_[tag], book)) {
+                book_tags.push_back(tag);
+            }
+        }
+    }
+
+    void TagIndex::ClearTagsLocked(std::uint32_t book) {
+        auto it = book_tags_.find(book);
+        if (it == book_tags_.end()) {
+            return;
+        }
+        for (const auto& tag : it->second) {
+            auto posting = postings_.find(tag);
+            util::Erase(posting->second, book);
+            if (posting->second.empty()) {
+                postings_.erase(posting);
+            }
+        }
+        book_tags_.erase(it);
+    }
+
+    util::PostingList TagIndex::UniteLocked(const std::vector<std::string> &tags) const {
+        util::PostingList result;
+        for (const auto& tag : tags) {
+            if (auto it = postings_.find(tag); it != postings_.end()) {
+                result = util::Unite(result, it->second);
+            }
+        }
+        return result;
+    }
+
+    // Непостроенный индекс не обновляется, но идущее построение могло не увидеть изменение
+    bool TagIndex::AcceptsUpdates() {
+        if (!built_) {
+            ++generation_;
+            return false;
+        }
+        return true;
+    }
+
+}  // namespace app
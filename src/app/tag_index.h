@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../util/posting_list.h"
+
+namespace app {
+
+    /**
+     * Инвертированный индекс тегов: тег -> отсортированный список внутренних номеров книг.
+     * Строится из book_tags и поддерживается use case'ами записи; изменения других процессов
+     * помечают его устаревшим. Пока индекс не построен, Find() возвращает nullopt. Потокобезопасен.
+     */
+    class TagIndex {
+    public:
+        using Generation = std::uint64_t;
+        using BookTagPairs = std::vector<std::pair<std::string, std::string>>;  // book_id, tag
+
+        // Значение для Rebuild: если до него индекс изменён или помечен устаревшим, построение не применяется
+        Generation GetGeneration();
+        bool Rebuild(Generation loaded_at, const std::vector<std::string>& book_ids, const BookTagPairs& book_tags);
+
+        void AddBook(const std::string& book_id);
+        void RemoveBook(const std::string& book_id);
+        void AddTags(const std::string& book_id, const std::vector<std::string>& tags);
+        void SetTags(const std::string& book_id, const std::vector<std::string>& tags);
+        void MarkStale();
+
+        // Книги со всеми тегами all_of, хотя бы одним из any_of (если он не пуст) и без тегов none_of
+        std::optional<std::vector<std::string>> Find(const std::vector<std::string>& all_of,
+                                                     const std::vector<std::string>& any_of,
+                                                     const std::vector<std::string>& none_of);
+
+    private:
+        std::uint32_t GetOrdinal(const std::string& book_id);
+        void AddTagsLocked(std::uint32_t book, const std::vector<std::string>& tags);
+        void ClearTagsLocked(std::uint32_t book);
+        util::PostingList UniteLocked(const std::vector<std::string>& tags) const;
+        bool AcceptsUpdates();
+
+        std::mutex mutex_;
+        bool built_ = false;
+        Generation generation_ = 0;
+        std::vector<std::string> book_ids_;
+        std::unordered_map<std::string, std::uint32_t> ordinals_;
+        util::PostingList books_;
+        std::unordered_map<std::string, util::PostingList> postings_;
+        std::unordered_map<std::uint32_t, std::vector<std::string>> book_tags_;
+    };
+
+}  // namespace app
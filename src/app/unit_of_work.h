@@ -1,26 +1,48 @@
 #pragma once
+#include <memory>
 
 #include "../domain/author_fwd.h"
 
 namespace app {
 
+    // Долговечность пишущей транзакции. kAsync - Commit не ждёт сброса журнала на диск: при сбое
+    // сервера могут потеряться последние доли секунды подтверждённых записей, но данные остаются
+    // согласованными. Хранилища без диска считают оба уровня одинаковыми
+    enum class Durability {
+        kStrict,
+        kAsync,
+    };
+
+    struct UnitOfWorkOptions {
+        // Только чтение, все запросы видят один снимок данных
+        bool read_only = false;
+        Durability durability = Durability::kStrict;
+        // Пишущий unit of work тоже видит один снимок: для сессий из нескольких шагов. Правка строк,
+        // изменённых после начала снимка, - ошибка, а не перезапись чужих изменений. Хранилище
+        // в памяти снимок для записи не держит
+        bool consistent_snapshot = false;
+        // Читать с primary, а не с реплик: для кэшей и производных структур, которые сбрасываются по
+        // уведомлениям primary. Прочитанное с отставшей реплики осталось бы в них устаревшим
+        bool primary = false;
+    };
+
+    // Удаление UnitOfWork без Commit откатывает изменения
     class UnitOfWork {
     public:
+        virtual ~UnitOfWork() = default;
+
         virtual domain::AuthorRepository* Author() = 0;
         virtual domain::BookRepository* Book() = 0;
         virtual domain::BookTagsRepository* BookTags() = 0;
         virtual void Commit() = 0;
-
-    protected:
-        ~UnitOfWork() = default;
     };
 
     class UnitOfWorkFactory{
     public:
-        virtual UnitOfWork* CreateUnitOfWork() = 0;
+        virtual std::unique_ptr<UnitOfWork> CreateUnitOfWork(const UnitOfWorkOptions& options = {}) = 0;
 
     protected:
         ~UnitOfWorkFactory() = default;
     };
 
-}
\ No newline at end of file
+}
@@ -1,8 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <ostream>
 #include <string>
 #include <vector>
 
+#include "catalog_importer.h"
+#include "change_feed.h"
+
 namespace app {
 
     struct BookData{
@@ -13,6 +20,36 @@ namespace app {
         int year = 0;
     };
 
+    struct BooksPage {
+        std::vector<BookData> books;
+        bool has_more = false;
+    };
+
+    struct Completions {
+        std::vector<std::string> authors;
+        std::vector<std::string> titles;
+        // id найденных авторов и книг (книг с одним названием может быть несколько), в порядке имён
+        std::vector<std::string> author_ids;
+        std::vector<std::string> book_ids;
+    };
+
+    struct CatalogCounts {
+        std::size_t authors = 0;
+        std::size_t books = 0;
+    };
+
+    struct AuthorYears {
+        std::string author_name;
+        int first_year = 0;
+        int last_year = 0;
+    };
+
+    // Автор добавляемой книги: существующий по id либо новый по имени
+    struct AuthorRef {
+        std::string id;
+        std::string new_name;   // используется, если id пуст
+    };
+
     struct ShowBookData {
         std::string title;
         std::string author_name;
@@ -20,12 +57,31 @@ namespace app {
         std::vector<std::string> tags;
     };
 
+    /**
+     * Транзакция, общая для всех use case'ов, вызванных в потоке, открывшем сессию, пока она
+     * открыта - обычно на одну команду View. Все шаги команды видят согласованные данные и не
+     * платят за отдельные BEGIN/COMMIT. Удаление сессии без Commit откатывает её изменения.
+     */
+    class Session {
+    public:
+        virtual ~Session() = default;
+
+        // Завершает сессию: следующие use case'ы снова выполняются каждый в своей транзакции
+        virtual void Commit() = 0;
+    };
+
 class UseCases {
 public:
     //virtual void CreateUnitOfWork() = 0;
 
+    // read_only - сессия только читает и видит один снимок данных. Вложенные сессии не поддерживаются
+    virtual std::unique_ptr<Session> OpenSession(bool read_only) = 0;
+
     virtual std::string AddAuthor(const std::string& name) = 0;
     virtual std::vector<std::pair<std::string, std::string>> ShowAuthors() = 0;
+    // Имя автора; nullopt - автора нет
+    virtual std::optional<std::string> ShowAuthorById(const std::string& author_id) = 0;
+    virtual std::vector<std::pair<std::string, std::string>> FindSimilarAuthors(const std::string& name, std::size_t limit) = 0;
     virtual void DeleteAuthorByName(const std::string& name) = 0;
     virtual void DeleteAuthorById(const std::string& id) = 0;
     virtual void EditAuthorByName(const std::string& old_name, const std::string& new_name) = 0;
@@ -33,18 +89,61 @@ public:
 
     virtual std::string AddBook(const std::string& author_id, const std::string& title, int year ) = 0;
     virtual void AddBookTags(const std::string& book_id, const std::vector<std::string>& tags) = 0;
+    // Автор (если новый), книга и её теги добавляются одной транзакцией; возвращает id книги
+    virtual std::string AddBookWithTags(const AuthorRef& author, const std::string& title, int year,
+                                        const std::vector<std::string>& tags) = 0;
     virtual std::vector<BookData> ShowBooks() = 0;
     virtual std::vector<BookData> ShowBooksByTitle(const std::string& title) = 0;
     virtual ShowBookData ShowBookById(const std::string& book_id) = 0;
     virtual std::vector<BookData> ShowAuthorBooks(const std::string& author_id) = 0;
+    virtual std::vector<BookData> FindSimilarBooks(const std::string& title, std::size_t limit) = 0;
+    virtual std::vector<BookData> FindBooksByTags(const std::vector<std::string>& all_of,
+                                                  const std::vector<std::string>& any_of,
+                                                  const std::vector<std::string>& none_of) = 0;
+    // page - номер страницы с нуля
+    virtual BooksPage ShowBooksByYearRange(int from, int to, std::size_t page, std::size_t page_size) = 0;
+    // Не более limit имён авторов и не более limit названий книг, начинающихся с prefix, и не более limit id
+    virtual Completions Autocomplete(const std::string& prefix, std::size_t limit) = 0;
+    // Число авторов и книг - по индексам автодополнения, без чтения списков после их построения
+    virtual CatalogCounts CountCatalog() = 0;
+    virtual std::vector<BookData> SearchBooks(const std::string& query, std::size_t limit, std::size_t offset = 0) = 0;
     virtual void DeleteBookByName(const std::string& name) = 0;
     virtual void DeleteBookById(const std::string& id) = 0;
     virtual void EditBookTitleById(const std::string& id, const std::string& new_name) = 0;
     virtual void EditBookYearById(const std::string& id, int new_year) = 0;
+    // Заданные поля книги меняются одной транзакцией; теги, если заданы, заменяются целиком
+    virtual void PatchBook(const std::string& id, const std::optional<std::string>& new_title,
+                           const std::optional<int>& new_year,
+                           const std::optional<std::vector<std::string>>& new_tags) = 0;
 
     virtual std::vector<std::string> GetBookTagsById(const std::string& book_id) = 0;
     virtual void DeleteBookTagsById(const std::string& book_id) = 0;
     virtual void EditBookTagsById(const std::string& id, const std::vector<std::string>& new_tags) = 0;
+    // Не более top_k самых популярных тегов: тег, число книг
+    virtual std::vector<std::pair<std::string, std::size_t>> TagStats(std::size_t top_k) = 0;
+
+    // Аналитика по колоночному снимку книг
+    // Год, число книг - годы из [from, to], в которых есть книги
+    virtual std::vector<std::pair<int, std::size_t>> BooksPerYear(int from, int to) = 0;
+    // Имя автора, число книг - по убыванию числа книг
+    virtual std::vector<std::pair<std::string, std::size_t>> BooksPerAuthor() = 0;
+    // Начало интервала в bucket_years лет, число книг
+    virtual std::vector<std::pair<int, std::size_t>> YearHistogram(int bucket_years) = 0;
+    // Годы первой и последней книги каждого автора, по имени автора
+    virtual std::vector<AuthorYears> AuthorYearSpan() = 0;
+
+    // Записывает авторов, книги и теги в файл снимка, согласованно (одной транзакцией)
+    virtual void WriteSnapshot(const std::string& path) = 0;
+    // Импорт каталога из файла пачками, каждая пачка - одной транзакцией; progress вызывается
+    // после каждой пачки. Ошибка формата файла - std::invalid_argument с номером строки,
+    // пачки до неё остаются импортированными
+    virtual ImportStats ImportCatalog(const std::string& path, ImportFormat format,
+                                      const ImportProgress& progress = {}) = 0;
+    // Выгрузка всех книг с авторами и тегами в output в формате импорта; возвращает число книг
+    virtual std::size_t ExportCatalog(std::ostream& output, ImportFormat format) = 0;
+
+    virtual std::size_t SubscribeChanges(ChangeHandler handler) = 0;
+    virtual void UnsubscribeChanges(std::size_t subscription) = 0;
 
     //virtual void Commit() = 0;
 
@@ -1,5 +1,10 @@
 #include "use_cases_impl.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
 #include <stdexcept>
+#include <tuple>
 
 #include "../domain/author.h"
 #include "../domain/book.h"
@@ -7,77 +12,359 @@
 namespace app {
     using namespace domain;
 
+    namespace {
+        constexpr UnitOfWorkOptions READ_ONLY{.read_only = true};
+        // Чтение, которое запоминается в кэше, фильтрах, индексах или общем снимке
+        constexpr UnitOfWorkOptions FILL_READ{.read_only = true, .primary = true};
+
+        std::vector<BookData> ToBookData(const std::vector<domain::BookData>& books) {
+            std::vector<BookData> book_data;
+            book_data.reserve(books.size());
+            for(const auto& [id, author_id, author_name, title, year] : books){
+                book_data.push_back({id, author_id, author_name, title, year});
+            }
+            return book_data;
+        }
+
+        // Запрос к индексу автодополнения. Непостроенный индекс строится из load() (списки авторов и книг:
+        // кэш, общий снимок или БД); если за время загрузки индекс изменился, запрос выполняется по временному
+        template <typename Load, typename Query>
+        auto QueryCompleter(NameCompleter& completer, const Load& load, const Query& query) {
+            if (auto found = query(completer)) {
+                return std::move(*found);
+            }
+            auto generation = completer.GetGeneration();
+            auto entries = load();
+            completer.Rebuild(generation, entries);
+            if (auto found = query(completer)) {
+                return std::move(*found);
+            }
+            NameCompleter snapshot;
+            snapshot.Rebuild(snapshot.GetGeneration(), entries);
+            return std::move(*query(snapshot));
+        }
+
+        // Новое имя из события добавляется в фильтр без перестроения; удаление (чтобы фильтр не копил
+        // удалённые имена) и событие без имени перестраивают его. Автодополнение при изменении
+        // перестраивается: прежнее имя неизвестно
+        void ApplyNameChange(const ChangeEvent& event, NameFilter& filter, NameCompleter& completer) {
+            if (event.name.empty()) {
+                filter.MarkStale();
+                completer.MarkStale();
+                return;
+            }
+            switch (event.op) {
+                case ChangeOp::kInsert:
+                    filter.Add(event.name);
+                    completer.Add(event.id, event.name);
+                    break;
+                case ChangeOp::kUpdate:
+                    filter.Add(event.name);
+                    completer.MarkStale();
+                    break;
+                default:
+                    filter.MarkStale();
+                    completer.Remove(event.id, event.name);
+                    break;
+            }
+        }
+    }
+
+    UseCasesImpl::UseCasesImpl(UnitOfWorkFactory &factory, const UseCasesConfig &config,
+                               ChangeFeed *change_feed, SharedCatalog* shared_catalog,
+                               SnapshotWriter* snapshot_writer, CatalogImporter* importer,
+                               CatalogExporter* exporter)
+            : unit_of_work_factory_(factory), cache_(config.cache_capacity_bytes),
+              author_names_(config.name_filter_false_positive_rate, config.name_filter_max_bytes),
+              book_titles_(config.name_filter_false_positive_rate, config.name_filter_max_bytes),
+              change_feed_(change_feed), shared_catalog_(shared_catalog),
+              snapshot_writer_(snapshot_writer), importer_(importer), exporter_(exporter),
+              import_batch_size_(std::max<std::size_t>(config.import_batch_size, 1)),
+              tag_writes_{.durability = config.tags_durability},
+              import_durability_(config.import_durability),
+              similarity_threshold_(config.similarity_threshold),
+              keep_analytics_snapshot_(config.keep_analytics_snapshot){
+        if (change_feed_) {
+            change_subscription_ = change_feed_->Subscribe([this](const ChangeEvent& event) {
+                OnChange(event);
+            });
+        }
+    }
+
+    UseCasesImpl::~UseCasesImpl() {
+        if (change_feed_) {
+            change_feed_->Unsubscribe(change_subscription_);
+        }
+    }
+
+    class UseCasesImpl::SessionImpl : public Session {
+    public:
+        SessionImpl(UseCasesImpl& use_cases, std::unique_ptr<UnitOfWork> unit)
+            : use_cases_(use_cases), unit_(std::move(unit)) {
+        }
+
+        ~SessionImpl() override {
+            if (unit_) {
+                unit_.reset();
+                use_cases_.CloseSession(false);
+            }
+        }
+
+        void Commit() override {
+            if (!unit_) {
+                throw std::logic_error("Session is closed");
+            }
+            auto unit = std::move(unit_);
+            try {
+                unit->Commit();
+            } catch (const std::exception&) {
+                use_cases_.CloseSession(false);
+                throw;
+            }
+            use_cases_.CloseSession(true);
+        }
+
+    private:
+        UseCasesImpl& use_cases_;
+        std::unique_ptr<UnitOfWork> unit_;
+    };
+
+    std::unique_ptr<Session> UseCasesImpl::OpenSession(bool read_only) {
+        auto unit = unit_of_work_factory_.CreateUnitOfWork({.read_only = read_only, .consistent_snapshot = true});
+        std::lock_guard lock{session_mutex_};
+        if (session_unit_) {
+            throw std::logic_error("Session is already open");
+        }
+        session_unit_ = unit.get();
+        session_thread_ = std::this_thread::get_id();
+        session_read_only_ = read_only;
+        session_changed_ = false;
+        return std::make_unique<SessionImpl>(*this, std::move(unit));
+    }
+
+    // Read-only сессия может читать с отставшей реплики, поэтому чтения, которые запоминаются
+    // в кэше, фильтрах и индексах, идут мимо неё отдельной транзакцией на primary
+    UseCasesImpl::ScopedUnit UseCasesImpl::BeginUnit(const UnitOfWorkOptions &options) {
+        {
+            std::lock_guard lock{session_mutex_};
+            if (session_unit_ && session_thread_ == std::this_thread::get_id()
+                && !(options.primary && session_read_only_)) {
+                return ScopedUnit{*session_unit_};
+            }
+        }
+        return ScopedUnit{unit_of_work_factory_.CreateUnitOfWork(options)};
+    }
+
+    bool UseCasesImpl::SessionHasChanges() {
+        std::lock_guard lock{session_mutex_};
+        return session_unit_ && session_thread_ == std::this_thread::get_id() && session_changed_;
+    }
+
+    // Производные структуры в сессии обновлялись до фиксации: после отката они перестраиваются,
+    // а общий снимок сбрасывается ещё раз, уже после того как изменения стали видны другим
+    void UseCasesImpl::CloseSession(bool committed) {
+        bool changed;
+        {
+            std::lock_guard lock{session_mutex_};
+            session_unit_ = nullptr;
+            changed = std::exchange(session_changed_, false);
+        }
+        if (!changed) {
+            return;
+        }
+        if (!committed) {
+            ResetCatalogState();
+        }
+        DropCatalogSnapshots();
+    }
+
     std::string UseCasesImpl::AddAuthor(const std::string& name) {
         auto author_id = AuthorId::New();
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto unit = BeginUnit();
         try{
             unit->Author()->Save({author_id, name});
-            unit->Commit();
+            unit.Commit();
+            author_names_.Add(name);
+            author_completer_.Add(author_id.ToString(), name);
+            cache_.InvalidateAuthorList();
+            CatalogChanged();
             return author_id.ToString();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed AddAuthor");
         }
     }
 
     std::vector<std::pair<std::string, std::string>> UseCasesImpl::ShowAuthors() {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        if (auto cached = cache_.FindAuthors()) {
+            return *cached;
+        }
+        auto generation = cache_.GetGeneration();
+        if (shared_catalog_) {
+            if (auto shared = shared_catalog_->ReadAuthors()) {
+                cache_.PutAuthors(generation, *shared);
+                return *shared;
+            }
+            if (auto loaded = RefreshSharedCatalog()) {
+                return loaded->authors;
+            }
+        }
+        auto unit = BeginUnit(FILL_READ);
         try{
             std::vector<std::pair<std::string, std::string>> result = unit->Author()->Read();
-            unit->Commit();
+            unit.Commit();
+            cache_.PutAuthors(generation, result);
             return result;
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed ShowAuthors");
         }
     }
 
+    std::optional<std::string> UseCasesImpl::ShowAuthorById(const std::string &author_id) {
+        if (auto cached = cache_.FindAuthor(author_id)) {
+            return cached;
+        }
+        auto generation = cache_.GetGeneration();
+        auto unit = BeginUnit(FILL_READ);
+        try{
+            auto name = unit->Author()->ReadNameById(author_id);
+            unit.Commit();
+            if (name) {
+                cache_.PutAuthor(generation, author_id, *name);
+            }
+            return name;
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed ShowAuthorById");
+        }
+    }
+
+    std::vector<std::pair<std::string, std::string>> UseCasesImpl::FindSimilarAuthors(const std::string &name,
+                                                                                      std::size_t limit) {
+        if (limit == 0) {
+            return {};
+        }
+        auto unit = BeginUnit(READ_ONLY);
+        try{
+            auto authors = unit->Author()->FindSimilar(name, similarity_threshold_, limit);
+            unit.Commit();
+            return authors;
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed FindSimilarAuthors");
+        }
+    }
+
     void UseCasesImpl::DeleteAuthorByName(const std::string &name) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        if (!AuthorMayExist(name)) {
+            throw std::logic_error("Failed DeleteAuthorByName");
+        }
+        auto unit = BeginUnit();
         try{
             unit->Author()->DeleteByName(name);
-            unit->Commit();
+            unit.Commit();
+            cache_.InvalidateAuthorByName(name);
+            tag_index_.MarkStale();
+            author_completer_.Erase(name);
+            title_completer_.MarkStale();
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed DeleteAuthorByName");
         }
     }
 
     void UseCasesImpl::DeleteAuthorById(const std::string &id) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        // Имя из кэша позволяет обновить автодополнение точно, а не перестраивать его
+        auto name = cache_.FindAuthor(id);
+        auto unit = BeginUnit();
         try{
             unit->Author()->DeleteById(id);
-            unit->Commit();
+            unit.Commit();
+            cache_.InvalidateAuthor(id);
+            tag_index_.MarkStale();
+            if (name) {
+                author_completer_.Erase(*name);
+            } else {
+                author_completer_.MarkStale();
+            }
+            title_completer_.MarkStale();
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed DeleteAuthorById");
         }
     }
 
     std::string UseCasesImpl::AddBook(const std::string &author_id, const std::string &title, int year) {
         auto book_id = BookId::New();
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto unit = BeginUnit();
         try{
             unit->Book()->Save( {book_id, author_id, title, year} );
-            unit->Commit();
+            unit.Commit();
+            book_titles_.Add(title);
+            title_completer_.Add(book_id.ToString(), title);
+            tag_index_.AddBook(book_id.ToString());
+            cache_.InvalidateBookList();
+            CatalogChanged();
             return book_id.ToString();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed AddBook");
         }
     }
 
     void UseCasesImpl::AddBookTags(const std::string& book_id, const std::vector<std::string>& tags) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto unit = BeginUnit(tag_writes_);
         try{
             unit->BookTags()->Save(BookTags{book_id, tags});
-            unit->Commit();
+            unit.Commit();
+            tag_index_.AddTags(book_id, tags);
+            cache_.InvalidateBook(book_id);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed AddBookTags");
         }
     }
 
+    std::string UseCasesImpl::AddBookWithTags(const AuthorRef &author, const std::string &title, int year,
+                                              const std::vector<std::string> &tags) {
+        auto book_id = BookId::New();
+        auto author_id = author.id;
+        auto unit = BeginUnit();
+        try{
+            if (author_id.empty()) {
+                auto new_author_id = AuthorId::New();
+                unit->Author()->Save({new_author_id, author.new_name});
+                author_id = new_author_id.ToString();
+            }
+            unit->Book()->Save({book_id, author_id, title, year});
+            if (!tags.empty()) {
+                unit->BookTags()->Save(BookTags{book_id.ToString(), tags});
+            }
+            unit.Commit();
+            if (author.id.empty()) {
+                author_names_.Add(author.new_name);
+                author_completer_.Add(author_id, author.new_name);
+                cache_.InvalidateAuthorList();
+            }
+            book_titles_.Add(title);
+            title_completer_.Add(book_id.ToString(), title);
+            tag_index_.AddBook(book_id.ToString());
+            if (!tags.empty()) {
+                tag_index_.AddTags(book_id.ToString(), tags);
+            }
+            cache_.InvalidateBookList();
+            CatalogChanged();
+            return book_id.ToString();
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed AddBookWithTags");
+        }
+    }
+
     std::vector<BookData> UseCasesImpl::ShowBooks() {
         /*struct BookData{
             std::string id;
@@ -86,39 +373,163 @@ namespace app {
             std::string title;
             int year = 0;
         };*/
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
-        std::vector<BookData> book_data;
-        try{
-            for(const auto& [id, author_id, author_name, title, year]
-                                                : unit->Book()->Read()){
-                book_data.push_back({id, author_id, author_name, title, year});
+        return ToBookData(ReadBookList());
+    }
+
+    std::vector<domain::BookData> UseCasesImpl::ReadBookList() {
+        if (auto cached = cache_.FindBooks()) {
+            return std::move(*cached);
+        }
+        auto generation = cache_.GetGeneration();
+        if (shared_catalog_) {
+            if (auto shared = shared_catalog_->ReadBooks()) {
+                cache_.PutBooks(generation, *shared);
+                return std::move(*shared);
             }
-            unit->Commit();
-            return book_data;
+            if (auto loaded = RefreshSharedCatalog()) {
+                return std::move(loaded->books);
+            }
+        }
+        auto unit = BeginUnit(FILL_READ);
+        try{
+            auto books = unit->Book()->Read();
+            unit.Commit();
+            cache_.PutBooks(generation, books);
+            return books;
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed ShowBooks");
         }
     }
 
+    NameCompleter::Entries UseCasesImpl::ReadTitleEntries() {
+        NameCompleter::Entries titles;
+        for (auto& book : ReadBookList()) {
+            titles.emplace_back(std::move(book.id), std::move(book.title));
+        }
+        return titles;
+    }
+
     std::vector<BookData> UseCasesImpl::ShowBooksByTitle(const std::string &book_title) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        if (!BookTitleMayExist(book_title)) {
+            return {};
+        }
+        auto unit = BeginUnit(READ_ONLY);
         std::vector<BookData> book_data;
         try{
             for(const auto& [id, author_id, author_name, title, year]
                                                 : unit->Book()->ReadByName(book_title)){
                 book_data.push_back({id, author_id, author_name, title, year});
             }
-            unit->Commit();
+            unit.Commit();
             return book_data;
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed ShowBooksByTitle");
         }
     }
 
+    std::vector<BookData> UseCasesImpl::FindSimilarBooks(const std::string &title, std::size_t limit) {
+        if (limit == 0) {
+            return {};
+        }
+        auto unit = BeginUnit(READ_ONLY);
+        try{
+            auto books = unit->Book()->FindSimilar(title, similarity_threshold_, limit);
+            unit.Commit();
+            return ToBookData(books);
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed FindSimilarBooks");
+        }
+    }
+
+    // Найденные книги читаются по id (обычно из кэша), а не фильтрацией всего списка.
+    // Порядок результата - как в ShowBooks: по названию, имени автора и году
+    std::vector<BookData> UseCasesImpl::FindBooksByTags(const std::vector<std::string> &all_of,
+                                                        const std::vector<std::string> &any_of,
+                                                        const std::vector<std::string> &none_of) {
+        auto book_ids = FindBookIdsByTags(all_of, any_of, none_of);
+        if (book_ids.empty()) {
+            return {};
+        }
+        std::vector<domain::BookData> books;
+        books.reserve(book_ids.size());
+        for (auto& book : ReadBooksById(book_ids)) {
+            books.push_back(std::move(book.data));
+        }
+        std::sort(books.begin(), books.end(), [](const domain::BookData& lhs, const domain::BookData& rhs) {
+            return std::tie(lhs.title, lhs.author_name, lhs.year, lhs.id)
+                   < std::tie(rhs.title, rhs.author_name, rhs.year, rhs.id);
+        });
+        return ToBookData(books);
+    }
+
+    BooksPage UseCasesImpl::ShowBooksByYearRange(int from, int to, std::size_t page, std::size_t page_size) {
+        if (from > to || page_size == 0) {
+            return {};
+        }
+        auto unit = BeginUnit(READ_ONLY);
+        try{
+            // Лишняя запись показывает, есть ли следующая страница
+            auto books = unit->Book()->ReadByYearRange(from, to, page_size + 1, page * page_size);
+            unit.Commit();
+            BooksPage result;
+            result.has_more = books.size() > page_size;
+            books.resize(std::min(books.size(), page_size));
+            result.books = ToBookData(books);
+            return result;
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed ShowBooksByYearRange");
+        }
+    }
+
+    Completions UseCasesImpl::Autocomplete(const std::string &prefix, std::size_t limit) {
+        auto complete = [&prefix, limit](NameCompleter& completer) {
+            return completer.Complete(prefix, limit);
+        };
+        auto authors = QueryCompleter(author_completer_, [this] { return ShowAuthors(); }, complete);
+        auto titles = QueryCompleter(title_completer_, [this] { return ReadTitleEntries(); }, complete);
+        return {std::move(authors.names), std::move(titles.names), std::move(authors.ids), std::move(titles.ids)};
+    }
+
+    CatalogCounts UseCasesImpl::CountCatalog() {
+        auto count = [](NameCompleter& completer) {
+            return completer.GetCount();
+        };
+        return {QueryCompleter(author_completer_, [this] { return ShowAuthors(); }, count),
+                QueryCompleter(title_completer_, [this] { return ReadTitleEntries(); }, count)};
+    }
+
+    std::vector<BookData> UseCasesImpl::SearchBooks(const std::string &query, std::size_t limit, std::size_t offset) {
+        if (limit == 0) {
+            return {};
+        }
+        auto unit = BeginUnit(READ_ONLY);
+        try{
+            std::vector<domain::BookData> books;
+            for (auto& found : unit->Book()->Search(query, limit, offset)) {
+                books.push_back(std::move(found.data));
+            }
+            unit.Commit();
+            return ToBookData(books);
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed SearchBooks");
+        }
+    }
+
     ShowBookData UseCasesImpl::ShowBookById(const std::string &book_id) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        if (auto cached = cache_.FindBook(book_id)) {
+            return {cached->data.title, cached->data.author_name, cached->data.year, cached->tags};
+        }
+        if (auto shared = ReadSharedBook(book_id)) {
+            return {shared->data.title, shared->data.author_name, shared->data.year, shared->tags};
+        }
+        // Сброс, пришедший во время чтения, мог относиться к этой книге - тогда прочитанное не кэшируется
+        auto generation = cache_.GetGeneration();
+        auto unit = BeginUnit(FILL_READ);
         ShowBookData show_book;
         try{
             auto book_data = unit->Book()->ReadById(book_id);
@@ -126,26 +537,37 @@ namespace app {
             show_book.author_name = book_data.author_name;
             show_book.publication_year = book_data.year;
             show_book.tags = unit->BookTags()->ReadById(book_id);
-            unit->Commit();
+            unit.Commit();
+            if (!book_data.id.empty()) {
+                cache_.PutBook(generation, {book_data, show_book.tags});
+                if (!book_data.author_name.empty()) {
+                    cache_.PutAuthor(generation, book_data.author_id, book_data.author_name);
+                }
+            }
             return show_book;
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed ShowBookById");
         }
     }
 
     std::vector<BookData> UseCasesImpl::ShowAuthorBooks(const std::string &a_id) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        if (shared_catalog_) {
+            if (auto shared = shared_catalog_->ReadAuthorBooks(a_id)) {
+                return ToBookData(*shared);
+            }
+        }
+        auto unit = BeginUnit(READ_ONLY);
         std::vector<BookData> book_data;
         try{
             for(const auto& [id, author_id, author_name, title, year]
                                                 : unit->Book()->ReadAuthorBooks(a_id)){
                 book_data.push_back({id, author_id, author_name, title, year});
             }
-            unit->Commit();
+            unit.Commit();
             return book_data;
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed ShowAuthorBooks");
         }
     }
@@ -157,106 +579,583 @@ namespace app {
     }*/
 
     void UseCasesImpl::EditAuthorByName(const std::string &old_name, const std::string &new_name) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        if (!AuthorMayExist(old_name)) {
+            throw std::logic_error("Failed EditAuthorByName");
+        }
+        auto unit = BeginUnit();
         try{
             unit->Author()->EditByName(old_name, new_name);
-            unit->Commit();
+            unit.Commit();
+            author_names_.Add(new_name);
+            author_completer_.Rename(old_name, new_name);
+            cache_.InvalidateAuthorByName(old_name);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed EditAuthorByName");
         }
     }
 
     void UseCasesImpl::EditAuthorById(const std::string &id, const std::string &new_name) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto old_name = cache_.FindAuthor(id);
+        auto unit = BeginUnit();
         try{
             unit->Author()->EditById(id, new_name);
-            unit->Commit();
+            unit.Commit();
+            author_names_.Add(new_name);
+            if (old_name) {
+                author_completer_.Rename(*old_name, new_name);
+            } else {
+                author_completer_.MarkStale();
+            }
+            cache_.InvalidateAuthor(id);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed EditAuthorById");
         }
     }
 
     void UseCasesImpl::DeleteBookByName(const std::string &name) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        if (!BookTitleMayExist(name)) {
+            return;
+        }
+        auto unit = BeginUnit();
         try{
             unit->Book()->DeleteByName(name);
-            unit->Commit();
+            unit.Commit();
+            tag_index_.MarkStale();
+            title_completer_.Erase(name);
+            cache_.InvalidateBooksByTitle(name);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed DeleteBookByName");
         }
     }
 
     void UseCasesImpl::DeleteBookById(const std::string &id) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto unit = BeginUnit();
         try{
             unit->Book()->DeleteById(id);
-            unit->Commit();
+            unit.Commit();
+            tag_index_.RemoveBook(id);
+            title_completer_.MarkStale();
+            cache_.InvalidateBook(id);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed DeleteBookById");
         }
     }
 
     void UseCasesImpl::EditBookTitleById(const std::string &id, const std::string &new_name) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto unit = BeginUnit();
         try{
             unit->Book()->EditTitleById(id, new_name);
-            unit->Commit();
+            unit.Commit();
+            book_titles_.Add(new_name);
+            title_completer_.MarkStale();
+            cache_.InvalidateBook(id);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed EditBookTitleById");
         }
     }
 
     void UseCasesImpl::EditBookYearById(const std::string &id, int new_year) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto unit = BeginUnit();
         try{
             unit->Book()->EditYearById(id, new_year);
-            unit->Commit();
+            unit.Commit();
+            cache_.InvalidateBook(id);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed EditBookYearById");
         }
     }
 
+    void UseCasesImpl::PatchBook(const std::string &id, const std::optional<std::string> &new_title,
+                                 const std::optional<int> &new_year,
+                                 const std::optional<std::vector<std::string>> &new_tags) {
+        if (!new_title && !new_year && !new_tags) {
+            return;
+        }
+        auto unit = BeginUnit();
+        try{
+            if (new_title || new_year) {
+                unit->Book()->Patch(id, new_title, new_year);
+            }
+            if (new_tags) {
+                unit->BookTags()->Update({id, *new_tags});
+            }
+            unit.Commit();
+            if (new_title) {
+                book_titles_.Add(*new_title);
+                title_completer_.MarkStale();
+            }
+            if (new_tags) {
+                tag_index_.SetTags(id, *new_tags);
+            }
+            cache_.InvalidateBook(id);
+            CatalogChanged();
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed PatchBook");
+        }
+    }
+
     std::vector<std::string> UseCasesImpl::GetBookTagsById(const std::string &book_id) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        if (auto cached = cache_.FindBook(book_id)) {
+            return cached->tags;
+        }
+        if (auto shared = ReadSharedBook(book_id)) {
+            return shared->tags;
+        }
+        auto unit = BeginUnit(READ_ONLY);
         std::vector<std::string> book_tags;
         try{
             for(const auto& tag : unit->BookTags()->ReadById(book_id)){
                 book_tags.push_back(tag);
             }
-            unit->Commit();
+            unit.Commit();
             return book_tags;
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed GetBookTagsById");
         }
     }
 
     void UseCasesImpl::DeleteBookTagsById(const std::string &book_id) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto unit = BeginUnit(tag_writes_);
         try{
             unit->BookTags()->DeleteById(book_id);
-            unit->Commit();
+            unit.Commit();
+            tag_index_.SetTags(book_id, {});
+            cache_.InvalidateBook(book_id);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed DeleteBookTagsById");
         }
     }
 
     void UseCasesImpl::EditBookTagsById(const std::string &id, const std::vector<std::string> &new_tags) {
-        auto unit = unit_of_work_factory_.CreateUnitOfWork();
+        auto unit = BeginUnit(tag_writes_);
         try{
             unit->BookTags()->Update({id, new_tags});
-            unit->Commit();
+            unit.Commit();
+            tag_index_.SetTags(id, new_tags);
+            cache_.InvalidateBook(id);
+            CatalogChanged();
         } catch (const std::exception&) {
-            unit->Commit();
+            unit.Commit();
             throw std::logic_error("Failed EditBookTagsById");
         }
     }
 
+    std::vector<std::pair<std::string, std::size_t>> UseCasesImpl::TagStats(std::size_t top_k) {
+        if (top_k == 0) {
+            return {};
+        }
+        auto unit = BeginUnit(READ_ONLY);
+        try{
+            auto top_tags = unit->BookTags()->ReadTopTags(top_k);
+            unit.Commit();
+            return top_tags;
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed TagStats");
+        }
+    }
+
+    std::vector<std::pair<int, std::size_t>> UseCasesImpl::BooksPerYear(int from, int to) {
+        return GetBookColumns()->CountByYear(from, to);
+    }
+
+    std::vector<std::pair<std::string, std::size_t>> UseCasesImpl::BooksPerAuthor() {
+        auto columns = GetBookColumns();
+        auto counts = columns->CountByAuthor();
+        std::vector<std::pair<std::string, std::size_t>> books_per_author;
+        books_per_author.reserve(counts.size());
+        for (std::uint32_t author = 0; author < counts.size(); ++author) {
+            books_per_author.emplace_back(columns->GetAuthorName(author), counts[author]);
+        }
+        std::sort(books_per_author.begin(), books_per_author.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+        });
+        return books_per_author;
+    }
+
+    std::vector<std::pair<int, std::size_t>> UseCasesImpl::YearHistogram(int bucket_years) {
+        if (bucket_years <= 0) {
+            throw std::logic_error("Failed YearHistogram");
+        }
+        return GetBookColumns()->CountByYearBucket(bucket_years);
+    }
+
+    std::vector<AuthorYears> UseCasesImpl::AuthorYearSpan() {
+        auto columns = GetBookColumns();
+        auto spans = columns->YearSpanByAuthor();
+        std::vector<AuthorYears> author_years;
+        author_years.reserve(spans.size());
+        for (std::uint32_t author = 0; author < spans.size(); ++author) {
+            author_years.push_back({columns->GetAuthorName(author), spans[author].first, spans[author].second});
+        }
+        std::sort(author_years.begin(), author_years.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.author_name < rhs.author_name;
+        });
+        return author_years;
+    }
+
+    void UseCasesImpl::WriteSnapshot(const std::string &path) {
+        if (!snapshot_writer_) {
+            throw std::logic_error("Snapshot writer is not available");
+        }
+        try{
+            auto loaded = LoadCatalog();
+            snapshot_writer_->Write(path, loaded.authors, loaded.books, loaded.book_tags);
+        } catch (const std::exception&) {
+            throw std::logic_error("Failed WriteSnapshot");
+        }
+    }
+
+    ImportStats UseCasesImpl::ImportCatalog(const std::string &path, ImportFormat format,
+                                            const ImportProgress &progress) {
+        if (!importer_) {
+            throw std::logic_error("Catalog importer is not available");
+        }
+        std::ifstream input{path, std::ios::binary};
+        if (!input) {
+            throw std::logic_error("Failed ImportCatalog");
+        }
+        ImportReader reader{input, format};
+        ImportStats stats;
+        std::vector<ImportRecord> batch;
+        // Повторы внутри пачки сливаются в одну запись: импортёр рассчитывает на различные записи
+        std::map<std::tuple<std::string, std::string, int>, std::size_t> positions;
+        auto flush = [&] {
+            if (batch.empty()) {
+                return;
+            }
+            auto added = importer_->ImportBatch(batch, import_durability_);
+            batch.clear();
+            positions.clear();
+            stats.authors += added.authors;
+            stats.books += added.books;
+            stats.book_tags += added.book_tags;
+            ResetCatalogState();
+            CatalogChanged();
+            if (progress) {
+                progress(stats);
+            }
+        };
+        try{
+            while (auto record = reader.Next()) {
+                ++stats.records;
+                auto [it, inserted] = positions.emplace(std::tie(record->author_name, record->title, record->year),
+                                                        batch.size());
+                if (inserted) {
+                    batch.push_back(std::move(*record));
+                } else {
+                    auto& tags = batch[it->second].tags;
+                    std::vector<std::string> merged;
+                    std::set_union(tags.begin(), tags.end(), record->tags.begin(), record->tags.end(),
+                                   std::back_inserter(merged));
+                    tags = std::move(merged);
+                }
+                if (batch.size() >= import_batch_size_) {
+                    flush();
+                }
+            }
+            flush();
+            return stats;
+        } catch (const std::invalid_argument&) {
+            throw;
+        } catch (const std::exception&) {
+            throw std::logic_error("Failed ImportCatalog");
+        }
+    }
+
+    std::size_t UseCasesImpl::ExportCatalog(std::ostream &output, ImportFormat format) {
+        if (!exporter_) {
+            throw std::logic_error("Catalog exporter is not available");
+        }
+        try{
+            ExportWriter writer{output, format};
+            exporter_->Export(writer);
+            output.flush();
+            if (!output) {
+                throw std::runtime_error("Export output failed");
+            }
+            return writer.GetCount();
+        } catch (const std::exception&) {
+            throw std::logic_error("Failed ExportCatalog");
+        }
+    }
+
+    std::size_t UseCasesImpl::SubscribeChanges(ChangeHandler handler) {
+        if (!change_feed_) {
+            throw std::logic_error("Change feed is not available");
+        }
+        return change_feed_->Subscribe(std::move(handler));
+    }
+
+    void UseCasesImpl::UnsubscribeChanges(std::size_t subscription) {
+        if (change_feed_) {
+            change_feed_->Unsubscribe(subscription);
+        }
+    }
+
+    // Вызывается из потока ChangeFeed и состояния сессий не касается. Свои изменения уже сброшены
+    // use case'ами записи.
+    void UseCasesImpl::OnChange(const ChangeEvent &event) {
+        if (event.local) {
+            return;
+        }
+        switch (event.entity) {
+            case EntityType::kAuthor:
+                cache_.InvalidateAuthor(event.id);
+                ApplyNameChange(event, author_names_, author_completer_);
+                break;
+            case EntityType::kBook:
+                cache_.InvalidateBook(event.id);
+                ApplyNameChange(event, book_titles_, title_completer_);
+                tag_index_.MarkStale();
+                break;
+            case EntityType::kBookTags:
+                cache_.InvalidateBook(event.id);
+                tag_index_.MarkStale();
+                break;
+            case EntityType::kCatalog:
+                ResetCatalogState();
+                break;
+        }
+        DropCatalogSnapshots();
+    }
+
+    // Изменение, сделанное use case'ом этого потока; в сессии оно запоминается до её закрытия
+    void UseCasesImpl::CatalogChanged() {
+        {
+            std::lock_guard lock{session_mutex_};
+            if (session_unit_ && session_thread_ == std::this_thread::get_id()) {
+                session_changed_ = true;
+            }
+        }
+        DropCatalogSnapshots();
+    }
+
+    void UseCasesImpl::DropCatalogSnapshots() {
+        if (shared_catalog_) {
+            shared_catalog_->Invalidate();
+        }
+        std::lock_guard lock{columns_mutex_};
+        columns_.reset();
+        ++columns_generation_;
+    }
+
+    // Изменения, которые нельзя отразить точечно: все производные структуры перестраиваются
+    void UseCasesImpl::ResetCatalogState() {
+        cache_.Clear();
+        author_names_.MarkStale();
+        book_titles_.MarkStale();
+        tag_index_.MarkStale();
+        author_completer_.MarkStale();
+        title_completer_.MarkStale();
+    }
+
+    bool UseCasesImpl::AuthorMayExist(const std::string &name) {
+        RebuildNameFiltersIfNeeded();
+        return author_names_.MayContain(name);
+    }
+
+    bool UseCasesImpl::BookTitleMayExist(const std::string &title) {
+        RebuildNameFiltersIfNeeded();
+        return book_titles_.MayContain(title);
+    }
+
+    // Ошибка построения не мешает use case'у: непостроенный фильтр отвечает "возможно есть"
+    void UseCasesImpl::RebuildNameFiltersIfNeeded() {
+        bool rebuild_authors = author_names_.NeedsRebuild();
+        bool rebuild_titles = book_titles_.NeedsRebuild();
+        if (!rebuild_authors && !rebuild_titles) {
+            return;
+        }
+        auto authors_generation = author_names_.GetGeneration();
+        auto titles_generation = book_titles_.GetGeneration();
+        std::vector<std::string> names;
+        std::vector<std::string> titles;
+        auto unit = BeginUnit(FILL_READ);
+        try{
+            if (rebuild_authors) {
+                for (auto& [id, name] : unit->Author()->Read()) {
+                    names.push_back(std::move(name));
+                }
+            }
+            if (rebuild_titles) {
+                for (auto& book : unit->Book()->Read()) {
+                    titles.push_back(std::move(book.title));
+                }
+            }
+            unit.Commit();
+        } catch (const std::exception&) {
+            unit.Commit();
+            return;
+        }
+        if (rebuild_authors) {
+            author_names_.Rebuild(authors_generation, names);
+        }
+        if (rebuild_titles) {
+            book_titles_.Rebuild(titles_generation, titles);
+        }
+    }
+
+    // Снимок строится из списка книг ReadBookList (кэш, общий снимок или БД) и сбрасывается CatalogChanged.
+    // Снимок, построенный по данным, изменившимся во время построения, используется только этим запросом.
+    std::shared_ptr<const BookColumns> UseCasesImpl::GetBookColumns() {
+        std::uint64_t generation;
+        {
+            std::lock_guard lock{columns_mutex_};
+            if (columns_) {
+                return columns_;
+            }
+            generation = columns_generation_;
+        }
+        std::shared_ptr<const BookColumns> columns;
+        try {
+            columns = std::make_shared<const BookColumns>(ReadBookList());
+        } catch (const std::exception&) {
+            throw std::logic_error("Failed to build analytics snapshot");
+        }
+        if (keep_analytics_snapshot_) {
+            std::lock_guard lock{columns_mutex_};
+            if (columns_generation_ == generation) {
+                columns_ = columns;
+            }
+        }
+        return columns;
+    }
+
+    // Непостроенный индекс строится из книг и их тегов, прочитанных одной транзакцией.
+    // Если за время загрузки индекс изменился, запрос выполняется по временному индексу.
+    std::vector<std::string> UseCasesImpl::FindBookIdsByTags(const std::vector<std::string> &all_of,
+                                                             const std::vector<std::string> &any_of,
+                                                             const std::vector<std::string> &none_of) {
+        if (auto found = tag_index_.Find(all_of, any_of, none_of)) {
+            return std::move(*found);
+        }
+        auto generation = tag_index_.GetGeneration();
+        std::vector<std::string> book_ids;
+        TagIndex::BookTagPairs book_tags;
+        auto unit = BeginUnit(FILL_READ);
+        try{
+            for (auto& book : unit->Book()->Read()) {
+                book_ids.push_back(std::move(book.id));
+            }
+            book_tags = unit->BookTags()->Read();
+            unit.Commit();
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed FindBooksByTags");
+        }
+        if (tag_index_.Rebuild(generation, book_ids, book_tags)) {
+            if (auto found = tag_index_.Find(all_of, any_of, none_of)) {
+                return std::move(*found);
+            }
+        }
+        TagIndex snapshot;
+        snapshot.Rebuild(snapshot.GetGeneration(), book_ids, book_tags);
+        return std::move(*snapshot.Find(all_of, any_of, none_of));
+    }
+
+    std::optional<CachedBook> UseCasesImpl::ReadSharedBook(const std::string &book_id) {
+        if (!shared_catalog_) {
+            return std::nullopt;
+        }
+        auto generation = cache_.GetGeneration();
+        auto shared = shared_catalog_->ReadBook(book_id);
+        if (!shared) {
+            return std::nullopt;
+        }
+        CachedBook book{std::move(shared->first), std::move(shared->second)};
+        cache_.PutBook(generation, book);
+        return book;
+    }
+
+    std::vector<CachedBook> UseCasesImpl::ReadBooksById(const std::vector<std::string> &book_ids) {
+        std::vector<CachedBook> books;
+        books.reserve(book_ids.size());
+        std::vector<std::string> missing;
+        for (const auto& book_id : book_ids) {
+            if (auto cached = cache_.FindBook(book_id)) {
+                books.push_back(std::move(*cached));
+            } else if (auto shared = ReadSharedBook(book_id)) {
+                books.push_back(std::move(*shared));
+            } else {
+                missing.push_back(book_id);
+            }
+        }
+        if (missing.empty()) {
+            return books;
+        }
+        auto generation = cache_.GetGeneration();
+        auto read_from = books.size();
+        auto unit = BeginUnit(FILL_READ);
+        try{
+            for (const auto& book_id : missing) {
+                CachedBook book{unit->Book()->ReadById(book_id), {}};
+                if (!book.data.id.empty()) {
+                    book.tags = unit->BookTags()->ReadById(book_id);
+                    books.push_back(std::move(book));
+                }
+            }
+            unit.Commit();
+            for (auto i = read_from; i < books.size(); ++i) {
+                cache_.PutBook(generation, books[i]);
+            }
+            return books;
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw std::logic_error("Failed to read books");
+        }
+    }
+
+    // Загружает весь каталог одной транзакцией и публикует его в общий снимок.
+    // Вызывается из списочных use case'ов, которым и так нужна значительная часть каталога.
+    // Авторы, книги и теги читаются одной транзакцией, поэтому согласованы между собой
+    UseCasesImpl::LoadedCatalog UseCasesImpl::LoadCatalog() {
+        auto unit = BeginUnit(FILL_READ);
+        LoadedCatalog loaded;
+        try{
+            loaded.authors = unit->Author()->Read();
+            loaded.books = unit->Book()->Read();
+            loaded.book_tags = unit->BookTags()->Read();
+            unit.Commit();
+            return loaded;
+        } catch (const std::exception&) {
+            unit.Commit();
+            throw;
+        }
+    }
+
+    std::optional<UseCasesImpl::LoadedCatalog> UseCasesImpl::RefreshSharedCatalog() {
+        auto generation = shared_catalog_->GetGeneration();
+        auto cache_generation = cache_.GetGeneration();
+        LoadedCatalog loaded;
+        try{
+            loaded = LoadCatalog();
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+        // Незафиксированные изменения сессии не должны попасть к другим процессам
+        if (!SessionHasChanges()) {
+            shared_catalog_->Publish(generation, loaded.authors, loaded.books, loaded.book_tags);
+        }
+        cache_.PutAuthors(cache_generation, loaded.authors);
+        cache_.PutBooks(cache_generation, loaded.books);
+        return loaded;
+    }
+
 }  // namespace app
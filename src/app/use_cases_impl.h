@@ -1,18 +1,55 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include "../domain/author_fwd.h"
+#include "book_columns.h"
+#include "catalog_exporter.h"
+#include "entity_cache.h"
+#include "name_completer.h"
+#include "name_filter.h"
+#include "shared_catalog.h"
+#include "snapshot_writer.h"
+#include "tag_index.h"
 #include "use_cases.h"
 #include "unit_of_work.h"
 
 namespace app {
 
+    struct UseCasesConfig {
+        std::size_t cache_capacity_bytes = 16 * 1024 * 1024;   // 0 - без кэша
+        double name_filter_false_positive_rate = 0.01;
+        std::size_t name_filter_max_bytes = 4 * 1024 * 1024;    // на каждый фильтр, 0 - без фильтров
+        double similarity_threshold = 0.3;                       // нечёткий поиск по триграммам, 0..1
+        bool keep_analytics_snapshot = true;                     // хранить колоночный снимок между запросами
+        std::size_t import_batch_size = 50000;                   // записей в одной транзакции импорта
+        // Долговечность массовых правок: теги книг (AddBookTags, EditBookTagsById, DeleteBookTagsById)
+        // и пачки импорта. Авторы и книги всегда фиксируются с kStrict
+        Durability tags_durability = Durability::kStrict;
+        Durability import_durability = Durability::kStrict;
+    };
+
     class UseCasesImpl : public UseCases {
     public:
-        explicit UseCasesImpl(UnitOfWorkFactory& factory)
-                : unit_of_work_factory_(factory){
-        }
+        explicit UseCasesImpl(UnitOfWorkFactory& factory, const UseCasesConfig& config = {},
+                              ChangeFeed* change_feed = nullptr, SharedCatalog* shared_catalog = nullptr,
+                              SnapshotWriter* snapshot_writer = nullptr, CatalogImporter* importer = nullptr,
+                              CatalogExporter* exporter = nullptr);
+        ~UseCasesImpl();
+
+        std::unique_ptr<Session> OpenSession(bool read_only) override;
 
         std::string AddAuthor(const std::string& name) override;
         std::vector<std::pair<std::string, std::string>> ShowAuthors() override;
+        std::optional<std::string> ShowAuthorById(const std::string& author_id) override;
+        std::vector<std::pair<std::string, std::string>> FindSimilarAuthors(const std::string& name, std::size_t limit) override;
         void DeleteAuthorByName(const std::string& name) override;
         void DeleteAuthorById(const std::string& id) override;
         void EditAuthorByName(const std::string& old_name, const std::string& new_name) override;
@@ -20,28 +57,138 @@ namespace app {
 
         std::string AddBook(const std::string& author_id, const std::string& title, int year ) override;
         void AddBookTags(const std::string& book_id, const std::vector<std::string>& tags) override;
+        std::string AddBookWithTags(const AuthorRef& author, const std::string& title, int year,
+                                    const std::vector<std::string>& tags) override;
         std::vector<BookData> ShowBooks() override;
         std::vector<BookData> ShowBooksByTitle(const std::string& title) override;
         ShowBookData ShowBookById(const std::string& book_id)  override;
         std::vector<BookData> ShowAuthorBooks(const std::string& author_id) override;
+        std::vector<BookData> FindSimilarBooks(const std::string& title, std::size_t limit) override;
+        std::vector<BookData> FindBooksByTags(const std::vector<std::string>& all_of,
+                                              const std::vector<std::string>& any_of,
+                                              const std::vector<std::string>& none_of) override;
+        BooksPage ShowBooksByYearRange(int from, int to, std::size_t page, std::size_t page_size) override;
+        Completions Autocomplete(const std::string& prefix, std::size_t limit) override;
+        CatalogCounts CountCatalog() override;
+        std::vector<BookData> SearchBooks(const std::string& query, std::size_t limit, std::size_t offset = 0) override;
         void DeleteBookByName(const std::string& name) override;
         void DeleteBookById(const std::string& id) override;
 
         void EditBookTitleById(const std::string& id, const std::string& new_name) override;
         void EditBookYearById(const std::string& id, int new_year) override;
+        void PatchBook(const std::string& id, const std::optional<std::string>& new_title,
+                       const std::optional<int>& new_year,
+                       const std::optional<std::vector<std::string>>& new_tags) override;
 
         std::vector<std::string> GetBookTagsById(const std::string& book_id) override;
         void DeleteBookTagsById(const std::string& book_id) override;
         void EditBookTagsById(const std::string& id, const std::vector<std::string>& new_tags) override;
+        std::vector<std::pair<std::string, std::size_t>> TagStats(std::size_t top_k) override;
+
+        std::vector<std::pair<int, std::size_t>> BooksPerYear(int from, int to) override;
+        std::vector<std::pair<std::string, std::size_t>> BooksPerAuthor() override;
+        std::vector<std::pair<int, std::size_t>> YearHistogram(int bucket_years) override;
+        std::vector<AuthorYears> AuthorYearSpan() override;
+
+        void WriteSnapshot(const std::string& path) override;
+        ImportStats ImportCatalog(const std::string& path, ImportFormat format,
+                                  const ImportProgress& progress = {}) override;
+        std::size_t ExportCatalog(std::ostream& output, ImportFormat format) override;
+
+        std::size_t SubscribeChanges(ChangeHandler handler) override;
+        void UnsubscribeChanges(std::size_t subscription) override;
 
         //void Commit() override;
     private:
+        class SessionImpl;
+
+        // Unit of work одного use case'а: транзакция открытой сессии или собственная.
+        // В сессии Commit ничего не делает - фиксирует сессия целиком. Поэтому use case'ы вызывают
+        // unit.Commit(), а не unit->Commit()
+        class ScopedUnit {
+        public:
+            explicit ScopedUnit(UnitOfWork& session_unit)
+                : unit_{&session_unit} {
+            }
+            explicit ScopedUnit(std::unique_ptr<UnitOfWork> unit)
+                : owned_{std::move(unit)}, unit_{owned_.get()} {
+            }
+
+            UnitOfWork* operator->() const noexcept {
+                return unit_;
+            }
+            void Commit() {
+                if (owned_) {
+                    owned_->Commit();
+                }
+            }
+
+        private:
+            std::unique_ptr<UnitOfWork> owned_;
+            UnitOfWork* unit_;
+        };
+
+        struct LoadedCatalog {
+            std::vector<std::pair<std::string, std::string>> authors;
+            std::vector<domain::BookData> books;
+            std::vector<std::pair<std::string, std::string>> book_tags;
+        };
+
+        ScopedUnit BeginUnit(const UnitOfWorkOptions& options = {});
+        bool SessionHasChanges();
+        void CloseSession(bool committed);
+        void OnChange(const ChangeEvent& event);
+        void CatalogChanged();
+        // Сбрасывает общий снимок каталога и колоночный снимок аналитики
+        void DropCatalogSnapshots();
+        void ResetCatalogState();
+        bool AuthorMayExist(const std::string& name);
+        bool BookTitleMayExist(const std::string& title);
+        void RebuildNameFiltersIfNeeded();
+        std::optional<CachedBook> ReadSharedBook(const std::string& book_id);
+        // Книги по id через кэш; отсутствующие в кэше читаются одной транзакцией. Удалённых книг нет в результате
+        std::vector<CachedBook> ReadBooksById(const std::vector<std::string>& book_ids);
+        LoadedCatalog LoadCatalog();
+        std::optional<LoadedCatalog> RefreshSharedCatalog();
+        std::vector<domain::BookData> ReadBookList();
+        NameCompleter::Entries ReadTitleEntries();
+        std::shared_ptr<const BookColumns> GetBookColumns();
+        std::vector<std::string> FindBookIdsByTags(const std::vector<std::string>& all_of,
+                                                   const std::vector<std::string>& any_of,
+                                                   const std::vector<std::string>& none_of);
 
         /*domain::AuthorRepository& authors_;
         domain::BookRepository& books_;
         domain::BookTagsRepository& book_tags_;*/
 
         UnitOfWorkFactory& unit_of_work_factory_;   //TODO: add impl_
+        // Открытая сессия: её unit of work и поток, в котором она открыта. Под session_mutex_:
+        // use case'ы любого потока проверяют, не их ли это сессия
+        std::mutex session_mutex_;
+        UnitOfWork* session_unit_ = nullptr;
+        std::thread::id session_thread_;
+        bool session_read_only_ = false;
+        bool session_changed_ = false;
+        EntityCache cache_;
+        NameFilter author_names_;
+        NameFilter book_titles_;
+        TagIndex tag_index_;
+        NameCompleter author_completer_;
+        NameCompleter title_completer_;
+        ChangeFeed* change_feed_;
+        std::size_t change_subscription_ = 0;
+        SharedCatalog* shared_catalog_;
+        SnapshotWriter* snapshot_writer_;
+        CatalogImporter* importer_;
+        CatalogExporter* exporter_;
+        std::size_t import_batch_size_;
+        UnitOfWorkOptions tag_writes_;
+        Durability import_durability_;
+        double similarity_threshold_;
+        bool keep_analytics_snapshot_;
+        std::mutex columns_mutex_;
+        std::shared_ptr<const BookColumns> columns_;
+        std::uint64_t columns_generation_ = 0;
     };
 
 }  // namespace app
@@ -0,0 +1,740 @@
+#include "write_journal.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "../domain/author.h"
+#include "../domain/book.h"
+
+namespace app {
+
+    namespace {
+
+        constexpr const char AUTHOR_SAVE[]{"author.save"};
+        constexpr const char AUTHOR_DELETE_BY_NAME[]{"author.delete_by_name"};
+        constexpr const char AUTHOR_DELETE_BY_ID[]{"author.delete_by_id"};
+        constexpr const char AUTHOR_EDIT_BY_NAME[]{"author.edit_by_name"};
+        constexpr const char AUTHOR_EDIT_BY_ID[]{"author.edit_by_id"};
+        constexpr const char BOOK_SAVE[]{"book.save"};
+        constexpr const char BOOK_DELETE_BY_NAME[]{"book.delete_by_name"};
+        constexpr const char BOOK_DELETE_BY_ID[]{"book.delete_by_id"};
+        constexpr const char BOOK_EDIT_TITLE[]{"book.edit_title"};
+        constexpr const char BOOK_EDIT_YEAR[]{"book.edit_year"};
+        constexpr const char BOOK_PATCH[]{"book.patch"};
+        constexpr const char TAGS_SAVE[]{"tags.save"};
+        constexpr const char TAGS_UPDATE[]{"tags.update"};
+        constexpr const char TAGS_DELETE[]{"tags.delete"};
+
+        // Необязательный аргумент: "+значение" либо "-"
+        std::string EncodeOptional(const std::optional<std::string>& value) {
+            return value ? "+" + *value : "-";
+        }
+
+        std::optional<std::string> DecodeOptional(const std::string& value) {
+            if (value.empty() || value.front() != '+') {
+                return std::nullopt;
+            }
+            return value.substr(1);
+        }
+
+        std::vector<std::string> TagArgs(const domain::BookTags& book_tags) {
+            std::vector<std::string> args{book_tags.GetBookId()};
+            args.insert(args.end(), book_tags.GetTags().begin(), book_tags.GetTags().end());
+            return args;
+        }
+
+        domain::BookTags TagsFromArgs(const std::vector<std::string>& args) {
+            return {args.at(0), {std::next(args.begin()), args.end()}};
+        }
+
+        void ApplyOperation(const JournalOperation& op, UnitOfWork& unit) {
+            const auto& args = op.args;
+            if (op.name == AUTHOR_SAVE) {
+                unit.Author()->Save({domain::AuthorId::FromString(args.at(0)), args.at(1)});
+            } else if (op.name == AUTHOR_DELETE_BY_NAME) {
+                unit.Author()->DeleteByName(args.at(0));
+            } else if (op.name == AUTHOR_DELETE_BY_ID) {
+                unit.Author()->DeleteById(args.at(0));
+            } else if (op.name == AUTHOR_EDIT_BY_NAME) {
+                unit.Author()->EditByName(args.at(0), args.at(1));
+            } else if (op.name == AUTHOR_EDIT_BY_ID) {
+                unit.Author()->EditById(args.at(0), args.at(1));
+            } else if (op.name == BOOK_SAVE) {
+                unit.Book()->Save({domain::BookId::FromString(args.at(0)), args.at(1), args.at(2), std::stoi(args.at(3))});
+            } else if (op.name == BOOK_DELETE_BY_NAME) {
+                unit.Book()->DeleteByName(args.at(0));
+            } else if (op.name == BOOK_DELETE_BY_ID) {
+                unit.Book()->DeleteById(args.at(0));
+            } else if (op.name == BOOK_EDIT_TITLE) {
+                unit.Book()->EditTitleById(args.at(0), args.at(1));
+            } else if (op.name == BOOK_EDIT_YEAR) {
+                unit.Book()->EditYearById(args.at(0), std::stoi(args.at(1)));
+            } else if (op.name == BOOK_PATCH) {
+                auto year = DecodeOptional(args.at(2));
+                unit.Book()->Patch(args.at(0), DecodeOptional(args.at(1)),
+                                   year ? std::optional<int>{std::stoi(*year)} : std::nullopt);
+            } else if (op.name == TAGS_SAVE) {
+                unit.BookTags()->Save(TagsFromArgs(args));
+            } else if (op.name == TAGS_UPDATE) {
+                unit.BookTags()->Update(TagsFromArgs(args));
+            } else if (op.name == TAGS_DELETE) {
+                unit.BookTags()->DeleteById(args.at(0));
+            } else {
+                throw std::logic_error("Unknown journal operation " + op.name);
+            }
+        }
+
+        //===============Формат файла=====
+        // Unit of work: "U<номер> <число операций>\n", затем по строке на операцию:
+        // "<число полей>" и поля " <длина>:<байты>", первое поле - имя операции.
+        // Отметка о применении: "C<номер>\n". Недописанная запись в конце файла отбрасывается
+
+        void AppendField(std::string& out, std::string_view field) {
+            out += ' ';
+            out += std::to_string(field.size());
+            out += ':';
+            out += field;
+        }
+
+        void EncodeUnit(std::string& out, std::uint64_t seq, const std::vector<JournalOperation>& operations) {
+            out += 'U' + std::to_string(seq) + ' ' + std::to_string(operations.size()) + '\n';
+            for (const auto& op : operations) {
+                out += std::to_string(op.args.size() + 1);
+                AppendField(out, op.name);
+                for (const auto& arg : op.args) {
+                    AppendField(out, arg);
+                }
+                out += '\n';
+            }
+        }
+
+        class JournalParser {
+        public:
+            explicit JournalParser(std::string_view data)
+                : data_{data} {
+            }
+
+            struct Unit {
+                std::uint64_t seq = 0;
+                std::vector<JournalOperation> operations;
+            };
+
+            std::vector<Unit> units;
+            std::uint64_t checkpoint = 0;
+            std::size_t valid_size = 0;
+
+            void Parse() {
+                while (pos_ < data_.size() && ParseRecord()) {
+                    valid_size = pos_;
+                }
+            }
+
+        private:
+            bool ParseRecord() {
+                auto kind = data_[pos_++];
+                if (kind == 'C') {
+                    auto seq = ReadNumber('\n');
+                    if (!seq) {
+                        return false;
+                    }
+                    checkpoint = std::max(checkpoint, *seq);
+                    return true;
+                }
+                if (kind != 'U') {
+                    return false;
+                }
+                Unit unit;
+                auto seq = ReadNumber(' ');
+                auto count = seq ? ReadNumber('\n') : std::nullopt;
+                if (!count) {
+                    return false;
+                }
+                unit.seq = *seq;
+                for (std::uint64_t i = 0; i < *count; ++i) {
+                    auto op = ParseOperation();
+                    if (!op) {
+                        return false;
+                    }
+                    unit.operations.push_back(std::move(*op));
+                }
+                units.push_back(std::move(unit));
+                return true;
+            }
+
+            std::optional<JournalOperation> ParseOperation() {
+                auto fields = ReadNumber(' ');
+                if (!fields || *fields == 0) {
+                    return std::nullopt;
+                }
+                JournalOperation op;
+                for (std::uint64_t i = 0; i < *fields; ++i) {
+                    if (i > 0 && !Skip(' ')) {
+                        return std::nullopt;
+                    }
+                    auto size = ReadNumber(':');
+                    if (!size || data_.size() - pos_ < *size) {
+                        return std::nullopt;
+                    }
+                    std::string field{data_.substr(pos_, *size)};
+                    pos_ += *size;
+                    if (i == 0) {
+                        op.name = std::move(field);
+                    } else {
+                        op.args.push_back(std::move(field));
+                    }
+                }
+                if (!Skip('\n')) {
+                    return std::nullopt;
+                }
+                return op;
+            }
+
+            std::optional<std::uint64_t> ReadNumber(char terminator) {
+                std::uint64_t value = 0;
+                auto start = pos_;
+                while (pos_ < data_.size() && data_[pos_] >= '0' && data_[pos_] <= '9') {
+                    value = value * 10 + (data_[pos_++] - '0');
+                }
+                if (pos_ == start || !Skip(terminator)) {
+                    return std::nullopt;
+                }
+                return value;
+            }
+
+            bool Skip(char c) {
+                if (pos_ >= data_.size() || data_[pos_] != c) {
+                    return false;
+                }
+                ++pos_;
+                return true;
+            }
+
+            std::string_view data_;
+            std::size_t pos_ = 0;
+        };
+
+        bool WriteAll(int fd, std::string_view data) {
+            while (!data.empty()) {
+                auto written = ::write(fd, data.data(), data.size());
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                data.remove_prefix(static_cast<std::size_t>(written));
+            }
+            return true;
+        }
+
+        // Ссылка пишущего unit of work на его журнал
+        class Recorder {
+        public:
+            // Запоминает операцию до Commit или сразу выполняет её, если unit of work уже читал
+            virtual void Record(JournalOperation op) = 0;
+            // Unit of work хранилища, видящий всё зафиксированное раньше и свои операции
+            virtual UnitOfWork& Direct() = 0;
+
+        protected:
+            ~Recorder() = default;
+        };
+
+        class AuthorRecorder : public domain::AuthorRepository {
+        public:
+            explicit AuthorRecorder(Recorder& recorder)
+                : recorder_{recorder} {
+            }
+
+            void Save(const domain::Author& author) override {
+                recorder_.Record({AUTHOR_SAVE, {author.GetId().ToString(), author.GetName()}});
+            }
+            std::vector<std::pair<std::string, std::string>> Read() override {
+                return recorder_.Direct().Author()->Read();
+            }
+            std::optional<std::string> ReadNameById(const std::string& id) override {
+                return recorder_.Direct().Author()->ReadNameById(id);
+            }
+            std::optional<std::string> ReadIdByName(const std::string& name) override {
+                return recorder_.Direct().Author()->ReadIdByName(name);
+            }
+            std::vector<std::pair<std::string, std::string>> FindSimilar(const std::string& name, double threshold,
+                                                                         std::size_t limit) override {
+                return recorder_.Direct().Author()->FindSimilar(name, threshold, limit);
+            }
+            void DeleteByName(const std::string& name) override {
+                recorder_.Record({AUTHOR_DELETE_BY_NAME, {name}});
+            }
+            void DeleteById(const std::string& id) override {
+                recorder_.Record({AUTHOR_DELETE_BY_ID, {id}});
+            }
+            void EditByName(const std::string& old_name, const std::string& new_name) override {
+                recorder_.Record({AUTHOR_EDIT_BY_NAME, {old_name, new_name}});
+            }
+            void EditById(const std::string& id, const std::string& new_name) override {
+                recorder_.Record({AUTHOR_EDIT_BY_ID, {id, new_name}});
+            }
+
+        private:
+            Recorder& recorder_;
+        };
+
+        class BookRecorder : public domain::BookRepository {
+        public:
+            explicit BookRecorder(Recorder& recorder)
+                : recorder_{recorder} {
+            }
+
+            void Save(const domain::Book& book) override {
+                recorder_.Record({BOOK_SAVE, {book.GetId().ToString(), book.GetAuthorId(), book.GetTitle(),
+                                              std::to_string(book.GetYear())}});
+            }
+            std::vector<domain::BookData> Read() override {
+                return recorder_.Direct().Book()->Read();
+            }
+            std::vector<domain::BookData> ReadByName(const std::string& book_name) override {
+                return recorder_.Direct().Book()->ReadByName(book_name);
+            }
+            domain::BookData ReadById(const std::string& book_id) override {
+                return recorder_.Direct().Book()->ReadById(book_id);
+            }
+            std::vector<domain::BookData> ReadAuthorBooks(const std::string& author_id) override {
+                return recorder_.Direct().Book()->ReadAuthorBooks(author_id);
+            }
+            std::vector<domain::RankedBook> Search(const std::string& query, std::size_t limit,
+                                                   std::size_t offset) override {
+                return recorder_.Direct().Book()->Search(query, limit, offset);
+            }
+            std::vector<domain::BookData> ReadByYearRange(int from, int to, std::size_t limit,
+                                                          std::size_t offset) override {
+                return recorder_.Direct().Book()->ReadByYearRange(from, to, limit, offset);
+            }
+            std::vector<domain::BookData> FindSimilar(const std::string& title, double threshold,
+                                                      std::size_t limit) override {
+                return recorder_.Direct().Book()->FindSimilar(title, threshold, limit);
+            }
+            void DeleteByName(const std::string& book_name) override {
+                recorder_.Record({BOOK_DELETE_BY_NAME, {book_name}});
+            }
+            void DeleteById(const std::string& book_id) override {
+                recorder_.Record({BOOK_DELETE_BY_ID, {book_id}});
+            }
+            void EditTitleById(const std::string& id, const std::string& new_name) override {
+                recorder_.Record({BOOK_EDIT_TITLE, {id, new_name}});
+            }
+            void EditYearById(const std::string& id, int new_year) override {
+                recorder_.Record({BOOK_EDIT_YEAR, {id, std::to_string(new_year)}});
+            }
+            void Patch(const std::string& id, const std::optional<std::string>& new_title,
+                       const std::optional<int>& new_year) override {
+                auto year = new_year ? std::optional<std::string>{std::to_string(*new_year)} : std::nullopt;
+                recorder_.Record({BOOK_PATCH, {id, EncodeOptional(new_title), EncodeOptional(year)}});
+            }
+
+        private:
+            Recorder& recorder_;
+        };
+
+        class BookTagsRecorder : public domain::BookTagsRepository {
+        public:
+            explicit BookTagsRecorder(Recorder& recorder)
+                : recorder_{recorder} {
+            }
+
+            void Save(const domain::BookTags& book_tags) override {
+                recorder_.Record({TAGS_SAVE, TagArgs(book_tags)});
+            }
+            std::vector<std::pair<std::string, std::string>> Read() override {
+                return recorder_.Direct().BookTags()->Read();
+            }
+            std::vector<std::string> ReadById(const std::string& book_id) override {
+                return recorder_.Direct().BookTags()->ReadById(book_id);
+            }
+            void Update(const domain::BookTags& book_tags) override {
+                recorder_.Record({TAGS_UPDATE, TagArgs(book_tags)});
+            }
+            void DeleteById(const std::string& book_id) override {
+                recorder_.Record({TAGS_DELETE, {book_id}});
+            }
+            std::vector<std::pair<std::string, std::size_t>> ReadTopTags(std::size_t top_k) override {
+                return recorder_.Direct().BookTags()->ReadTopTags(top_k);
+            }
+
+        private:
+            Recorder& recorder_;
+        };
+
+    }  // namespace
+
+    //===============JournalUnitOfWork=====
+    class JournalUnitOfWorkFactory::JournalUnitOfWork : public UnitOfWork, private Recorder {
+    public:
+        JournalUnitOfWork(JournalUnitOfWorkFactory& factory, const UnitOfWorkOptions& options)
+            : factory_{factory}, options_{options}, authors_{*this}, books_{*this}, book_tags_{*this} {
+        }
+
+        domain::AuthorRepository* Author() override {
+            return &authors_;
+        }
+        domain::BookRepository* Book() override {
+            return &books_;
+        }
+        domain::BookTagsRepository* BookTags() override {
+            return &book_tags_;
+        }
+
+        void Commit() override {
+            if (direct_) {
+                direct_->Commit();
+                return;
+            }
+            auto operations = std::exchange(operations_, {});
+            if (!operations.empty()) {
+                factory_.Append(std::move(operations), options_.durability);
+            }
+        }
+
+    private:
+        void Record(JournalOperation op) override {
+            if (direct_) {
+                ApplyOperation(op, *direct_);
+            } else {
+                operations_.push_back(std::move(op));
+            }
+        }
+
+        // С первого чтения unit of work работает с хранилищем напрямую: записанные им операции
+        // выполняются там же, после всего, что журнал успел принять раньше
+        UnitOfWork& Direct() override {
+            if (!direct_) {
+                factory_.WaitApplied();
+                direct_ = factory_.direct_.CreateUnitOfWork(options_);
+                for (const auto& op : std::exchange(operations_, {})) {
+                    ApplyOperation(op, *direct_);
+                }
+            }
+            return *direct_;
+        }
+
+        JournalUnitOfWorkFactory& factory_;
+        UnitOfWorkOptions options_;
+        std::vector<JournalOperation> operations_;
+        std::unique_ptr<UnitOfWork> direct_;
+        AuthorRecorder authors_;
+        BookRecorder books_;
+        BookTagsRecorder book_tags_;
+    };
+
+    //===============JournalUnitOfWorkFactory=====
+    JournalUnitOfWorkFactory::JournalUnitOfWorkFactory(JournalTarget &target, UnitOfWorkFactory &direct,
+                                                       const WriteJournalConfig &config)
+            : target_{target}, direct_{direct}, config_{config} {
+        if (config_.max_batch_units == 0) {
+            config_.max_batch_units = 1;
+        }
+        fd_ = ::open(config_.path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("Failed to open write journal " + config_.path);
+        }
+        try {
+            Replay();
+        } catch (...) {
+            ::close(fd_);
+            throw;
+        }
+        writer_ = std::thread{[this] {
+            WriteLoop();
+        }};
+        applier_ = std::thread{[this] {
+            ApplyLoop();
+        }};
+    }
+
+    JournalUnitOfWorkFactory::~JournalUnitOfWorkFactory() {
+        stop_.store(true, std::memory_order_release);
+        pushes_.fetch_add(1, std::memory_order_release);
+        pushes_.notify_one();
+        writer_.join();
+        applier_.join();
+        // Последнюю отметку о применении писать уже некому. Если применение прервано остановкой,
+        // остаток применится при следующем запуске
+        auto applied = applied_.load();
+        if (applied == written_seq_) {
+            [[maybe_unused]] auto result = ::ftruncate(fd_, 0);
+        } else if (!broken_ && WriteAll(fd_, 'C' + std::to_string(applied) + '\n')) {
+            [[maybe_unused]] auto result = ::fdatasync(fd_);
+        }
+        ::close(fd_);
+    }
+
+    std::unique_ptr<UnitOfWork> JournalUnitOfWorkFactory::CreateUnitOfWork(const UnitOfWorkOptions &options) {
+        if (options.read_only) {
+            WaitApplied();
+            return direct_.CreateUnitOfWork(options);
+        }
+        return std::make_unique<JournalUnitOfWork>(*this, options);
+    }
+
+    std::size_t JournalUnitOfWorkFactory::Subscribe(ChangeHandler handler) {
+        std::lock_guard lock{handlers_mutex_};
+        handlers_.emplace(next_subscription_, std::move(handler));
+        return next_subscription_++;
+    }
+
+    void JournalUnitOfWorkFactory::Unsubscribe(std::size_t subscription) {
+        std::lock_guard lock{handlers_mutex_};
+        handlers_.erase(subscription);
+    }
+
+    // appended_ растёт до Push, поэтому unit of work, отданные этим потоком, получают номера не больше
+    // прочитанного значения: номер назначается в порядке очереди, а очередь упорядочена по Push
+    void JournalUnitOfWorkFactory::WaitApplied() {
+        auto target = appended_.load(std::memory_order_acquire);
+        auto applied = applied_.load(std::memory_order_acquire);
+        while (applied < target) {
+            applied_.wait(applied, std::memory_order_acquire);
+            applied = applied_.load(std::memory_order_acquire);
+        }
+    }
+
+    void JournalUnitOfWorkFactory::Append(std::vector<JournalOperation> operations, Durability durability) {
+        Entry entry{std::move(operations), std::nullopt, 0};
+        std::future<void> written;
+        if (durability == Durability::kStrict) {
+            written = entry.written.emplace().get_future();
+        }
+        appended_.fetch_add(1, std::memory_order_acq_rel);
+        Push(std::move(entry));
+        if (written.valid()) {
+            written.get();
+        }
+    }
+
+    void JournalUnitOfWorkFactory::Push(Entry entry) {
+        queue_.Push(std::move(entry));
+        pushes_.fetch_add(1, std::memory_order_release);
+        pushes_.notify_one();
+    }
+
+    void JournalUnitOfWorkFactory::Replay() {
+        std::string data;
+        {
+            std::ifstream input{config_.path, std::ios::binary};
+            data.assign(std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{});
+        }
+        JournalParser parser{data};
+        parser.Parse();
+        if (parser.valid_size != data.size() && ::ftruncate(fd_, static_cast<off_t>(parser.valid_size)) != 0) {
+            throw std::runtime_error("Failed to truncate write journal " + config_.path);
+        }
+        written_seq_ = parser.checkpoint;
+        for (auto& unit : parser.units) {
+            written_seq_ = std::max(written_seq_, unit.seq);
+            if (unit.seq > parser.checkpoint) {
+                to_apply_.push_back({unit.seq, std::move(unit.operations), false});
+            }
+        }
+        appended_ = written_seq_;
+        applied_ = parser.checkpoint;
+    }
+
+    // Номера unit of work назначаются здесь, в порядке очереди
+    void JournalUnitOfWorkFactory::WriteLoop() {
+        for (;;) {
+            auto seen = pushes_.load(std::memory_order_acquire);
+            std::string buffer;
+            std::vector<WrittenUnit> units;
+            std::vector<std::optional<std::promise<void>>> waiting;
+            bool truncate = false;
+            while (auto entry = queue_.Pop()) {
+                if (entry->checkpoint == 0) {
+                    units.push_back({++written_seq_, std::move(entry->operations), false});
+                    EncodeUnit(buffer, units.back().seq, units.back().operations);
+                    waiting.push_back(std::move(entry->written));
+                } else if (entry->checkpoint == written_seq_) {
+                    // Применено всё записанное - журнал можно начать заново. Отметка нужна,
+                    // если обрезать не удастся
+                    buffer = 'C' + std::to_string(entry->checkpoint) + '\n';
+                    truncate = true;
+                } else {
+                    buffer += 'C' + std::to_string(entry->checkpoint) + '\n';
+                }
+            }
+            if (units.empty() && buffer.empty() && !truncate) {
+                if (stop_.load(std::memory_order_acquire)) {
+                    break;
+                }
+                pushes_.wait(seen, std::memory_order_acquire);
+                continue;
+            }
+            bool ok = WriteBuffer(buffer, truncate, !units.empty());
+            // Без fsync ошибку получает только kStrict; kAsync согласился на потерю журнала и применяется
+            for (std::size_t i = 0; i < units.size(); ++i) {
+                if (!waiting[i]) {
+                    continue;
+                }
+                if (ok) {
+                    waiting[i]->set_value();
+                } else {
+                    units[i].lost = true;
+                    waiting[i]->set_exception(std::make_exception_ptr(
+                            std::runtime_error("Failed to write journal " + config_.path)));
+                }
+            }
+            if (!units.empty()) {
+                std::lock_guard lock{apply_mutex_};
+                std::move(units.begin(), units.end(), std::back_inserter(to_apply_));
+                apply_ready_.notify_one();
+            }
+        }
+        std::lock_guard lock{apply_mutex_};
+        writer_done_ = true;
+        apply_ready_.notify_one();
+    }
+
+    // Дописывает buffer в конец журнала, после обрезки до нуля при truncate. Replay отбрасывает всё
+    // после первой недописанной записи, поэтому при ошибке журнал обрезается до прежнего конца, а если
+    // не удалось и это - не принимает записи, пока не будет обрезан до нуля
+    bool JournalUnitOfWorkFactory::WriteBuffer(const std::string& buffer, bool truncate, bool sync) {
+        if (truncate && ::ftruncate(fd_, 0) == 0) {
+            broken_ = false;
+        }
+        if (broken_) {
+            return false;
+        }
+        auto offset = ::lseek(fd_, 0, SEEK_END);
+        if (offset < 0) {
+            return false;
+        }
+        if (WriteAll(fd_, buffer) && (!sync || ::fdatasync(fd_) == 0)) {
+            return true;
+        }
+        broken_ = ::ftruncate(fd_, offset) != 0;
+        return false;
+    }
+
+    void JournalUnitOfWorkFactory::ApplyLoop() {
+        for (;;) {
+            std::vector<WrittenUnit> batch;
+            {
+                std::unique_lock lock{apply_mutex_};
+                apply_ready_.wait(lock, [this] {
+                    return !to_apply_.empty() || writer_done_;
+                });
+                if (to_apply_.empty()) {
+                    break;
+                }
+                while (!to_apply_.empty() && batch.size() < config_.max_batch_units) {
+                    batch.push_back(std::move(to_apply_.front()));
+                    to_apply_.pop_front();
+                }
+            }
+            if (!ApplyBatch(batch)) {
+                break;
+            }
+        }
+    }
+
+    // Пачка применяется одной транзакцией; при постоянной ошибке - по одному unit of work, и ошибочные
+    // пропускаются. false - остановка во время повторов: неприменённое осталось в журнале
+    bool JournalUnitOfWorkFactory::ApplyBatch(const std::vector<WrittenUnit>& batch) {
+        std::vector<const WrittenUnit*> units;
+        for (const auto& unit : batch) {
+            if (!unit.lost) {
+                units.push_back(&unit);
+            }
+        }
+        auto result = units.empty() ? ApplyResult::kApplied : Apply(units, 0, units.size());
+        if (result == ApplyResult::kStopped) {
+            return false;
+        }
+        if (result == ApplyResult::kRejected) {
+            bool dropped = false;
+            for (std::size_t i = 0; i < units.size(); ++i) {
+                auto unit_result = units.size() == 1 ? ApplyResult::kRejected : Apply(units, i, i + 1);
+                if (unit_result == ApplyResult::kStopped) {
+                    if (dropped) {
+                        PublishReset();
+                    }
+                    MarkApplied(units[i]->seq - 1);
+                    return false;
+                }
+                if (unit_result == ApplyResult::kRejected) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    dropped = true;
+                }
+            }
+            // До отметки о применении: дождавшиеся её читатели не должны увидеть устаревший кэш
+            if (dropped) {
+                PublishReset();
+            }
+        }
+        MarkApplied(batch.back().seq);
+        return true;
+    }
+
+    // Применяет units[begin, end) одной транзакцией. После временной ошибки ждёт retry_interval,
+    // восстанавливает target и повторяет, пока журнал не остановлен
+    JournalUnitOfWorkFactory::ApplyResult JournalUnitOfWorkFactory::Apply(const std::vector<const WrittenUnit*>& units,
+                                                                         std::size_t begin, std::size_t end) {
+        for (;;) {
+            try {
+                auto unit = target_.CreateUnitOfWork();
+                for (auto i = begin; i < end; ++i) {
+                    for (const auto& op : units[i]->operations) {
+                        ApplyOperation(op, *unit);
+                    }
+                }
+                unit->Commit();
+                return ApplyResult::kApplied;
+            } catch (const std::exception& error) {
+                if (target_.IsPermanentError(error)) {
+                    return ApplyResult::kRejected;
+                }
+            }
+            if (!WaitBeforeRetry()) {
+                return ApplyResult::kStopped;
+            }
+            try {
+                target_.Recover();
+            } catch (const std::exception&) {
+                // следующая попытка снова получит временную ошибку и подождёт
+            }
+        }
+    }
+
+    bool JournalUnitOfWorkFactory::WaitBeforeRetry() {
+        std::unique_lock lock{apply_mutex_};
+        return !apply_ready_.wait_for(lock, config_.retry_interval, [this] {
+            return writer_done_;
+        });
+    }
+
+    void JournalUnitOfWorkFactory::MarkApplied(std::uint64_t seq) {
+        if (seq <= applied_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        applied_.store(seq, std::memory_order_release);
+        applied_.notify_all();
+        Push(Entry{{}, std::nullopt, seq});
+    }
+
+    // Use case'ы считали пропущенный unit of work применённым: для них это чужое изменение
+    void JournalUnitOfWorkFactory::PublishReset() {
+        std::lock_guard lock{handlers_mutex_};
+        for (const auto& [subscription, handler] : handlers_) {
+            try {
+                handler(ChangeEvent{});
+            } catch (const std::exception&) {
+                // ошибка подписчика не должна останавливать применение
+            }
+        }
+    }
+
+}  // namespace app
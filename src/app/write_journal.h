@@ -0,0 +1,153 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../util/mpsc_queue.h"
+#include "change_feed.h"
+#include "unit_of_work.h"
+
+namespace app {
+
+    // Изменение репозитория, записанное в журнал: имя операции и её аргументы строками
+    struct JournalOperation {
+        std::string name;
+        std::vector<std::string> args;
+    };
+
+    struct WriteJournalConfig {
+        std::string path;
+        std::size_t max_batch_units = 256;  // unit of work в одной транзакции применения
+        std::chrono::milliseconds retry_interval{1000};     // пауза перед повтором после временной ошибки
+    };
+
+    // Хранилище, в которое журнал применяет unit of work. Используется только потоком применения
+    class JournalTarget {
+    public:
+        virtual std::unique_ptr<UnitOfWork> CreateUnitOfWork() = 0;
+        // Ошибка повторится при любом повторе (нарушено ограничение, нет автора): unit of work
+        // пропускается. Остальные (потеряно соединение) - повод восстановиться и повторить
+        virtual bool IsPermanentError(const std::exception& error) const = 0;
+        // Вызывается перед повтором после временной ошибки; может бросить - тогда повтор позже
+        virtual void Recover() = 0;
+
+    protected:
+        ~JournalTarget() = default;
+    };
+
+    /**
+     * Отложенная запись (write-behind). Пишущий unit of work, который только пишет, не обращается
+     * к хранилищу: его изменения записываются операциями в локальный файл журнала, и Commit
+     * возвращается после fsync (для Durability::kAsync - сразу). Поток записи собирает unit of work
+     * из lock-free очереди и сбрасывает их на диск одним fsync на пачку, поток применения переносит
+     * их в target пачками по max_batch_units одной транзакцией. При запуске журнал дочитывается:
+     * unit of work после последней отметки о применении применяются заново.
+     *
+     * Чтение учитывает журнал: read_only unit of work и пишущий unit of work при первом чтении ждут
+     * применения всего, что было зафиксировано до них, и дальше работают напрямую через direct.
+     *
+     * Ошибки операций (нет автора, дубликат имени) выясняются только при применении: такой unit of
+     * work пропускается целиком, остальные unit of work пачки применяются по одному. Use case'ы уже
+     * учли его в кэшах, поэтому подписчики получают kReset каталога. Временные ошибки хранилища
+     * ничего не пропускают: применение повторяется после target.Recover(), а при остановке
+     * неприменённое остаётся в журнале до следующего запуска.
+     *
+     * Если запись в файл не удалась, недописанная запись обрезается; если не удалось и это, журнал
+     * не принимает записи (Commit с kStrict получает ошибку), пока не будет начат заново.
+     */
+    class JournalUnitOfWorkFactory : public UnitOfWorkFactory, public ChangeFeed {
+    public:
+        // direct используется потоками вызывающих
+        JournalUnitOfWorkFactory(JournalTarget& target, UnitOfWorkFactory& direct,
+                                 const WriteJournalConfig& config);
+        ~JournalUnitOfWorkFactory();
+
+        JournalUnitOfWorkFactory(const JournalUnitOfWorkFactory&) = delete;
+        JournalUnitOfWorkFactory& operator=(const JournalUnitOfWorkFactory&) = delete;
+
+        std::unique_ptr<UnitOfWork> CreateUnitOfWork(const UnitOfWorkOptions& options = {}) override;
+
+        // Только kReset каталога при пропуске unit of work, из потока применения
+        std::size_t Subscribe(ChangeHandler handler) override;
+        void Unsubscribe(std::size_t subscription) override;
+
+        // Ждёт применения всех unit of work, зафиксированных до вызова
+        void WaitApplied();
+        // Пропущенные при применении unit of work
+        std::uint64_t GetDroppedCount() const noexcept {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        class JournalUnitOfWork;
+
+        struct Entry {
+            std::vector<JournalOperation> operations;
+            std::optional<std::promise<void>> written;  // есть - Commit ждёт fsync
+            std::uint64_t checkpoint = 0;               // не 0 - применены unit of work до этого номера
+        };
+
+        struct WrittenUnit {
+            std::uint64_t seq = 0;
+            std::vector<JournalOperation> operations;
+            bool lost = false;      // не записан, Commit получил ошибку - не применяется
+        };
+
+        enum class ApplyResult {
+            kApplied,
+            kRejected,  // постоянная ошибка
+            kStopped    // остановка во время повторов
+        };
+
+        void Append(std::vector<JournalOperation> operations, Durability durability);
+        void Push(Entry entry);
+        void Replay();
+        void WriteLoop();
+        bool WriteBuffer(const std::string& buffer, bool truncate, bool sync);
+        void ApplyLoop();
+        bool ApplyBatch(const std::vector<WrittenUnit>& batch);
+        ApplyResult Apply(const std::vector<const WrittenUnit*>& units, std::size_t begin, std::size_t end);
+        bool WaitBeforeRetry();
+        void MarkApplied(std::uint64_t seq);
+        void PublishReset();
+
+        JournalTarget& target_;
+        UnitOfWorkFactory& direct_;
+        WriteJournalConfig config_;
+        int fd_ = -1;
+
+        util::MpscQueue<Entry> queue_;
+        std::atomic<std::uint64_t> pushes_{0};      // будит поток записи
+        std::atomic<std::uint64_t> appended_{0};    // номер последнего отданного в журнал unit of work
+        std::atomic<std::uint64_t> applied_{0};     // номер последнего применённого или пропущенного
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<bool> stop_{false};
+        std::uint64_t written_seq_ = 0;             // только поток записи
+        bool broken_ = false;                       // только поток записи: в конце файла мусор
+
+        std::mutex apply_mutex_;
+        std::condition_variable apply_ready_;
+        std::deque<WrittenUnit> to_apply_;
+        bool writer_done_ = false;
+
+        std::mutex handlers_mutex_;
+        std::map<std::size_t, ChangeHandler> handlers_;
+        std::size_t next_subscription_ = 1;
+
+        std::thread writer_;
+        std::thread applier_;
+    };
+
+}  // namespace app
@@ -1,5 +1,7 @@
 #include "bookypedia.h"
 
+#include <unistd.h>
+
 #include <iostream>
 
 #include "menu/menu.h"
@@ -10,9 +12,275 @@ namespace bookypedia {
 
 using namespace std::literals;
 
+namespace {
+
+std::unique_ptr<catalog::SharedMemoryCatalog> MakeSharedCatalog(const AppConfig& config) {
+    if (config.shared_catalog_name.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<catalog::SharedMemoryCatalog>(config.shared_catalog_name,
+                                                          config.shared_catalog_bytes);
+}
+
+std::unique_ptr<postgres::Database> MakeDatabase(const AppConfig& config) {
+    if (!config.snapshot_path.empty() || config.backend != Backend::kPostgres) {
+        return nullptr;
+    }
+    return std::make_unique<postgres::Database>(pqxx::connection{config.db_url});
+}
+
+std::unique_ptr<pqxx::connection> MakeGroupCommitConnection(const AppConfig& config, postgres::Database* db) {
+    if (!db || !config.group_commit) {
+        return nullptr;
+    }
+    return std::make_unique<pqxx::connection>(config.db_url);
+}
+
+std::unique_ptr<postgres::JournalTargetImpl> MakeJournalTarget(const AppConfig& config, postgres::Database* db,
+                                                               postgres::LocalBackends& local_backends) {
+    if (!db || config.write_journal_path.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<postgres::JournalTargetImpl>(config.db_url, local_backends);
+}
+
+// Записи всех соединений процесса с db_url (основного, group commit, журнала) - свои: кэши уже
+// обновлены use case'ами, и их уведомления не должны сбрасывать производные структуры.
+// Журнал регистрирует своё соединение сам: оно открывается заново после обрыва
+std::unique_ptr<postgres::ChangeListener> MakeChangeListener(const AppConfig& config, postgres::Database* db,
+                                                             postgres::LocalBackends& local_backends,
+                                                             std::initializer_list<pqxx::connection*> connections) {
+    if (!db) {
+        return nullptr;
+    }
+    local_backends.Add(db->GetConnection().backend_pid());
+    for (auto* connection : connections) {
+        if (connection) {
+            local_backends.Add(connection->backend_pid());
+        }
+    }
+    return std::make_unique<postgres::ChangeListener>(config.db_url, local_backends);
+}
+
+std::vector<std::unique_ptr<pqxx::connection>> MakeReplicaConnections(const AppConfig& config,
+                                                                     postgres::Database* db) {
+    std::vector<std::unique_ptr<pqxx::connection>> connections;
+    if (!db) {
+        return connections;
+    }
+    for (const auto& url : config.replica_urls) {
+        try {
+            connections.push_back(std::make_unique<pqxx::connection>(url));
+        } catch (const pqxx::broken_connection&) {
+            // Чтение пойдёт на остальные реплики или на primary
+        }
+    }
+    return connections;
+}
+
+std::vector<std::unique_ptr<postgres::UnitOfWorkFactoryImpl>> MakeReplicaFactories(
+        const std::vector<std::unique_ptr<pqxx::connection>>& connections) {
+    std::vector<std::unique_ptr<postgres::UnitOfWorkFactoryImpl>> factories;
+    for (const auto& connection : connections) {
+        factories.push_back(std::make_unique<postgres::UnitOfWorkFactoryImpl>(*connection));
+    }
+    return factories;
+}
+
+std::vector<app::UnitOfWorkFactory*> GetPointers(
+        const std::vector<std::unique_ptr<postgres::UnitOfWorkFactoryImpl>>& factories) {
+    std::vector<app::UnitOfWorkFactory*> pointers;
+    for (const auto& factory : factories) {
+        pointers.push_back(factory.get());
+    }
+    return pointers;
+}
+
+// Недоступный шард - ошибка запуска: его авторов нельзя ни прочитать, ни разместить на других
+std::vector<std::unique_ptr<postgres::Database>> MakeShardDatabases(const AppConfig& config, postgres::Database* db) {
+    std::vector<std::unique_ptr<postgres::Database>> shards;
+    if (!db) {
+        return shards;
+    }
+    for (const auto& url : config.shard_urls) {
+        shards.push_back(std::make_unique<postgres::Database>(pqxx::connection{url}));
+    }
+    return shards;
+}
+
+std::vector<std::unique_ptr<postgres::UnitOfWorkFactoryImpl>> MakeShardFactories(
+        const std::vector<std::unique_ptr<postgres::Database>>& shards) {
+    std::vector<std::unique_ptr<postgres::UnitOfWorkFactoryImpl>> factories;
+    for (const auto& shard : shards) {
+        factories.push_back(std::make_unique<postgres::UnitOfWorkFactoryImpl>(shard->GetConnection()));
+    }
+    return factories;
+}
+
+// Триггеры шарда уведомляют только слушателей его базы, а pid соединений разных серверов могут
+// совпадать, поэтому у каждого шарда свои слушатель и набор своих соединений
+std::vector<std::unique_ptr<postgres::LocalBackends>> MakeShardBackends(
+        const std::vector<std::unique_ptr<postgres::Database>>& shards) {
+    std::vector<std::unique_ptr<postgres::LocalBackends>> backends;
+    for (const auto& shard : shards) {
+        backends.push_back(std::make_unique<postgres::LocalBackends>());
+        backends.back()->Add(shard->GetConnection().backend_pid());
+    }
+    return backends;
+}
+
+std::vector<std::unique_ptr<postgres::ChangeListener>> MakeShardListeners(
+        const AppConfig& config, const std::vector<std::unique_ptr<postgres::LocalBackends>>& backends) {
+    std::vector<std::unique_ptr<postgres::ChangeListener>> listeners;
+    for (std::size_t i = 0; i < backends.size(); ++i) {
+        listeners.push_back(std::make_unique<postgres::ChangeListener>(config.shard_urls[i], *backends[i]));
+    }
+    return listeners;
+}
+
+std::unique_ptr<app::CompositeChangeFeed> MakeChangeFeed(std::vector<app::ChangeFeed*> feeds) {
+    if (feeds.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<app::CompositeChangeFeed>(std::move(feeds));
+}
+
+std::unique_ptr<app::ShardedUnitOfWorkFactory> MakeShardedFactory(
+        postgres::UnitOfWorkFactoryImpl* db_factory,
+        const std::vector<std::unique_ptr<postgres::UnitOfWorkFactoryImpl>>& shard_factories) {
+    if (!db_factory || shard_factories.empty()) {
+        return nullptr;
+    }
+    std::vector<app::UnitOfWorkFactory*> shards{db_factory};
+    for (auto* shard : GetPointers(shard_factories)) {
+        shards.push_back(shard);
+    }
+    return std::make_unique<app::ShardedUnitOfWorkFactory>(shards);
+}
+
+std::unique_ptr<memory::Database> MakeMemoryDatabase(const AppConfig& config) {
+    if (!config.snapshot_path.empty() || config.backend != Backend::kMemory) {
+        return nullptr;
+    }
+    return std::make_unique<memory::Database>();
+}
+
+std::unique_ptr<catalog::SnapshotFile> MakeSnapshot(const AppConfig& config) {
+    if (config.snapshot_path.empty()) {
+        return nullptr;
+    }
+    auto snapshot = std::make_unique<catalog::SnapshotFile>(config.snapshot_path);
+    if (config.verify_snapshot) {
+        snapshot->Verify();
+    }
+    return snapshot;
+}
+
+}  // namespace
+
 Application::Application(const AppConfig& config)
-    : db_{pqxx::connection{config.db_url}},
-      factory_(db_.GetConnection()){
+    : db_{MakeDatabase(config)},
+      memory_db_{MakeMemoryDatabase(config)},
+      snapshot_{MakeSnapshot(config)},
+      shared_catalog_{MakeSharedCatalog(config)},
+      db_factory_{db_ ? std::make_unique<postgres::UnitOfWorkFactoryImpl>(db_->GetConnection()) : nullptr},
+      group_commit_connection_{MakeGroupCommitConnection(config, db_.get())},
+      group_commit_factory_{group_commit_connection_
+                            ? std::make_unique<postgres::GroupCommitUnitOfWorkFactory>(
+                                    *group_commit_connection_, *db_factory_, *config.group_commit)
+                            : nullptr},
+      journal_target_{MakeJournalTarget(config, db_.get(), local_backends_)},
+      journal_factory_{journal_target_
+                       ? std::make_unique<app::JournalUnitOfWorkFactory>(
+                               *journal_target_,
+                               group_commit_factory_ ? static_cast<app::UnitOfWorkFactory&>(*group_commit_factory_)
+                                                     : *db_factory_,
+                               app::WriteJournalConfig{config.write_journal_path})
+                       : nullptr},
+      change_listener_{MakeChangeListener(config, db_.get(), local_backends_, {group_commit_connection_.get()})},
+      replica_connections_{MakeReplicaConnections(config, db_.get())},
+      replica_factories_{MakeReplicaFactories(replica_connections_)},
+      replica_router_{replica_factories_.empty()
+                      ? nullptr
+                      : std::make_unique<app::ReplicaRoutingUnitOfWorkFactory>(
+                              GetPrimaryFactory(), GetPointers(replica_factories_), config.replica_routing)},
+      shard_dbs_{MakeShardDatabases(config, db_.get())},
+      shard_factories_{MakeShardFactories(shard_dbs_)},
+      sharded_factory_{MakeShardedFactory(db_factory_.get(), shard_factories_)},
+      shard_backends_{MakeShardBackends(shard_dbs_)},
+      shard_listeners_{MakeShardListeners(config, shard_backends_)},
+      change_feed_{MakeChangeFeed(GetChangeFeeds())},
+      memory_factory_{memory_db_ ? std::make_unique<memory::UnitOfWorkFactoryImpl>(*memory_db_) : nullptr},
+      snapshot_factory_{snapshot_ ? std::make_unique<catalog::SnapshotUnitOfWorkFactory>(snapshot_->GetImage()) : nullptr},
+      db_importer_{db_ ? std::make_unique<postgres::CatalogImporterImpl>(db_->GetConnection()) : nullptr},
+      memory_importer_{memory_db_ ? std::make_unique<memory::CatalogImporterImpl>(*memory_db_) : nullptr},
+      db_exporter_{db_ ? std::make_unique<postgres::CatalogExporterImpl>(db_->GetConnection()) : nullptr},
+      memory_exporter_{memory_db_ ? std::make_unique<memory::CatalogExporterImpl>(*memory_db_) : nullptr},
+      use_cases_{GetFactory(), config.use_cases, change_feed_.get(), shared_catalog_.get(), &snapshot_writer_,
+                 GetImporter(), GetExporter()}{
+}
+
+app::UnitOfWorkFactory& Application::GetFactory() {
+    if (snapshot_factory_) {
+        return *snapshot_factory_;
+    }
+    if (memory_factory_) {
+        return *memory_factory_;
+    }
+    if (sharded_factory_) {
+        return *sharded_factory_;
+    }
+    if (replica_router_) {
+        return *replica_router_;
+    }
+    return GetPrimaryFactory();
+}
+
+// Уведомления основной базы и шардов и пропуски журнала
+std::vector<app::ChangeFeed*> Application::GetChangeFeeds() {
+    std::vector<app::ChangeFeed*> feeds;
+    if (change_listener_) {
+        feeds.push_back(change_listener_.get());
+    }
+    if (journal_factory_) {
+        feeds.push_back(journal_factory_.get());
+    }
+    for (const auto& listener : shard_listeners_) {
+        feeds.push_back(listener.get());
+    }
+    return feeds;
+}
+
+app::UnitOfWorkFactory& Application::GetPrimaryFactory() {
+    if (journal_factory_) {
+        return *journal_factory_;
+    }
+    if (group_commit_factory_) {
+        return *group_commit_factory_;
+    }
+    return *db_factory_;
+}
+
+// В режиме снимка импорта нет, с шардами тоже: пакетный импорт пишет в одну базу
+app::CatalogImporter* Application::GetImporter() {
+    if (memory_importer_) {
+        return memory_importer_.get();
+    }
+    if (sharded_factory_) {
+        return nullptr;
+    }
+    return db_importer_.get();
+}
+
+// В режиме снимка выгрузки нет: для неё есть сам файл снимка
+app::CatalogExporter* Application::GetExporter() {
+    if (memory_exporter_) {
+        return memory_exporter_.get();
+    }
+    if (sharded_factory_) {
+        return nullptr;
+    }
+    return db_exporter_.get();
 }
 
 void Application::Run() {
@@ -24,7 +292,7 @@ void Application::Run() {
     menu.AddAction("Exit"s, {}, "Exit program"s, [&menu](std::istream&) {
         return false;
     });
-    ui::View view{menu, use_cases_, std::cin, std::cout};
+    ui::View view{menu, use_cases_, std::cin, std::cout, isatty(STDIN_FILENO) != 0};
     menu.Run();
 }
 
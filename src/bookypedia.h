@@ -1,13 +1,52 @@
 #pragma once
 #include <pqxx/pqxx>
 
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "app/replica_routing.h"
+#include "app/sharding.h"
 #include "app/use_cases_impl.h"
+#include "app/write_journal.h"
+#include "catalog/shared_memory_catalog.h"
+#include "catalog/snapshot_file.h"
+#include "catalog/snapshot_repositories.h"
+#include "memory/memory_database.h"
+#include "postgres/catalog_exporter.h"
+#include "postgres/catalog_importer.h"
+#include "postgres/change_listener.h"
+#include "postgres/group_commit.h"
+#include "postgres/journal_target.h"
 #include "postgres/postgres.h"
 
 namespace bookypedia {
 
+enum class Backend {
+    kPostgres,
+    kMemory,    // каталог в памяти процесса, не сохраняется между запусками
+};
+
 struct AppConfig {
+    Backend backend = Backend::kPostgres;
     std::string db_url;
+    app::UseCasesConfig use_cases;
+    std::string shared_catalog_name;    // пусто - без общего снимка каталога
+    std::size_t shared_catalog_bytes = 64 * 1024 * 1024;
+    std::string snapshot_path;          // не пусто - только чтение из файла снимка, без БД
+    bool verify_snapshot = false;       // проверять контрольную сумму всего снимка при открытии
+    // Задано - пишущие use case'ы Postgres фиксируются группами по отдельному соединению
+    std::optional<postgres::GroupCommitConfig> group_commit;
+    // Не пусто - пишущие use case'ы Postgres возвращаются после записи в этот локальный журнал
+    std::string write_journal_path;
+    // Реплики Postgres для read_only unit of work; недоступные при запуске пропускаются
+    std::vector<std::string> replica_urls;
+    app::ReplicaRoutingConfig replica_routing;
+    // Не пусто - каталог разбит по авторам на db_url и эти базы; импорт, выгрузка, group commit,
+    // журнал и реплики в этом режиме не используются
+    std::vector<std::string> shard_urls;
 };
 
 class Application {
@@ -17,11 +56,42 @@ public:
     void Run();
 
 private:
-    postgres::Database db_;
-    postgres::UnitOfWorkFactoryImpl factory_;
-    app::UseCasesImpl use_cases_{factory_};
-
+    app::UnitOfWorkFactory& GetFactory();
+    // Фабрика Postgres для записи: журнал, group commit или основное соединение
+    app::UnitOfWorkFactory& GetPrimaryFactory();
+    std::vector<app::ChangeFeed*> GetChangeFeeds();
+    app::CatalogImporter* GetImporter();
+    app::CatalogExporter* GetExporter();
 
+    // Задан ровно один из db_factory_, memory_factory_ и snapshot_factory_ вместе со своим хранилищем
+    postgres::LocalBackends local_backends_;     // соединения этого процесса с db_url
+    std::unique_ptr<postgres::Database> db_;
+    std::unique_ptr<memory::Database> memory_db_;
+    std::unique_ptr<catalog::SnapshotFile> snapshot_;
+    std::unique_ptr<catalog::SharedMemoryCatalog> shared_catalog_;
+    std::unique_ptr<postgres::UnitOfWorkFactoryImpl> db_factory_;
+    std::unique_ptr<pqxx::connection> group_commit_connection_;
+    std::unique_ptr<postgres::GroupCommitUnitOfWorkFactory> group_commit_factory_;
+    std::unique_ptr<postgres::JournalTargetImpl> journal_target_;
+    std::unique_ptr<app::JournalUnitOfWorkFactory> journal_factory_;
+    std::unique_ptr<postgres::ChangeListener> change_listener_;
+    std::vector<std::unique_ptr<pqxx::connection>> replica_connections_;
+    std::vector<std::unique_ptr<postgres::UnitOfWorkFactoryImpl>> replica_factories_;
+    std::unique_ptr<app::ReplicaRoutingUnitOfWorkFactory> replica_router_;
+    std::vector<std::unique_ptr<postgres::Database>> shard_dbs_;     // шарды после db_
+    std::vector<std::unique_ptr<postgres::UnitOfWorkFactoryImpl>> shard_factories_;
+    std::unique_ptr<app::ShardedUnitOfWorkFactory> sharded_factory_;
+    std::vector<std::unique_ptr<postgres::LocalBackends>> shard_backends_;
+    std::vector<std::unique_ptr<postgres::ChangeListener>> shard_listeners_;
+    std::unique_ptr<app::CompositeChangeFeed> change_feed_;
+    std::unique_ptr<memory::UnitOfWorkFactoryImpl> memory_factory_;
+    std::unique_ptr<catalog::SnapshotUnitOfWorkFactory> snapshot_factory_;
+    std::unique_ptr<postgres::CatalogImporterImpl> db_importer_;
+    std::unique_ptr<memory::CatalogImporterImpl> memory_importer_;
+    std::unique_ptr<postgres::CatalogExporterImpl> db_exporter_;
+    std::unique_ptr<memory::CatalogExporterImpl> memory_exporter_;
+    catalog::SnapshotFileWriter snapshot_writer_;
+    app::UseCasesImpl use_cases_;
 };
 
 }  // namespace bookypedia
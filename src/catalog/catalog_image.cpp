@@ -0,0 +1,438 @@
+#include "catalog_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+#include "../util/tagged_uuid.h"
+
+namespace catalog {
+    namespace {
+        constexpr std::uint32_t IMAGE_MAGIC = 0x4B4F4F42;    // "BOOK"
+        constexpr std::uint32_t IMAGE_VERSION = 2;
+        constexpr std::uint32_t NO_AUTHOR = std::numeric_limits<std::uint32_t>::max();
+
+        using Uuid = util::detail::UUIDType;
+
+        struct ImageHeader {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t author_count;
+            std::uint32_t book_count;
+            std::uint32_t tag_count;
+            std::uint32_t strings_size;
+        };
+
+        struct AuthorRecord {
+            std::uint8_t id[16];
+            std::uint32_t name_offset;
+            std::uint32_t name_size;
+        };
+
+        struct BookRecord {
+            std::uint8_t id[16];
+            std::uint32_t author_index;
+            std::int32_t year;
+            std::uint32_t title_offset;
+            std::uint32_t title_size;
+            std::uint32_t tags_begin;
+            std::uint32_t tags_count;
+        };
+
+        struct StringRef {
+            std::uint32_t offset;
+            std::uint32_t size;
+        };
+
+        static_assert(sizeof(Uuid) == 16);
+        static_assert(sizeof(ImageHeader) % 4 == 0 && sizeof(AuthorRecord) % 4 == 0
+                      && sizeof(BookRecord) % 4 == 0 && sizeof(StringRef) % 4 == 0);
+
+        std::uint32_t CheckedSize(std::size_t size) {
+            if (size > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::length_error("Catalog image is too large");
+            }
+            return static_cast<std::uint32_t>(size);
+        }
+
+        class StringsBuilder {
+        public:
+            StringRef Add(std::string_view str) {
+                StringRef ref{CheckedSize(strings_.size()), CheckedSize(str.size())};
+                strings_.append(str);
+                return ref;
+            }
+
+            const std::string& Get() const noexcept {
+                return strings_;
+            }
+
+        private:
+            std::string strings_;
+        };
+
+        template <typename T>
+        void Append(std::string& image, const T& value) {
+            image.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        std::optional<Uuid> ParseId(const std::string& id) {
+            try {
+                return util::detail::UUIDFromString(id);
+            } catch (const std::exception&) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    std::string BuildImage(const CatalogData &data) {
+        // Авторы и книги по возрастанию id, order[i] - позиция i-го элемента исходного списка
+        std::vector<std::pair<Uuid, std::size_t>> authors;
+        for (std::size_t i = 0; i < data.authors.size(); ++i) {
+            if (auto id = ParseId(data.authors[i].first)) {
+                authors.emplace_back(*id, i);
+            }
+        }
+        std::sort(authors.begin(), authors.end());
+        std::map<std::string, std::uint32_t> author_index;
+        std::vector<std::uint32_t> author_order(data.authors.size(), NO_AUTHOR);
+        for (std::size_t i = 0; i < authors.size(); ++i) {
+            author_index[data.authors[authors[i].second].first] = CheckedSize(i);
+            author_order[authors[i].second] = CheckedSize(i);
+        }
+        std::erase(author_order, NO_AUTHOR);
+
+        std::vector<std::pair<Uuid, std::size_t>> books;
+        for (std::size_t i = 0; i < data.books.size(); ++i) {
+            if (auto id = ParseId(data.books[i].id)) {
+                books.emplace_back(*id, i);
+            }
+        }
+        std::sort(books.begin(), books.end());
+        std::vector<std::uint32_t> book_order(data.books.size(), NO_AUTHOR);
+        for (std::size_t i = 0; i < books.size(); ++i) {
+            book_order[books[i].second] = CheckedSize(i);
+        }
+        std::erase(book_order, NO_AUTHOR);
+
+        // Книги без известного автора попадают в группу нулевого id, как их и увидит ImageView
+        const std::string no_author_id = util::detail::UUIDToString(util::detail::ZeroUUID);
+        auto author_key = [&](const domain::BookData& book) -> const std::string& {
+            return author_index.count(book.author_id) ? book.author_id : no_author_id;
+        };
+        std::vector<std::uint32_t> author_books_order(books.size());
+        std::iota(author_books_order.begin(), author_books_order.end(), 0);
+        std::sort(author_books_order.begin(), author_books_order.end(),
+                  [&](std::uint32_t lhs, std::uint32_t rhs) {
+                      const auto& l = data.books[books[lhs].second];
+                      const auto& r = data.books[books[rhs].second];
+                      return std::tie(author_key(l), l.year, l.title) < std::tie(author_key(r), r.year, r.title);
+                  });
+        // Побайтовый порядок названий для двоичного поиска; равные названия - в порядке book_order
+        std::vector<std::uint32_t> title_order = book_order;
+        std::stable_sort(title_order.begin(), title_order.end(), [&](std::uint32_t lhs, std::uint32_t rhs) {
+            return data.books[books[lhs].second].title < data.books[books[rhs].second].title;
+        });
+
+        std::map<std::string, std::vector<std::string_view>> tags_by_book;
+        for (const auto& [book_id, tag] : data.book_tags) {
+            tags_by_book[book_id].push_back(tag);
+        }
+
+        StringsBuilder strings;
+        std::string records;
+        for (const auto& [id, pos] : authors) {
+            AuthorRecord record{};
+            std::memcpy(record.id, id.data, sizeof(record.id));
+            auto name = strings.Add(data.authors[pos].second);
+            record.name_offset = name.offset;
+            record.name_size = name.size;
+            Append(records, record);
+        }
+        std::vector<StringRef> tags;
+        for (const auto& [id, pos] : books) {
+            const auto& book = data.books[pos];
+            BookRecord record{};
+            std::memcpy(record.id, id.data, sizeof(record.id));
+            auto author = author_index.find(book.author_id);
+            record.author_index = author == author_index.end() ? NO_AUTHOR : author->second;
+            record.year = book.year;
+            auto title = strings.Add(book.title);
+            record.title_offset = title.offset;
+            record.title_size = title.size;
+            record.tags_begin = CheckedSize(tags.size());
+            if (auto it = tags_by_book.find(book.id); it != tags_by_book.end()) {
+                for (auto tag : it->second) {
+                    tags.push_back(strings.Add(tag));
+                }
+            }
+            record.tags_count = CheckedSize(tags.size()) - record.tags_begin;
+            Append(records, record);
+        }
+
+        std::string image;
+        Append(image, ImageHeader{IMAGE_MAGIC, IMAGE_VERSION, CheckedSize(authors.size()),
+                                  CheckedSize(books.size()), CheckedSize(tags.size()),
+                                  CheckedSize(strings.Get().size())});
+        image += records;
+        for (const auto& tag : tags) {
+            Append(image, tag);
+        }
+        for (const auto& order : {author_order, book_order, author_books_order, title_order}) {
+            for (auto index : order) {
+                Append(image, index);
+            }
+        }
+        image += strings.Get();
+        CheckedSize(image.size());
+        return image;
+    }
+
+    //------------------------------------------------------------------------
+    //===============ImageView==================================
+    ImageView::ImageView(const char *data, std::size_t size)
+        : data_(data), size_(size) {
+        auto header = Load<ImageHeader>(0);
+        if (header.magic != IMAGE_MAGIC || header.version != IMAGE_VERSION) {
+            throw std::runtime_error("Unsupported catalog image format");
+        }
+        author_count_ = header.author_count;
+        book_count_ = header.book_count;
+        tag_count_ = header.tag_count;
+        authors_offset_ = sizeof(ImageHeader);
+        books_offset_ = authors_offset_ + std::size_t{author_count_} * sizeof(AuthorRecord);
+        tags_offset_ = books_offset_ + std::size_t{book_count_} * sizeof(BookRecord);
+        author_order_offset_ = tags_offset_ + std::size_t{tag_count_} * sizeof(StringRef);
+        book_order_offset_ = author_order_offset_ + std::size_t{author_count_} * sizeof(std::uint32_t);
+        author_books_order_offset_ = book_order_offset_ + std::size_t{book_count_} * sizeof(std::uint32_t);
+        title_order_offset_ = author_books_order_offset_ + std::size_t{book_count_} * sizeof(std::uint32_t);
+        strings_offset_ = title_order_offset_ + std::size_t{book_count_} * sizeof(std::uint32_t);
+        if (strings_offset_ + header.strings_size > size_) {
+            throw std::out_of_range("Truncated catalog image");
+        }
+    }
+
+    std::size_t ImageView::GetAuthorCount() const noexcept {
+        return author_count_;
+    }
+
+    std::size_t ImageView::GetBookCount() const noexcept {
+        return book_count_;
+    }
+
+    std::size_t ImageView::GetTagCount() const noexcept {
+        return tag_count_;
+    }
+
+    std::vector<std::pair<std::string, std::string>> ImageView::ReadAuthors() const {
+        std::vector<std::pair<std::string, std::string>> authors;
+        authors.reserve(author_count_);
+        for (std::size_t i = 0; i < author_count_; ++i) {
+            auto record = Load<AuthorRecord>(authors_offset_ + LoadIndex(author_order_offset_, i) * sizeof(AuthorRecord));
+            Uuid id;
+            std::memcpy(id.data, record.id, sizeof(record.id));
+            authors.emplace_back(util::detail::UUIDToString(id),
+                                 std::string{LoadString(record.name_offset, record.name_size)});
+        }
+        return authors;
+    }
+
+    std::vector<domain::BookData> ImageView::ReadBooks() const {
+        std::vector<domain::BookData> books;
+        books.reserve(book_count_);
+        for (std::size_t i = 0; i < book_count_; ++i) {
+            books.push_back(LoadBook(LoadIndex(book_order_offset_, i), true));
+        }
+        return books;
+    }
+
+    // title_order упорядочен побайтово по названию (см. BuildImage) - двоичный поиск начала диапазона
+    std::vector<domain::BookData> ImageView::ReadBooksByTitle(std::string_view title) const {
+        auto title_of = [this](std::size_t position) {
+            auto record = Load<BookRecord>(books_offset_ + LoadIndex(title_order_offset_, position) * sizeof(BookRecord));
+            return LoadString(record.title_offset, record.title_size);
+        };
+        std::size_t lo = 0;
+        std::size_t hi = book_count_;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (title_of(mid) < title) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        std::vector<domain::BookData> books;
+        for (; lo < book_count_ && title_of(lo) == title; ++lo) {
+            books.push_back(LoadBook(LoadIndex(title_order_offset_, lo), true));
+        }
+        return books;
+    }
+
+    // Как и BookRepositoryImpl::ReadAuthorBooks, не заполняет author_name
+    std::vector<domain::BookData> ImageView::ReadAuthorBooks(const std::string &author_id) const {
+        std::vector<domain::BookData> books;
+        auto id = ParseId(author_id);
+        if (!id) {
+            return books;
+        }
+        auto author_of = [this](std::size_t position) {
+            auto record = Load<BookRecord>(books_offset_ + LoadIndex(author_books_order_offset_, position) * sizeof(BookRecord));
+            return record.author_index;
+        };
+        auto author_id_of = [this](std::uint32_t author_index) {
+            Uuid result = util::detail::ZeroUUID;
+            if (author_index != NO_AUTHOR) {
+                auto record = Load<AuthorRecord>(authors_offset_ + author_index * sizeof(AuthorRecord));
+                std::memcpy(result.data, record.id, sizeof(record.id));
+            }
+            return util::detail::UUIDToString(result);
+        };
+        // author_books_order упорядочен по строковому author_id (см. BuildImage)
+        std::size_t lo = 0;
+        std::size_t hi = book_count_;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (author_id_of(author_of(mid)) < author_id) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (; lo < book_count_ && author_id_of(author_of(lo)) == author_id; ++lo) {
+            books.push_back(LoadBook(LoadIndex(author_books_order_offset_, lo), false));
+        }
+        return books;
+    }
+
+    std::vector<std::pair<std::string, std::string>> ImageView::ReadBookTags() const {
+        std::vector<std::pair<std::string, std::string>> book_tags;
+        book_tags.reserve(tag_count_);
+        for (std::size_t i = 0; i < book_count_; ++i) {
+            auto record = Load<BookRecord>(books_offset_ + i * sizeof(BookRecord));
+            if (record.tags_count == 0) {
+                continue;
+            }
+            Uuid id;
+            std::memcpy(id.data, record.id, sizeof(record.id));
+            auto book_id = util::detail::UUIDToString(id);
+            for (std::uint32_t t = 0; t < record.tags_count; ++t) {
+                auto tag = Load<StringRef>(tags_offset_ + std::size_t{record.tags_begin + t} * sizeof(StringRef));
+                book_tags.emplace_back(book_id, std::string{LoadString(tag.offset, tag.size)});
+            }
+        }
+        return book_tags;
+    }
+
+    std::optional<domain::BookData> ImageView::FindBook(const std::string &book_id) const {
+        if (auto index = FindBookIndex(book_id)) {
+            return LoadBook(*index, true);
+        }
+        return std::nullopt;
+    }
+
+    // Записи авторов упорядочены по id - двоичный поиск, как в FindBookIndex
+    std::optional<std::string> ImageView::FindAuthorName(const std::string &author_id) const {
+        auto id = ParseId(author_id);
+        if (!id) {
+            return std::nullopt;
+        }
+        std::size_t lo = 0;
+        std::size_t hi = author_count_;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            auto record = Load<AuthorRecord>(authors_offset_ + mid * sizeof(AuthorRecord));
+            int cmp = std::memcmp(record.id, id->data, sizeof(record.id));
+            if (cmp == 0) {
+                return std::string{LoadString(record.name_offset, record.name_size)};
+            }
+            if (cmp < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<std::string> ImageView::ReadTagsOf(const std::string &book_id) const {
+        std::vector<std::string> tags;
+        if (auto index = FindBookIndex(book_id)) {
+            auto record = Load<BookRecord>(books_offset_ + *index * sizeof(BookRecord));
+            for (std::uint32_t t = 0; t < record.tags_count; ++t) {
+                auto tag = Load<StringRef>(tags_offset_ + std::size_t{record.tags_begin + t} * sizeof(StringRef));
+                tags.emplace_back(LoadString(tag.offset, tag.size));
+            }
+        }
+        return tags;
+    }
+
+    template <typename T>
+    T ImageView::Load(std::size_t offset) const {
+        if (offset > size_ || size_ - offset < sizeof(T)) {
+            throw std::out_of_range("Catalog image access out of range");
+        }
+        T value;
+        std::memcpy(&value, data_ + offset, sizeof(T));
+        return value;
+    }
+
+    std::string_view ImageView::LoadString(std::uint32_t offset, std::uint32_t size) const {
+        std::size_t begin = strings_offset_ + offset;
+        if (begin > size_ || size_ - begin < size) {
+            throw std::out_of_range("Catalog image access out of range");
+        }
+        return {data_ + begin, size};
+    }
+
+    std::uint32_t ImageView::LoadIndex(std::size_t section_offset, std::size_t position) const {
+        return Load<std::uint32_t>(section_offset + position * sizeof(std::uint32_t));
+    }
+
+    domain::BookData ImageView::LoadBook(std::size_t index, bool with_author_name) const {
+        auto record = Load<BookRecord>(books_offset_ + index * sizeof(BookRecord));
+        Uuid id;
+        std::memcpy(id.data, record.id, sizeof(record.id));
+        domain::BookData book;
+        book.id = util::detail::UUIDToString(id);
+        book.title = LoadString(record.title_offset, record.title_size);
+        book.year = record.year;
+        if (record.author_index != NO_AUTHOR) {
+            auto author = Load<AuthorRecord>(authors_offset_ + std::size_t{record.author_index} * sizeof(AuthorRecord));
+            Uuid author_id;
+            std::memcpy(author_id.data, author.id, sizeof(author.id));
+            book.author_id = util::detail::UUIDToString(author_id);
+            if (with_author_name) {
+                book.author_name = LoadString(author.name_offset, author.name_size);
+            }
+        }
+        return book;
+    }
+
+    std::optional<std::size_t> ImageView::FindBookIndex(const std::string &book_id) const {
+        auto id = ParseId(book_id);
+        if (!id) {
+            return std::nullopt;
+        }
+        std::size_t lo = 0;
+        std::size_t hi = book_count_;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            auto record = Load<BookRecord>(books_offset_ + mid * sizeof(BookRecord));
+            int cmp = std::memcmp(record.id, id->data, sizeof(record.id));
+            if (cmp == 0) {
+                return mid;
+            }
+            if (cmp < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return std::nullopt;
+    }
+
+}  // namespace catalog
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../domain/book.h"
+
+namespace catalog {
+
+/**
+ * Бинарный образ каталога (авторы, книги, теги), пригодный для размещения в разделяемой памяти
+ * или в файле, отображаемом через mmap. Структура:
+ *
+ *  ImageHeader
+ *  AuthorRecord[author_count]   - по возрастанию id (16 байт UUID)
+ *  BookRecord[book_count]       - по возрастанию id
+ *  StringRef[tag_count]         - теги, сгруппированные по книгам
+ *  uint32_t[author_count]       - индексы авторов в порядке ORDER BY name
+ *  uint32_t[book_count]         - индексы книг в порядке ORDER BY title, name, publication_year
+ *  uint32_t[book_count]         - индексы книг в порядке ORDER BY author_id, publication_year, title
+ *  uint32_t[book_count]         - индексы книг по побайтовому порядку названий (для ReadBooksByTitle)
+ *  char[strings_size]           - имена, названия и теги
+ *
+ * Все поля выровнены на 4 байта. Образ не зависит от адреса, по которому отображён.
+ */
+struct CatalogData {
+    std::vector<std::pair<std::string, std::string>> authors;     // id, name
+    std::vector<domain::BookData> books;
+    std::vector<std::pair<std::string, std::string>> book_tags;   // book_id, tag
+};
+
+std::string BuildImage(const CatalogData& data);
+
+// Чтение образа. Все обращения проверяют границы: повреждённый (или недописанный) образ
+// приводит к std::out_of_range, а не к чтению за пределами буфера.
+class ImageView {
+public:
+    ImageView(const char* data, std::size_t size);
+
+    std::size_t GetAuthorCount() const noexcept;
+    std::size_t GetBookCount() const noexcept;
+    std::size_t GetTagCount() const noexcept;
+
+    std::vector<std::pair<std::string, std::string>> ReadAuthors() const;
+    std::vector<domain::BookData> ReadBooks() const;
+    std::vector<domain::BookData> ReadBooksByTitle(std::string_view title) const;
+    std::vector<domain::BookData> ReadAuthorBooks(const std::string& author_id) const;
+    std::vector<std::pair<std::string, std::string>> ReadBookTags() const;
+    std::optional<domain::BookData> FindBook(const std::string& book_id) const;
+    std::optional<std::string> FindAuthorName(const std::string& author_id) const;
+    std::vector<std::string> ReadTagsOf(const std::string& book_id) const;
+
+private:
+    template <typename T>
+    T Load(std::size_t offset) const;
+    std::string_view LoadString(std::uint32_t offset, std::uint32_t size) const;
+    std::uint32_t LoadIndex(std::size_t section_offset, std::size_t position) const;
+    domain::BookData LoadBook(std::size_t index, bool with_author_name) const;
+    std::optional<std::size_t> FindBookIndex(const std::string& book_id) const;
+
+    const char* data_;
+    std::size_t size_;
+    std::uint32_t author_count_ = 0;
+    std::uint32_t book_count_ = 0;
+    std::uint32_t tag_count_ = 0;
+    std::size_t authors_offset_ = 0;
+    std::size_t books_offset_ = 0;
+    std::size_t tags_offset_ = 0;
+    std::size_t author_order_offset_ = 0;
+    std::size_t book_order_offset_ = 0;
+    std::size_t author_books_order_offset_ = 0;
+    std::size_t title_order_offset_ = 0;
+    std::size_t strings_offset_ = 0;
+};
+
+}  // namespace catalog
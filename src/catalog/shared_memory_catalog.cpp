@@ -0,0 +1,158 @@
+#include "shared_memory_catalog.h"
+
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace catalog {
+    namespace {
+        namespace ipc = boost::interprocess;
+
+        // Сколько раз читатель повторяет чтение, если во время копирования образ был перезаписан
+        constexpr int MAX_READ_ATTEMPTS = 3;
+
+        ipc::shared_memory_object OpenSegment(const std::string& name, std::size_t size_bytes) {
+            ipc::shared_memory_object segment{ipc::open_or_create, name.c_str(), ipc::read_write};
+            ipc::offset_t current_size = 0;
+            if (!segment.get_size(current_size) || static_cast<std::size_t>(current_size) < size_bytes) {
+                segment.truncate(static_cast<ipc::offset_t>(size_bytes));
+            }
+            return segment;
+        }
+
+        std::string LockFilePath(const std::string& name) {
+            auto path = std::filesystem::temp_directory_path() / (name + ".lock");
+            std::ofstream{path, std::ios::app};
+            return path.string();
+        }
+    }
+
+    // Память сегмента после truncate заполнена нулями - это корректное начальное состояние:
+    // образа нет (image_size == 0). Атомики lock-free и потому работают между процессами.
+    struct SharedMemoryCatalog::SegmentHeader {
+        std::atomic<std::uint64_t> sequence;            // нечётное - идёт запись образа
+        std::atomic<std::uint64_t> generation;          // увеличивается при каждом Invalidate
+        std::atomic<std::uint64_t> image_generation;    // generation, на момент которой загружен образ
+        std::atomic<std::uint64_t> image_size;
+    };
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+
+    SharedMemoryCatalog::SharedMemoryCatalog(const std::string &name, std::size_t size_bytes)
+        : segment_(OpenSegment(name, size_bytes)),
+          region_(segment_, ipc::read_write),
+          writer_lock_(LockFilePath(name).c_str()) {
+        if (region_.get_size() < sizeof(SegmentHeader)) {
+            throw std::invalid_argument("Shared catalog segment is too small");
+        }
+    }
+
+    std::optional<std::vector<std::pair<std::string, std::string>>> SharedMemoryCatalog::ReadAuthors() {
+        return Read([](const ImageView& image) {
+            return image.ReadAuthors();
+        });
+    }
+
+    std::optional<std::vector<domain::BookData>> SharedMemoryCatalog::ReadBooks() {
+        return Read([](const ImageView& image) {
+            return image.ReadBooks();
+        });
+    }
+
+    std::optional<std::vector<domain::BookData>> SharedMemoryCatalog::ReadAuthorBooks(const std::string &author_id) {
+        return Read([&author_id](const ImageView& image) {
+            return image.ReadAuthorBooks(author_id);
+        });
+    }
+
+    std::optional<std::pair<domain::BookData, std::vector<std::string>>>
+    SharedMemoryCatalog::ReadBook(const std::string &book_id) {
+        auto result = Read([&book_id](const ImageView& image) {
+            std::optional<std::pair<domain::BookData, std::vector<std::string>>> book;
+            if (auto data = image.FindBook(book_id)) {
+                book.emplace(std::move(*data), image.ReadTagsOf(book_id));
+            }
+            return book;
+        });
+        return result ? std::move(*result) : std::nullopt;
+    }
+
+    app::SharedCatalog::Generation SharedMemoryCatalog::GetGeneration() {
+        return Header().generation.load(std::memory_order_acquire);
+    }
+
+    bool SharedMemoryCatalog::Publish(Generation loaded_at,
+                                      const std::vector<std::pair<std::string, std::string>> &authors,
+                                      const std::vector<domain::BookData> &books,
+                                      const std::vector<std::pair<std::string, std::string>> &book_tags) {
+        auto image = BuildImage({authors, books, book_tags});
+        if (image.size() > GetImageCapacity()) {
+            return false;
+        }
+        ipc::scoped_lock<ipc::file_lock> lock{writer_lock_, ipc::try_to_lock};
+        if (!lock.owns()) {
+            return false;   // публикует другой процесс
+        }
+        auto& header = Header();
+        if (header.generation.load(std::memory_order_acquire) != loaded_at) {
+            return false;
+        }
+        // | 1 восстанавливает протокол, если предыдущий писатель завершился посреди записи
+        auto sequence = header.sequence.load(std::memory_order_relaxed) | 1;
+        header.sequence.store(sequence, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(Image(), image.data(), image.size());
+        header.image_size.store(image.size(), std::memory_order_relaxed);
+        header.image_generation.store(loaded_at, std::memory_order_relaxed);
+        header.sequence.store(sequence + 1, std::memory_order_release);
+        return true;
+    }
+
+    void SharedMemoryCatalog::Invalidate() {
+        Header().generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    template <typename Reader>
+    auto SharedMemoryCatalog::Read(Reader reader) -> std::optional<decltype(reader(std::declval<const ImageView&>()))> {
+        auto& header = Header();
+        for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+            auto sequence = header.sequence.load(std::memory_order_acquire);
+            if (sequence % 2 != 0) {
+                return std::nullopt;    // не ждём писателя, читаем из БД
+            }
+            auto generation = header.generation.load(std::memory_order_acquire);
+            auto image_size = header.image_size.load(std::memory_order_relaxed);
+            if (header.image_generation.load(std::memory_order_relaxed) != generation
+                || image_size == 0 || image_size > GetImageCapacity()) {
+                return std::nullopt;
+            }
+            std::optional<decltype(reader(std::declval<const ImageView&>()))> result;
+            try {
+                result = reader(ImageView{Image(), image_size});
+            } catch (const std::exception&) {
+                // образ перезаписывался во время чтения - проверим sequence и повторим
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header.sequence.load(std::memory_order_relaxed) == sequence && result) {
+                return result;
+            }
+        }
+        return std::nullopt;
+    }
+
+    SharedMemoryCatalog::SegmentHeader &SharedMemoryCatalog::Header() {
+        return *static_cast<SegmentHeader*>(region_.get_address());
+    }
+
+    char *SharedMemoryCatalog::Image() {
+        return static_cast<char*>(region_.get_address()) + sizeof(SegmentHeader);
+    }
+
+    std::size_t SharedMemoryCatalog::GetImageCapacity() const noexcept {
+        return region_.get_size() - sizeof(SegmentHeader);
+    }
+
+}  // namespace catalog
@@ -0,0 +1,53 @@
+#pragma once
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "../app/shared_catalog.h"
+#include "catalog_image.h"
+
+namespace catalog {
+
+/**
+ * SharedCatalog в разделяемой памяти (Boost.Interprocess).
+ * Сегмент: SegmentHeader и следом образ каталога (см. catalog_image.h).
+ * Читатели работают по протоколу seqlock: запоминают sequence, копируют данные и
+ * проверяют, что sequence не изменился. Писатели (Publish) исключают друг друга через
+ * file_lock, который ОС снимает при аварийном завершении процесса.
+ */
+class SharedMemoryCatalog : public app::SharedCatalog {
+public:
+    SharedMemoryCatalog(const std::string& name, std::size_t size_bytes);
+
+    std::optional<std::vector<std::pair<std::string, std::string>>> ReadAuthors() override;
+    std::optional<std::vector<domain::BookData>> ReadBooks() override;
+    std::optional<std::vector<domain::BookData>> ReadAuthorBooks(const std::string& author_id) override;
+    std::optional<std::pair<domain::BookData, std::vector<std::string>>> ReadBook(const std::string& book_id) override;
+
+    Generation GetGeneration() override;
+    bool Publish(Generation loaded_at,
+                 const std::vector<std::pair<std::string, std::string>>& authors,
+                 const std::vector<domain::BookData>& books,
+                 const std::vector<std::pair<std::string, std::string>>& book_tags) override;
+    void Invalidate() override;
+
+private:
+    struct SegmentHeader;
+
+    template <typename Reader>
+    auto Read(Reader reader) -> std::optional<decltype(reader(std::declval<const ImageView&>()))>;
+
+    SegmentHeader& Header();
+    char* Image();
+    std::size_t GetImageCapacity() const noexcept;
+
+    boost::interprocess::shared_memory_object segment_;
+    boost::interprocess::mapped_region region_;
+    boost::interprocess::file_lock writer_lock_;
+};
+
+}  // namespace catalog
@@ -0,0 +1,92 @@
+#include "snapshot_file.h"
+
+#include <boost/crc.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace catalog {
+    namespace {
+        namespace ipc = boost::interprocess;
+
+        constexpr char SNAPSHOT_MAGIC[8] = {'B', 'K', 'S', 'N', 'A', 'P', '\0', '\0'};
+        constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+        struct SnapshotHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t image_crc;
+            std::uint64_t image_size;
+        };
+        static_assert(sizeof(SnapshotHeader) % 8 == 0);
+
+        std::uint32_t Checksum(const char* data, std::size_t size) {
+            boost::crc_32_type crc;
+            crc.process_bytes(data, size);
+            return crc.checksum();
+        }
+    }
+
+    // Снимок пишется во временный файл и переименовывается, поэтому читатель
+    // никогда не видит недописанный файл
+    void WriteSnapshotFile(const std::filesystem::path &path, const CatalogData &data) {
+        auto image = BuildImage(data);
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.image_crc = Checksum(image.data(), image.size());
+        header.image_size = image.size();
+
+        auto temp_path = path;
+        temp_path += ".tmp";
+        {
+            std::ofstream out{temp_path, std::ios::binary | std::ios::trunc};
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(image.data(), static_cast<std::streamsize>(image.size()));
+            out.close();
+            if (!out) {
+                std::filesystem::remove(temp_path);
+                throw std::runtime_error("Failed to write catalog snapshot");
+            }
+        }
+        std::filesystem::rename(temp_path, path);
+    }
+
+    SnapshotFile::SnapshotFile(const std::filesystem::path &path)
+        : file_(path.c_str(), ipc::read_only),
+          region_(file_, ipc::read_only) {
+        const auto* data = static_cast<const char*>(region_.get_address());
+        SnapshotHeader header{};
+        if (region_.get_size() < sizeof(header)) {
+            throw std::runtime_error("Truncated catalog snapshot");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION) {
+            throw std::runtime_error("Unsupported catalog snapshot format");
+        }
+        if (header.image_size > region_.get_size() - sizeof(header)) {
+            throw std::runtime_error("Truncated catalog snapshot");
+        }
+        image_size_ = static_cast<std::size_t>(header.image_size);
+        image_crc_ = header.image_crc;
+        image_.emplace(data + sizeof(header), image_size_);
+    }
+
+    void SnapshotFile::Verify() const {
+        const auto* image = static_cast<const char*>(region_.get_address()) + sizeof(SnapshotHeader);
+        if (Checksum(image, image_size_) != image_crc_) {
+            throw std::runtime_error("Catalog snapshot checksum mismatch");
+        }
+    }
+
+    void SnapshotFileWriter::Write(const std::string &path,
+                                   const std::vector<std::pair<std::string, std::string>> &authors,
+                                   const std::vector<domain::BookData> &books,
+                                   const std::vector<std::pair<std::string, std::string>> &book_tags) {
+        WriteSnapshotFile(path, {authors, books, book_tags});
+    }
+
+}  // namespace catalog
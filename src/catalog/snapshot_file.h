@@ -0,0 +1,57 @@
+#pragma once
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../app/snapshot_writer.h"
+#include "catalog_image.h"
+
+namespace catalog {
+
+/**
+ * Файл снимка каталога: SnapshotHeader (сигнатура, версия формата, размер и CRC-32 образа)
+ * и следом образ каталога (см. catalog_image.h). Образ начинается со смещения, кратного 8,
+ * поэтому файл можно отобразить через mmap и читать на месте без копирования.
+ */
+void WriteSnapshotFile(const std::filesystem::path& path, const CatalogData& data);
+
+// Файл снимка, отображённый в память только для чтения. При открытии проверяются только
+// заголовок и размер, дальше чтение идёт прямо из отображения. Контрольная сумма всего образа
+// считается по требованию (Verify): повреждённый образ и без неё не читается за границами.
+class SnapshotFile {
+public:
+    explicit SnapshotFile(const std::filesystem::path& path);
+
+    // Бросает std::runtime_error, если CRC-32 образа не совпадает с записанной в заголовке
+    void Verify() const;
+
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    const ImageView& GetImage() const noexcept {
+        return *image_;
+    }
+
+private:
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    std::optional<ImageView> image_;
+    std::size_t image_size_ = 0;
+    std::uint32_t image_crc_ = 0;
+};
+
+class SnapshotFileWriter : public app::SnapshotWriter {
+public:
+    void Write(const std::string& path,
+               const std::vector<std::pair<std::string, std::string>>& authors,
+               const std::vector<domain::BookData>& books,
+               const std::vector<std::pair<std::string, std::string>>& book_tags) override;
+};
+
+}  // namespace catalog
@@ -0,0 +1,237 @@
+#include "snapshot_repositories.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "../util/text_match.h"
+
+namespace catalog {
+    namespace {
+        [[noreturn]] void ThrowReadOnly() {
+            throw std::logic_error("Catalog snapshot is read-only");
+        }
+
+        bool BookLess(const domain::BookData& lhs, const domain::BookData& rhs) {
+            return std::tie(lhs.title, lhs.author_name, lhs.year) < std::tie(rhs.title, rhs.author_name, rhs.year);
+        }
+
+        template <typename T>
+        std::vector<T> Page(std::vector<T> items, std::size_t limit, std::size_t offset) {
+            if (offset >= items.size()) {
+                return {};
+            }
+            items.erase(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(offset));
+            if (items.size() > limit) {
+                items.resize(limit);
+            }
+            return items;
+        }
+    }
+
+    void SnapshotAuthorRepository::Save(const domain::Author &) {
+        ThrowReadOnly();
+    }
+
+    std::vector<std::pair<std::string, std::string>> SnapshotAuthorRepository::Read() {
+        return image_.ReadAuthors();
+    }
+
+    std::optional<std::string> SnapshotAuthorRepository::ReadNameById(const std::string &id) {
+        return image_.FindAuthorName(id);
+    }
+
+    std::optional<std::string> SnapshotAuthorRepository::ReadIdByName(const std::string &name) {
+        for (auto& [id, author_name] : image_.ReadAuthors()) {
+            if (author_name == name) {
+                return std::move(id);
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<std::pair<std::string, std::string>> SnapshotAuthorRepository::FindSimilar(const std::string &name,
+                                                                                           double threshold,
+                                                                                           std::size_t limit) {
+        std::vector<std::pair<double, std::pair<std::string, std::string>>> similar;
+        for (auto& author : image_.ReadAuthors()) {
+            auto similarity = util::TrigramSimilarity(author.second, name);
+            if (similarity >= threshold) {
+                similar.emplace_back(similarity, std::move(author));
+            }
+        }
+        // Авторы уже упорядочены по имени - стабильная сортировка сохраняет этот порядок
+        std::stable_sort(similar.begin(), similar.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first > rhs.first;
+        });
+        std::vector<std::pair<std::string, std::string>> result;
+        for (std::size_t i = 0; i < similar.size() && i < limit; ++i) {
+            result.push_back(std::move(similar[i].second));
+        }
+        return result;
+    }
+
+    void SnapshotAuthorRepository::DeleteByName(const std::string &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotAuthorRepository::DeleteById(const std::string &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotAuthorRepository::EditByName(const std::string &, const std::string &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotAuthorRepository::EditById(const std::string &, const std::string &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotBookRepository::Save(const domain::Book &) {
+        ThrowReadOnly();
+    }
+
+    std::vector<domain::BookData> SnapshotBookRepository::Read() {
+        return image_.ReadBooks();
+    }
+
+    std::vector<domain::BookData> SnapshotBookRepository::ReadByName(const std::string &book_name) {
+        return image_.ReadBooksByTitle(book_name);
+    }
+
+    domain::BookData SnapshotBookRepository::ReadById(const std::string &book_id) {
+        if (auto book = image_.FindBook(book_id)) {
+            return std::move(*book);
+        }
+        throw std::out_of_range("Book not found");
+    }
+
+    std::vector<domain::BookData> SnapshotBookRepository::ReadAuthorBooks(const std::string &author_id) {
+        return image_.ReadAuthorBooks(author_id);
+    }
+
+    // Все слова запроса должны встретиться в названии, имени автора или тегах
+    std::vector<domain::RankedBook> SnapshotBookRepository::Search(const std::string &query, std::size_t limit,
+                                                                   std::size_t offset) {
+        auto query_words = util::SplitWords(query);
+        if (query_words.empty()) {
+            return {};
+        }
+        std::vector<domain::RankedBook> found;
+        for (auto& book : image_.ReadBooks()) {
+            // Как в bookypedia_book_document: название (A), автор (B), теги (C)
+            std::vector<util::WeightedWords> fields{{util::SplitWords(book.title), util::WEIGHT_A},
+                                                    {util::SplitWords(book.author_name), util::WEIGHT_B},
+                                                    {{}, util::WEIGHT_C}};
+            for (const auto& tag : image_.ReadTagsOf(book.id)) {
+                auto words = util::SplitWords(tag);
+                fields.back().words.insert(fields.back().words.end(), words.begin(), words.end());
+            }
+            if (auto rank = util::RankDocument(query_words, fields)) {
+                found.push_back({*rank, std::move(book)});
+            }
+        }
+        std::sort(found.begin(), found.end(), [](const auto& lhs, const auto& rhs) {
+            if (lhs.rank != rhs.rank) {
+                return lhs.rank > rhs.rank;
+            }
+            return BookLess(lhs.data, rhs.data);
+        });
+        return Page(std::move(found), limit, offset);
+    }
+
+    std::vector<domain::BookData> SnapshotBookRepository::FindSimilar(const std::string &title, double threshold,
+                                                                      std::size_t limit) {
+        std::vector<std::pair<double, domain::BookData>> similar;
+        for (auto& book : image_.ReadBooks()) {
+            auto similarity = util::TrigramSimilarity(book.title, title);
+            if (similarity >= threshold) {
+                similar.emplace_back(similarity, std::move(book));
+            }
+        }
+        std::stable_sort(similar.begin(), similar.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first > rhs.first;
+        });
+        std::vector<domain::BookData> result;
+        for (std::size_t i = 0; i < similar.size() && i < limit; ++i) {
+            result.push_back(std::move(similar[i].second));
+        }
+        return result;
+    }
+
+    std::vector<domain::BookData> SnapshotBookRepository::ReadByYearRange(int from, int to, std::size_t limit,
+                                                                          std::size_t offset) {
+        std::vector<domain::BookData> books;
+        for (auto& book : image_.ReadBooks()) {
+            if (book.year >= from && book.year <= to) {
+                books.push_back(std::move(book));
+            }
+        }
+        std::sort(books.begin(), books.end(), [](const domain::BookData& lhs, const domain::BookData& rhs) {
+            return std::tie(lhs.year, lhs.title, lhs.author_name, lhs.id)
+                   < std::tie(rhs.year, rhs.title, rhs.author_name, rhs.id);
+        });
+        return Page(std::move(books), limit, offset);
+    }
+
+    void SnapshotBookRepository::DeleteByName(const std::string &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotBookRepository::DeleteById(const std::string &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotBookRepository::EditTitleById(const std::string &, const std::string &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotBookRepository::EditYearById(const std::string &, int) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotBookRepository::Patch(const std::string &, const std::optional<std::string> &,
+                                       const std::optional<int> &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotBookTagsRepository::Save(const domain::BookTags &) {
+        ThrowReadOnly();
+    }
+
+    std::vector<std::pair<std::string, std::string>> SnapshotBookTagsRepository::Read() {
+        return image_.ReadBookTags();
+    }
+
+    std::vector<std::string> SnapshotBookTagsRepository::ReadById(const std::string &book_id) {
+        auto tags = image_.ReadTagsOf(book_id);
+        std::sort(tags.begin(), tags.end());
+        return tags;
+    }
+
+    void SnapshotBookTagsRepository::Update(const domain::BookTags &) {
+        ThrowReadOnly();
+    }
+
+    void SnapshotBookTagsRepository::DeleteById(const std::string &) {
+        ThrowReadOnly();
+    }
+
+    std::vector<std::pair<std::string, std::size_t>> SnapshotBookTagsRepository::ReadTopTags(std::size_t top_k) {
+        std::map<std::string, std::size_t> counts;
+        for (const auto& [book_id, tag] : image_.ReadBookTags()) {
+            ++counts[tag];
+        }
+        std::vector<std::pair<std::string, std::size_t>> tags{counts.begin(), counts.end()};
+        std::stable_sort(tags.begin(), tags.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second > rhs.second;
+        });
+        if (tags.size() > top_k) {
+            tags.resize(top_k);
+        }
+        return tags;
+    }
+
+}  // namespace catalog
@@ -0,0 +1,124 @@
+#pragma once
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../app/unit_of_work.h"
+#include "../domain/author.h"
+#include "../domain/book.h"
+#include "catalog_image.h"
+
+namespace catalog {
+
+/**
+ * Репозитории, читающие прямо из образа каталога (например, из отображённого файла снимка).
+ * Только для чтения: любая запись бросает std::logic_error. Поиск, похожие названия и
+ * популярные теги считаются перебором образа и повторяют порядок результатов реализации на БД.
+ */
+class SnapshotAuthorRepository : public domain::AuthorRepository {
+public:
+    explicit SnapshotAuthorRepository(const ImageView& image)
+        : image_{image} {
+    }
+
+    void Save(const domain::Author& author) override;
+    std::vector<std::pair<std::string, std::string>> Read() override;
+    std::optional<std::string> ReadNameById(const std::string& id) override;
+    std::optional<std::string> ReadIdByName(const std::string& name) override;
+    std::vector<std::pair<std::string, std::string>> FindSimilar(const std::string& name, double threshold,
+                                                                 std::size_t limit) override;
+    void DeleteByName(const std::string& author_name) override;
+    void DeleteById(const std::string& author_id) override;
+    void EditByName(const std::string& old_name, const std::string& new_name) override;
+    void EditById(const std::string& id, const std::string& new_name) override;
+
+private:
+    const ImageView& image_;
+};
+
+class SnapshotBookRepository : public domain::BookRepository {
+public:
+    explicit SnapshotBookRepository(const ImageView& image)
+        : image_{image} {
+    }
+
+    void Save(const domain::Book& book) override;
+    std::vector<domain::BookData> Read() override;
+    std::vector<domain::BookData> ReadByName(const std::string& book_name) override;
+    domain::BookData ReadById(const std::string& book_id) override;
+    std::vector<domain::BookData> ReadAuthorBooks(const std::string& author_id) override;
+    std::vector<domain::RankedBook> Search(const std::string& query, std::size_t limit, std::size_t offset) override;
+    std::vector<domain::BookData> FindSimilar(const std::string& title, double threshold, std::size_t limit) override;
+    std::vector<domain::BookData> ReadByYearRange(int from, int to, std::size_t limit, std::size_t offset) override;
+
+    void DeleteByName(const std::string& book_name) override;
+    void DeleteById(const std::string& book_id) override;
+
+    void EditTitleById(const std::string& id, const std::string& new_name) override;
+    void EditYearById(const std::string& id, int new_year) override;
+    void Patch(const std::string& id, const std::optional<std::string>& new_title,
+               const std::optional<int>& new_year) override;
+
+private:
+    const ImageView& image_;
+};
+
+class SnapshotBookTagsRepository : public domain::BookTagsRepository {
+public:
+    explicit SnapshotBookTagsRepository(const ImageView& image)
+        : image_{image} {
+    }
+
+    void Save(const domain::BookTags& book_tags) override;
+    std::vector<std::pair<std::string, std::string>> Read() override;
+    std::vector<std::string> ReadById(const std::string& book_id) override;
+    void Update(const domain::BookTags& book_tags) override;
+    void DeleteById(const std::string& book_id) override;
+    std::vector<std::pair<std::string, std::size_t>> ReadTopTags(std::size_t top_k) override;
+
+private:
+    const ImageView& image_;
+};
+
+class SnapshotUnitOfWork : public app::UnitOfWork {
+public:
+    explicit SnapshotUnitOfWork(const ImageView& image)
+        : authors_{image}, books_{image}, book_tags_{image} {
+    }
+
+    domain::AuthorRepository* Author() override {
+        return &authors_;
+    }
+    domain::BookRepository* Book() override {
+        return &books_;
+    }
+    domain::BookTagsRepository* BookTags() override {
+        return &book_tags_;
+    }
+    // Изменений не бывает - фиксировать нечего
+    void Commit() override {
+    }
+
+private:
+    SnapshotAuthorRepository authors_;
+    SnapshotBookRepository books_;
+    SnapshotBookTagsRepository book_tags_;
+};
+
+class SnapshotUnitOfWorkFactory : public app::UnitOfWorkFactory {
+public:
+    explicit SnapshotUnitOfWorkFactory(const ImageView& image)
+        : image_{image} {
+    }
+
+    // Снимок неизменяем, поэтому любой unit of work видит согласованные данные
+    std::unique_ptr<app::UnitOfWork> CreateUnitOfWork(const app::UnitOfWorkOptions& = {}) override {
+        return std::make_unique<SnapshotUnitOfWork>(image_);
+    }
+
+private:
+    const ImageView& image_;
+};
+
+}  // namespace catalog
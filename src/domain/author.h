@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -36,6 +38,13 @@ class AuthorRepository {
 public:
     virtual void Save(const Author& author) = 0;
     virtual std::vector<std::pair<std::string, std::string>> Read() = 0;
+    // Имя автора с данным id; nullopt - такого автора нет
+    virtual std::optional<std::string> ReadNameById(const std::string& id) = 0;
+    // Id автора с данным именем; nullopt - такого автора нет
+    virtual std::optional<std::string> ReadIdByName(const std::string& name) = 0;
+    // Не более limit авторов с похожим именем (триграммы), по убыванию сходства
+    virtual std::vector<std::pair<std::string, std::string>> FindSimilar(const std::string& name, double threshold,
+                                                                         std::size_t limit) = 0;
     virtual void DeleteByName(const std::string& name) = 0;
     virtual void DeleteById(const std::string& id) = 0;
     virtual void EditByName(const std::string& old_name, const std::string& new_name) = 0;
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -53,6 +55,13 @@ namespace domain {
         int year = 0;
     };
 
+    // Книга из полнотекстового поиска. Ранг зависит только от запроса и документа книги, поэтому
+    // ранги разных хранилищ одного вида сравнимы
+    struct RankedBook {
+        double rank = 0;
+        BookData data;
+    };
+
     class BookRepository {
     public:
         virtual void Save(const Book& book) = 0;
@@ -60,12 +69,22 @@ namespace domain {
         virtual std::vector<domain::BookData> ReadByName(const std::string& book_name) = 0;
         virtual domain::BookData ReadById(const std::string& book_id) = 0;
         virtual std::vector<domain::BookData> ReadAuthorBooks(const std::string& author_id) = 0;
+        // Полнотекстовый поиск по названию, имени автора и тегам: по убыванию ранга, затем по названию,
+        // имени автора и году
+        virtual std::vector<domain::RankedBook> Search(const std::string& query, std::size_t limit, std::size_t offset) = 0;
+        // Книги с годом издания в [from, to] по году и названию
+        virtual std::vector<domain::BookData> ReadByYearRange(int from, int to, std::size_t limit, std::size_t offset) = 0;
+        // Не более limit книг с похожим названием (триграммы), по убыванию сходства
+        virtual std::vector<domain::BookData> FindSimilar(const std::string& title, double threshold, std::size_t limit) = 0;
 
         virtual void DeleteByName(const std::string& book_name ) = 0;
         virtual void DeleteById(const std::string& book_id ) = 0;
 
         virtual void EditTitleById(const std::string& id, const std::string& new_name) = 0;
         virtual void EditYearById(const std::string& id, int new_year) = 0;
+        // Меняет заданные поля одним запросом; книги нет - исключение, как у EditTitleById
+        virtual void Patch(const std::string& id, const std::optional<std::string>& new_title,
+                           const std::optional<int>& new_year) = 0;
 
 
     protected:
@@ -98,6 +117,8 @@ namespace domain {
         virtual std::vector<std::string> ReadById(const std::string& book_id) = 0;
         virtual void Update(const BookTags& book_tags) = 0;
         virtual void DeleteById(const std::string& book_id) = 0;
+        // Не более top_k тегов с наибольшим числом книг: тег, число книг
+        virtual std::vector<std::pair<std::string, std::size_t>> ReadTopTags(std::size_t top_k) = 0;
 
     protected:
         ~BookTagsRepository() = default;
@@ -0,0 +1,664 @@
+#include "memory_database.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "../util/text_match.h"
+
+namespace memory {
+    namespace {
+        domain::BookData ToBookData(const std::string& id, const BookRow& row, const AuthorTable& authors) {
+            auto author = authors.names.find(row.author_id);
+            return {id, row.author_id, author != authors.names.end() ? author->second : std::string{},
+                    row.title, row.year};
+        }
+
+        // ORDER BY title, authors.name, publication_year
+        bool BookLess(const domain::BookData& lhs, const domain::BookData& rhs) {
+            return std::tie(lhs.title, lhs.author_name, lhs.year, lhs.id)
+                   < std::tie(rhs.title, rhs.author_name, rhs.year, rhs.id);
+        }
+
+        template <typename T>
+        std::vector<T> Page(std::vector<T> items, std::size_t limit, std::size_t offset) {
+            if (offset >= items.size()) {
+                return {};
+            }
+            items.erase(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(offset));
+            if (items.size() > limit) {
+                items.resize(limit);
+            }
+            return items;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    //===============Tables==================================
+    void BookTable::Insert(const std::string &id, BookRow row) {
+        by_title.emplace(row.title, id);
+        by_author.emplace(row.author_id, row.year, row.title, id);
+        by_year.emplace(row.year, row.title, id);
+        rows.emplace(id, std::move(row));
+    }
+
+    void BookTable::Erase(const std::string &id) {
+        auto it = rows.find(id);
+        if (it == rows.end()) {
+            return;
+        }
+        const auto& row = it->second;
+        by_title.erase({row.title, id});
+        by_author.erase({row.author_id, row.year, row.title, id});
+        by_year.erase({row.year, row.title, id});
+        rows.erase(it);
+    }
+
+    void BookTagTable::Add(const std::string &book_id, const std::vector<std::string> &new_tags) {
+        auto& book_tags = tags[book_id];
+        for (const auto& tag : new_tags) {
+            auto it = std::lower_bound(book_tags.begin(), book_tags.end(), tag);
+            if (it == book_tags.end() || *it != tag) {
+                book_tags.insert(it, tag);
+                ++book_counts[tag];
+            }
+        }
+        if (book_tags.empty()) {
+            tags.erase(book_id);
+        }
+    }
+
+    void BookTagTable::Erase(const std::string &book_id) {
+        auto it = tags.find(book_id);
+        if (it == tags.end()) {
+            return;
+        }
+        for (const auto& tag : it->second) {
+            if (auto count = book_counts.find(tag); count != book_counts.end() && --count->second == 0) {
+                book_counts.erase(count);
+            }
+        }
+        tags.erase(it);
+    }
+
+    //------------------------------------------------------------------------
+    //===============Database==================================
+    Database::Database()
+        : tables_{std::make_shared<AuthorTable>(), std::make_shared<BookTable>(), std::make_shared<BookTagTable>()} {
+    }
+
+    Database::Tables Database::GetTables() const {
+        std::lock_guard lock{tables_mutex_};
+        return tables_;
+    }
+
+    std::unique_lock<std::mutex> Database::LockWriter() {
+        return std::unique_lock{writer_mutex_};
+    }
+
+    void Database::Publish(Tables tables) {
+        std::lock_guard lock{tables_mutex_};
+        tables_ = std::move(tables);
+    }
+
+    //------------------------------------------------------------------------
+    //===============Transaction==================================
+    std::shared_ptr<const AuthorTable> Transaction::Authors() const {
+        return authors_ ? authors_ : GetCommitted().authors;
+    }
+
+    std::shared_ptr<const BookTable> Transaction::Books() const {
+        return books_ ? books_ : GetCommitted().books;
+    }
+
+    std::shared_ptr<const BookTagTable> Transaction::BookTags() const {
+        return book_tags_ ? book_tags_ : GetCommitted().book_tags;
+    }
+
+    // Как в Postgres: после ошибки транзакция не выполняет запросов до отката
+    Database::Tables Transaction::GetCommitted() const {
+        if (failed_) {
+            throw std::logic_error("Transaction is aborted");
+        }
+        if (!read_only_) {
+            return database_.GetTables();
+        }
+        if (!snapshot_) {
+            snapshot_ = database_.GetTables();
+        }
+        return *snapshot_;
+    }
+
+    AuthorTable &Transaction::MutableAuthors() {
+        BeginWrite();
+        if (!authors_) {
+            authors_ = std::make_shared<AuthorTable>(*database_.GetTables().authors);
+        }
+        return *authors_;
+    }
+
+    BookTable &Transaction::MutableBooks() {
+        BeginWrite();
+        if (!books_) {
+            books_ = std::make_shared<BookTable>(*database_.GetTables().books);
+        }
+        return *books_;
+    }
+
+    BookTagTable &Transaction::MutableBookTags() {
+        BeginWrite();
+        if (!book_tags_) {
+            book_tags_ = std::make_shared<BookTagTable>(*database_.GetTables().book_tags);
+        }
+        return *book_tags_;
+    }
+
+    void Transaction::Fail(const std::string &message) {
+        failed_ = true;
+        throw std::logic_error(message);
+    }
+
+    void Transaction::Commit() {
+        if (writer_lock_ && !failed_) {
+            auto tables = database_.GetTables();
+            if (authors_) {
+                tables.authors = std::move(authors_);
+            }
+            if (books_) {
+                tables.books = std::move(books_);
+            }
+            if (book_tags_) {
+                tables.book_tags = std::move(book_tags_);
+            }
+            database_.Publish(std::move(tables));
+        }
+        Reset();
+    }
+
+    // Копии таблиц снимаются под блокировкой писателя, поэтому между копированием и
+    // публикацией закоммиченные таблицы не меняются
+    void Transaction::BeginWrite() {
+        if (read_only_) {
+            Fail("Read-only transaction");
+        }
+        if (failed_) {
+            throw std::logic_error("Transaction is aborted");
+        }
+        if (!writer_lock_) {
+            writer_lock_ = database_.LockWriter();
+        }
+    }
+
+    void Transaction::Reset() {
+        authors_.reset();
+        books_.reset();
+        book_tags_.reset();
+        snapshot_.reset();
+        failed_ = false;
+        if (writer_lock_) {
+            writer_lock_.unlock();
+        }
+    }
+
+    //------------------------------------------------------------------------
+    //===============AuthorRepositoryImpl==================================
+    void AuthorRepositoryImpl::Save(const domain::Author &author) {
+        auto id = author.GetId().ToString();
+        auto& authors = transaction_.MutableAuthors();
+        if (auto it = authors.ids.find(author.GetName()); it != authors.ids.end() && it->second != id) {
+            transaction_.Fail("Author name already exists");
+        }
+        // INSERT ... ON CONFLICT (id) DO UPDATE SET name
+        if (auto it = authors.names.find(id); it != authors.names.end()) {
+            authors.ids.erase(it->second);
+            it->second = author.GetName();
+        } else {
+            authors.names.emplace(id, author.GetName());
+        }
+        authors.ids.emplace(author.GetName(), id);
+    }
+
+    std::vector<std::pair<std::string, std::string>> AuthorRepositoryImpl::Read() {
+        auto authors = transaction_.Authors();
+        std::vector<std::pair<std::string, std::string>> result;
+        result.reserve(authors->ids.size());
+        for (const auto& [name, id] : authors->ids) {
+            result.emplace_back(id, name);
+        }
+        return result;
+    }
+
+    std::optional<std::string> AuthorRepositoryImpl::ReadNameById(const std::string &id) {
+        auto authors = transaction_.Authors();
+        if (auto it = authors->names.find(id); it != authors->names.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<std::string> AuthorRepositoryImpl::ReadIdByName(const std::string &name) {
+        auto authors = transaction_.Authors();
+        if (auto it = authors->ids.find(name); it != authors->ids.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    std::vector<std::pair<std::string, std::string>> AuthorRepositoryImpl::FindSimilar(const std::string &name,
+                                                                                       double threshold,
+                                                                                       std::size_t limit) {
+        std::vector<std::pair<double, std::pair<std::string, std::string>>> similar;
+        for (auto& author : Read()) {
+            auto similarity = util::TrigramSimilarity(author.second, name);
+            if (similarity >= threshold) {
+                similar.emplace_back(similarity, std::move(author));
+            }
+        }
+        // ORDER BY similarity DESC, name: авторы уже упорядочены по имени
+        std::stable_sort(similar.begin(), similar.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first > rhs.first;
+        });
+        std::vector<std::pair<std::string, std::string>> result;
+        for (std::size_t i = 0; i < similar.size() && i < limit; ++i) {
+            result.push_back(std::move(similar[i].second));
+        }
+        return result;
+    }
+
+    void AuthorRepositoryImpl::DeleteByName(const std::string &author_name) {
+        auto authors = transaction_.Authors();
+        auto it = authors->ids.find(author_name);
+        if (it == authors->ids.end()) {
+            transaction_.Fail("Author not found");
+        }
+        Delete(it->second);
+    }
+
+    void AuthorRepositoryImpl::DeleteById(const std::string &author_id) {
+        if (transaction_.Authors()->names.count(author_id) == 0) {
+            transaction_.Fail("Author not found");
+        }
+        Delete(author_id);
+    }
+
+    void AuthorRepositoryImpl::EditByName(const std::string &old_name, const std::string &new_name) {
+        auto authors = transaction_.Authors();
+        auto it = authors->ids.find(old_name);
+        if (it == authors->ids.end()) {
+            transaction_.Fail("Author not found");
+        }
+        Rename(it->second, new_name);
+    }
+
+    void AuthorRepositoryImpl::EditById(const std::string &id, const std::string &new_name) {
+        if (transaction_.Authors()->names.count(id) == 0) {
+            transaction_.Fail("Author not found");
+        }
+        Rename(id, new_name);
+    }
+
+    // Книги автора удаляются вместе с их тегами, как в AuthorRepository на Postgres
+    void AuthorRepositoryImpl::Delete(std::string author_id) {
+        auto books = transaction_.Books();
+        auto begin = books->by_author.lower_bound({author_id, std::numeric_limits<int>::min(), {}, {}});
+        std::vector<std::string> book_ids;
+        for (auto it = begin; it != books->by_author.end() && std::get<0>(*it) == author_id; ++it) {
+            book_ids.push_back(std::get<3>(*it));
+        }
+        if (!book_ids.empty()) {
+            auto& book_tags = transaction_.MutableBookTags();
+            auto& mutable_books = transaction_.MutableBooks();
+            for (const auto& book_id : book_ids) {
+                book_tags.Erase(book_id);
+                mutable_books.Erase(book_id);
+            }
+        }
+        auto& authors = transaction_.MutableAuthors();
+        if (auto it = authors.names.find(author_id); it != authors.names.end()) {
+            authors.ids.erase(it->second);
+            authors.names.erase(it);
+        }
+    }
+
+    void AuthorRepositoryImpl::Rename(std::string author_id, const std::string &new_name) {
+        auto& authors = transaction_.MutableAuthors();
+        if (auto it = authors.ids.find(new_name); it != authors.ids.end() && it->second != author_id) {
+            transaction_.Fail("Author name already exists");
+        }
+        auto& name = authors.names.at(author_id);
+        authors.ids.erase(name);
+        name = new_name;
+        authors.ids.emplace(new_name, author_id);
+    }
+
+    //------------------------------------------------------------------------
+    //===============BookRepositoryImpl==================================
+    void BookRepositoryImpl::Save(const domain::Book &book) {
+        auto id = book.GetId().ToString();
+        if (transaction_.Authors()->names.count(book.GetAuthorId()) == 0) {
+            transaction_.Fail("Author not found");
+        }
+        auto& books = transaction_.MutableBooks();
+        if (books.rows.count(id) != 0) {
+            transaction_.Fail("Book already exists");
+        }
+        books.Insert(id, {book.GetAuthorId(), book.GetTitle(), book.GetYear()});
+    }
+
+    std::vector<domain::BookData> BookRepositoryImpl::Read() {
+        auto authors = transaction_.Authors();
+        auto books = transaction_.Books();
+        std::vector<domain::BookData> result;
+        result.reserve(books->rows.size());
+        for (const auto& [title, id] : books->by_title) {
+            result.push_back(ToBookData(id, books->rows.at(id), *authors));
+        }
+        // Уже упорядочены по названию - досортировка затрагивает только книги с одинаковым названием
+        std::sort(result.begin(), result.end(), BookLess);
+        return result;
+    }
+
+    std::vector<domain::BookData> BookRepositoryImpl::ReadByName(const std::string &book_name) {
+        auto authors = transaction_.Authors();
+        auto books = transaction_.Books();
+        std::vector<domain::BookData> result;
+        for (auto it = books->by_title.lower_bound({book_name, {}});
+             it != books->by_title.end() && it->first == book_name; ++it) {
+            result.push_back(ToBookData(it->second, books->rows.at(it->second), *authors));
+        }
+        std::sort(result.begin(), result.end(), BookLess);
+        return result;
+    }
+
+    // Как и реализация на Postgres, для отсутствующей книги возвращает пустые данные
+    domain::BookData BookRepositoryImpl::ReadById(const std::string &book_id) {
+        auto books = transaction_.Books();
+        auto it = books->rows.find(book_id);
+        if (it == books->rows.end()) {
+            return {};
+        }
+        return ToBookData(book_id, it->second, *transaction_.Authors());
+    }
+
+    // ORDER BY publication_year, title; author_name не заполняется
+    std::vector<domain::BookData> BookRepositoryImpl::ReadAuthorBooks(const std::string &author_id) {
+        auto books = transaction_.Books();
+        std::vector<domain::BookData> result;
+        for (auto it = books->by_author.lower_bound({author_id, std::numeric_limits<int>::min(), {}, {}});
+             it != books->by_author.end() && std::get<0>(*it) == author_id; ++it) {
+            const auto& [book_author_id, year, title, id] = *it;
+            result.push_back({id, book_author_id, {}, title, year});
+        }
+        return result;
+    }
+
+    std::vector<domain::RankedBook> BookRepositoryImpl::Search(const std::string &query, std::size_t limit,
+                                                               std::size_t offset) {
+        auto query_words = util::SplitWords(query);
+        if (query_words.empty()) {
+            return {};
+        }
+        auto book_tags = transaction_.BookTags();
+        std::vector<domain::RankedBook> found;
+        for (auto& book : Read()) {
+            // Как в bookypedia_book_document: название (A), автор (B), теги (C)
+            std::vector<util::WeightedWords> fields{{util::SplitWords(book.title), util::WEIGHT_A},
+                                                    {util::SplitWords(book.author_name), util::WEIGHT_B},
+                                                    {{}, util::WEIGHT_C}};
+            if (auto tags = book_tags->tags.find(book.id); tags != book_tags->tags.end()) {
+                for (const auto& tag : tags->second) {
+                    auto words = util::SplitWords(tag);
+                    fields.back().words.insert(fields.back().words.end(), words.begin(), words.end());
+                }
+            }
+            if (auto rank = util::RankDocument(query_words, fields)) {
+                found.push_back({*rank, std::move(book)});
+            }
+        }
+        // Книги уже в порядке title, authors.name, publication_year
+        std::stable_sort(found.begin(), found.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.rank > rhs.rank;
+        });
+        return Page(std::move(found), limit, offset);
+    }
+
+    std::vector<domain::BookData> BookRepositoryImpl::FindSimilar(const std::string &title, double threshold,
+                                                                  std::size_t limit) {
+        std::vector<std::pair<double, domain::BookData>> similar;
+        for (auto& book : Read()) {
+            auto similarity = util::TrigramSimilarity(book.title, title);
+            if (similarity >= threshold) {
+                similar.emplace_back(similarity, std::move(book));
+            }
+        }
+        std::stable_sort(similar.begin(), similar.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first > rhs.first;
+        });
+        std::vector<domain::BookData> result;
+        for (std::size_t i = 0; i < similar.size() && i < limit; ++i) {
+            result.push_back(std::move(similar[i].second));
+        }
+        return result;
+    }
+
+    // ORDER BY publication_year, title, authors.name, books.id
+    std::vector<domain::BookData> BookRepositoryImpl::ReadByYearRange(int from, int to, std::size_t limit,
+                                                                      std::size_t offset) {
+        auto authors = transaction_.Authors();
+        auto books = transaction_.Books();
+        std::vector<domain::BookData> result;
+        for (auto it = books->by_year.lower_bound({from, {}, {}});
+             it != books->by_year.end() && std::get<0>(*it) <= to; ++it) {
+            const auto& id = std::get<2>(*it);
+            result.push_back(ToBookData(id, books->rows.at(id), *authors));
+        }
+        std::sort(result.begin(), result.end(), [](const domain::BookData& lhs, const domain::BookData& rhs) {
+            return std::tie(lhs.year, lhs.title, lhs.author_name, lhs.id)
+                   < std::tie(rhs.year, rhs.title, rhs.author_name, rhs.id);
+        });
+        return Page(std::move(result), limit, offset);
+    }
+
+    void BookRepositoryImpl::DeleteByName(const std::string &book_name) {
+        auto books = transaction_.Books();
+        std::vector<std::string> book_ids;
+        for (auto it = books->by_title.lower_bound({book_name, {}});
+             it != books->by_title.end() && it->first == book_name; ++it) {
+            book_ids.push_back(it->second);
+        }
+        Delete(book_ids);
+    }
+
+    void BookRepositoryImpl::DeleteById(const std::string &book_id) {
+        if (transaction_.Books()->rows.count(book_id) != 0) {
+            Delete({book_id});
+        }
+    }
+
+    void BookRepositoryImpl::EditTitleById(const std::string &id, const std::string &new_name) {
+        auto& books = transaction_.MutableBooks();
+        auto it = books.rows.find(id);
+        if (it == books.rows.end()) {
+            transaction_.Fail("Book not found");
+        }
+        auto row = it->second;
+        row.title = new_name;
+        books.Erase(id);
+        books.Insert(id, std::move(row));
+    }
+
+    void BookRepositoryImpl::EditYearById(const std::string &id, int new_year) {
+        auto& books = transaction_.MutableBooks();
+        auto it = books.rows.find(id);
+        if (it == books.rows.end()) {
+            transaction_.Fail("Book not found");
+        }
+        auto row = it->second;
+        row.year = new_year;
+        books.Erase(id);
+        books.Insert(id, std::move(row));
+    }
+
+    void BookRepositoryImpl::Patch(const std::string &id, const std::optional<std::string> &new_title,
+                                   const std::optional<int> &new_year) {
+        auto& books = transaction_.MutableBooks();
+        auto it = books.rows.find(id);
+        if (it == books.rows.end()) {
+            transaction_.Fail("Book not found");
+        }
+        auto row = it->second;
+        row.title = new_title.value_or(row.title);
+        row.year = new_year.value_or(row.year);
+        books.Erase(id);
+        books.Insert(id, std::move(row));
+    }
+
+    // book_tags ссылается на books без ON DELETE CASCADE: книгу с тегами удалить нельзя
+    void BookRepositoryImpl::Delete(const std::vector<std::string> &book_ids) {
+        if (book_ids.empty()) {
+            return;
+        }
+        auto book_tags = transaction_.BookTags();
+        for (const auto& book_id : book_ids) {
+            if (book_tags->tags.count(book_id) != 0) {
+                transaction_.Fail("Book has tags");
+            }
+        }
+        auto& books = transaction_.MutableBooks();
+        for (const auto& book_id : book_ids) {
+            books.Erase(book_id);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    //===============BookTagsRepositoryImpl==================================
+    void BookTagsRepositoryImpl::Save(const domain::BookTags &book_tags) {
+        if (book_tags.GetTags().empty()) {
+            return;
+        }
+        if (transaction_.Books()->rows.count(book_tags.GetBookId()) == 0) {
+            transaction_.Fail("Book not found");
+        }
+        transaction_.MutableBookTags().Add(book_tags.GetBookId(), book_tags.GetTags());
+    }
+
+    std::vector<std::pair<std::string, std::string>> BookTagsRepositoryImpl::Read() {
+        auto book_tags = transaction_.BookTags();
+        std::vector<std::pair<std::string, std::string>> result;
+        for (const auto& [book_id, tags] : book_tags->tags) {
+            for (const auto& tag : tags) {
+                result.emplace_back(book_id, tag);
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::string> BookTagsRepositoryImpl::ReadById(const std::string &book_id) {
+        auto book_tags = transaction_.BookTags();
+        if (auto it = book_tags->tags.find(book_id); it != book_tags->tags.end()) {
+            return it->second;
+        }
+        return {};
+    }
+
+    void BookTagsRepositoryImpl::Update(const domain::BookTags &book_tags) {
+        DeleteById(book_tags.GetBookId());
+        Save(book_tags);
+    }
+
+    void BookTagsRepositoryImpl::DeleteById(const std::string &book_id) {
+        if (transaction_.BookTags()->tags.count(book_id) != 0) {
+            transaction_.MutableBookTags().Erase(book_id);
+        }
+    }
+
+    // ORDER BY book_count DESC, tags.name
+    std::vector<std::pair<std::string, std::size_t>> BookTagsRepositoryImpl::ReadTopTags(std::size_t top_k) {
+        auto book_tags = transaction_.BookTags();
+        std::vector<std::pair<std::string, std::size_t>> result{book_tags->book_counts.begin(),
+                                                                 book_tags->book_counts.end()};
+        std::stable_sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second > rhs.second;
+        });
+        if (result.size() > top_k) {
+            result.resize(top_k);
+        }
+        return result;
+    }
+
+    //------------------------------------------------------------------------
+    //===============CatalogImporterImpl==================================
+    app::ImportStats CatalogImporterImpl::ImportBatch(const std::vector<app::ImportRecord> &records,
+                                                      app::Durability) {
+        app::ImportStats stats;
+        Transaction transaction{database_};
+        auto& authors = transaction.MutableAuthors();
+        auto& books = transaction.MutableBooks();
+        auto& book_tags = transaction.MutableBookTags();
+        for (const auto& record : records) {
+            auto author = authors.ids.find(record.author_name);
+            if (author == authors.ids.end()) {
+                auto author_id = domain::AuthorId::New().ToString();
+                authors.names.emplace(author_id, record.author_name);
+                author = authors.ids.emplace(record.author_name, author_id).first;
+                ++stats.authors;
+            }
+            const auto& author_id = author->second;
+            std::string book_id;
+            auto existing = books.by_author.lower_bound({author_id, record.year, record.title, {}});
+            if (existing != books.by_author.end() && std::get<0>(*existing) == author_id
+                && std::get<1>(*existing) == record.year && std::get<2>(*existing) == record.title) {
+                book_id = std::get<3>(*existing);
+            } else {
+                book_id = domain::BookId::New().ToString();
+                books.Insert(book_id, {author_id, record.title, record.year});
+                ++stats.books;
+            }
+            if (!record.tags.empty()) {
+                auto before = book_tags.tags.count(book_id) != 0 ? book_tags.tags.at(book_id).size() : 0;
+                book_tags.Add(book_id, record.tags);
+                stats.book_tags += book_tags.tags.at(book_id).size() - before;
+            }
+        }
+        transaction.Commit();
+        return stats;
+    }
+
+    //------------------------------------------------------------------------
+    //===============CatalogExporterImpl==================================
+    void CatalogExporterImpl::Export(app::ExportWriter &writer) {
+        auto tables = database_.GetTables();
+        const auto& names = tables.authors->names;
+        const auto& book_tags = tables.book_tags->tags;
+        // Книги с одинаковым названием: by_title упорядочивает их по id, а не по автору и году
+        std::vector<std::pair<const std::string*, const BookRow*>> same_title;
+        std::string tags;
+        auto write_same_title = [&] {
+            std::sort(same_title.begin(), same_title.end(), [&names](const auto& lhs, const auto& rhs) {
+                return std::tie(names.at(lhs.second->author_id), lhs.second->year)
+                       < std::tie(names.at(rhs.second->author_id), rhs.second->year);
+            });
+            for (const auto& [id, row] : same_title) {
+                tags.clear();
+                if (auto it = book_tags.find(*id); it != book_tags.end()) {
+                    for (const auto& tag : it->second) {
+                        if (!tags.empty()) {
+                            tags += ',';
+                        }
+                        tags += tag;
+                    }
+                }
+                writer.Write({names.at(row->author_id), row->title, row->year, tags});
+            }
+            same_title.clear();
+        };
+        for (const auto& [title, id] : tables.books->by_title) {
+            if (!same_title.empty() && same_title.front().second->title != title) {
+                write_same_title();
+            }
+            same_title.emplace_back(&id, &tables.books->rows.at(id));
+        }
+        write_same_title();
+    }
+
+}  // namespace memory
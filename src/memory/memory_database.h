@@ -0,0 +1,256 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../app/catalog_exporter.h"
+#include "../app/catalog_importer.h"
+#include "../app/unit_of_work.h"
+#include "../domain/author.h"
+#include "../domain/book.h"
+
+namespace memory {
+
+/**
+ * Хранилище каталога в памяти процесса - замена Postgres для замеров накладных расходов
+ * приложения и нагрузочного тестирования верхних слоёв.
+ *
+ * Таблицы неизменяемы после публикации и разделяются через shared_ptr. Транзакция, начав
+ * писать, копирует изменяемую таблицу (copy-on-write) и при Commit публикует копию целиком,
+ * поэтому читатели никогда не видят незакоммиченных или частичных изменений. Пишущие
+ * транзакции выполняются по одной, чтение видит последние закоммиченные данные
+ * (как READ COMMITTED в Postgres). Ограничения схемы (уникальность имени автора, внешние
+ * ключи) проверяются так же, как в БД.
+ */
+struct AuthorTable {
+    std::unordered_map<std::string, std::string> names;     // id -> name
+    std::map<std::string, std::string> ids;                 // name -> id, ORDER BY name
+};
+
+struct BookRow {
+    std::string author_id;
+    std::string title;
+    int year = 0;
+};
+
+struct BookTable {
+    std::unordered_map<std::string, BookRow> rows;
+    std::set<std::pair<std::string, std::string>> by_title;                         // title, id
+    std::set<std::tuple<std::string, int, std::string, std::string>> by_author;     // author_id, year, title, id
+    std::set<std::tuple<int, std::string, std::string>> by_year;                    // year, title, id
+
+    void Insert(const std::string& id, BookRow row);
+    void Erase(const std::string& id);
+};
+
+struct BookTagTable {
+    std::unordered_map<std::string, std::vector<std::string>> tags;     // book_id -> теги по алфавиту
+    std::map<std::string, std::size_t> book_counts;                     // tag -> число книг
+
+    void Add(const std::string& book_id, const std::vector<std::string>& new_tags);
+    void Erase(const std::string& book_id);
+};
+
+class Database {
+public:
+    struct Tables {
+        std::shared_ptr<const AuthorTable> authors;
+        std::shared_ptr<const BookTable> books;
+        std::shared_ptr<const BookTagTable> book_tags;
+    };
+
+    Database();
+
+    Tables GetTables() const;
+    // Пишущая транзакция держит блокировку от первой записи до Commit или отката
+    std::unique_lock<std::mutex> LockWriter();
+    void Publish(Tables tables);
+
+private:
+    mutable std::mutex tables_mutex_;
+    std::mutex writer_mutex_;
+    Tables tables_;
+};
+
+class Transaction {
+public:
+    // read_only - все чтения до Commit видят таблицы на момент первого из них, запись запрещена
+    explicit Transaction(Database& database, bool read_only = false)
+        : database_{database}, read_only_{read_only} {
+    }
+
+    std::shared_ptr<const AuthorTable> Authors() const;
+    std::shared_ptr<const BookTable> Books() const;
+    std::shared_ptr<const BookTagTable> BookTags() const;
+
+    AuthorTable& MutableAuthors();
+    BookTable& MutableBooks();
+    BookTagTable& MutableBookTags();
+
+    // Как ошибка запроса в Postgres: транзакция помечается неудачной, Commit её откатит
+    [[noreturn]] void Fail(const std::string& message);
+    void Commit();
+
+private:
+    Database::Tables GetCommitted() const;
+    void BeginWrite();
+    void Reset();
+
+    Database& database_;
+    bool read_only_;
+    mutable std::optional<Database::Tables> snapshot_;
+    std::unique_lock<std::mutex> writer_lock_;
+    // Не nullptr - таблица изменена в этой транзакции
+    std::shared_ptr<AuthorTable> authors_;
+    std::shared_ptr<BookTable> books_;
+    std::shared_ptr<BookTagTable> book_tags_;
+    bool failed_ = false;
+};
+
+class AuthorRepositoryImpl : public domain::AuthorRepository {
+public:
+    explicit AuthorRepositoryImpl(Transaction& transaction)
+        : transaction_{transaction} {
+    }
+
+    void Save(const domain::Author& author) override;
+    std::vector<std::pair<std::string, std::string>> Read() override;
+    std::optional<std::string> ReadNameById(const std::string& id) override;
+    std::optional<std::string> ReadIdByName(const std::string& name) override;
+    std::vector<std::pair<std::string, std::string>> FindSimilar(const std::string& name, double threshold,
+                                                                 std::size_t limit) override;
+    void DeleteByName(const std::string& author_name) override;
+    void DeleteById(const std::string& author_id) override;
+    void EditByName(const std::string& old_name, const std::string& new_name) override;
+    void EditById(const std::string& id, const std::string& new_name) override;
+
+private:
+    // author_id по значению: ссылка на ключ таблицы стала бы висячей при его удалении
+    void Delete(std::string author_id);
+    void Rename(std::string author_id, const std::string& new_name);
+
+    Transaction& transaction_;
+};
+
+class BookRepositoryImpl : public domain::BookRepository {
+public:
+    explicit BookRepositoryImpl(Transaction& transaction)
+        : transaction_{transaction} {
+    }
+
+    void Save(const domain::Book& book) override;
+    std::vector<domain::BookData> Read() override;
+    std::vector<domain::BookData> ReadByName(const std::string& book_name) override;
+    domain::BookData ReadById(const std::string& book_id) override;
+    std::vector<domain::BookData> ReadAuthorBooks(const std::string& author_id) override;
+    std::vector<domain::RankedBook> Search(const std::string& query, std::size_t limit, std::size_t offset) override;
+    std::vector<domain::BookData> FindSimilar(const std::string& title, double threshold, std::size_t limit) override;
+    std::vector<domain::BookData> ReadByYearRange(int from, int to, std::size_t limit, std::size_t offset) override;
+
+    void DeleteByName(const std::string& book_name) override;
+    void DeleteById(const std::string& book_id) override;
+
+    void EditTitleById(const std::string& id, const std::string& new_name) override;
+    void EditYearById(const std::string& id, int new_year) override;
+    void Patch(const std::string& id, const std::optional<std::string>& new_title,
+               const std::optional<int>& new_year) override;
+
+private:
+    void Delete(const std::vector<std::string>& book_ids);
+
+    Transaction& transaction_;
+};
+
+class BookTagsRepositoryImpl : public domain::BookTagsRepository {
+public:
+    explicit BookTagsRepositoryImpl(Transaction& transaction)
+        : transaction_{transaction} {
+    }
+
+    void Save(const domain::BookTags& book_tags) override;
+    std::vector<std::pair<std::string, std::string>> Read() override;
+    std::vector<std::string> ReadById(const std::string& book_id) override;
+    void Update(const domain::BookTags& book_tags) override;
+    void DeleteById(const std::string& book_id) override;
+    std::vector<std::pair<std::string, std::size_t>> ReadTopTags(std::size_t top_k) override;
+
+private:
+    Transaction& transaction_;
+};
+
+class UnitOfWorkImpl : public app::UnitOfWork {
+public:
+    UnitOfWorkImpl(Database& database, bool read_only)
+        : transaction_{database, read_only}, authors_{transaction_}, books_{transaction_}, book_tags_{transaction_} {
+    }
+
+    domain::AuthorRepository* Author() override {
+        return &authors_;
+    }
+    domain::BookRepository* Book() override {
+        return &books_;
+    }
+    domain::BookTagsRepository* BookTags() override {
+        return &book_tags_;
+    }
+    void Commit() override {
+        transaction_.Commit();
+    }
+
+private:
+    Transaction transaction_;
+    AuthorRepositoryImpl authors_;
+    BookRepositoryImpl books_;
+    BookTagsRepositoryImpl book_tags_;
+};
+
+class UnitOfWorkFactoryImpl : public app::UnitOfWorkFactory {
+public:
+    explicit UnitOfWorkFactoryImpl(Database& database)
+        : database_{database} {
+    }
+
+    std::unique_ptr<app::UnitOfWork> CreateUnitOfWork(const app::UnitOfWorkOptions& options = {}) override {
+        return std::make_unique<UnitOfWorkImpl>(database_, options.read_only);
+    }
+
+private:
+    Database& database_;
+};
+
+// Импорт пачки одной транзакцией с теми же правилами слияния, что и у импорта в Postgres
+class CatalogImporterImpl : public app::CatalogImporter {
+public:
+    explicit CatalogImporterImpl(Database& database)
+        : database_{database} {
+    }
+
+    app::ImportStats ImportBatch(const std::vector<app::ImportRecord>& records,
+                                 app::Durability durability = app::Durability::kStrict) override;
+
+private:
+    Database& database_;
+};
+
+// Выгрузка из закоммиченных таблиц, снятых одним GetTables
+class CatalogExporterImpl : public app::CatalogExporter {
+public:
+    explicit CatalogExporterImpl(Database& database)
+        : database_{database} {
+    }
+
+    void Export(app::ExportWriter& writer) override;
+
+private:
+    Database& database_;
+};
+
+}  // namespace memory
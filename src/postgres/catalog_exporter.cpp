@@ -0,0 +1,27 @@
+#include "catalog_exporter.h"
+
+#include <pqxx/pqxx>
+#include <pqxx/zview.hxx>
+
+#include <optional>
+#include <string_view>
+
+namespace postgres {
+
+using pqxx::operator"" _zv;
+
+void CatalogExporterImpl::Export(app::ExportWriter& writer) {
+    pqxx::read_transaction read{connection_};
+    auto query = R"(SELECT author_name, title, publication_year,
+                           COALESCE((SELECT string_agg(tags.name, ',' ORDER BY tags.name)
+                                     FROM book_tags INNER JOIN tags ON tags.id = book_tags.tag_id
+                                     WHERE book_tags.book_id = book_listing.book_id), '')
+                    FROM book_listing ORDER BY title, author_name, publication_year)"_zv;
+    for (auto [author_name, title, year, tags]
+            : read.stream<std::string_view, std::string_view, std::optional<int>, std::string_view>(query)) {
+        writer.Write({author_name, title, year, tags});
+    }
+    read.commit();
+}
+
+}  // namespace postgres
@@ -0,0 +1,25 @@
+#pragma once
+#include <pqxx/connection>
+
+#include "../app/catalog_exporter.h"
+
+namespace postgres {
+
+/**
+ * Выгрузка через COPY (SELECT ...) TO STDOUT (pqxx::stream_from): строки разбираются по мере
+ * получения и сразу отдаются в ExportWriter. Книги читаются из book_listing в порядке её индекса,
+ * теги каждой книги склеиваются на сервере.
+ */
+class CatalogExporterImpl : public app::CatalogExporter {
+public:
+    explicit CatalogExporterImpl(pqxx::connection& connection)
+        : connection_{connection} {
+    }
+
+    void Export(app::ExportWriter& writer) override;
+
+private:
+    pqxx::connection& connection_;
+};
+
+}  // namespace postgres
@@ -0,0 +1,77 @@
+#include "catalog_importer.h"
+
+#include <pqxx/pqxx>
+#include <pqxx/zview.hxx>
+
+#include "change_listener.h"
+#include "postgres.h"
+
+namespace postgres {
+
+using pqxx::operator"" _zv;
+
+app::ImportStats CatalogImporterImpl::ImportBatch(const std::vector<app::ImportRecord>& records,
+                                                  app::Durability durability) {
+    app::ImportStats stats;
+    if (records.empty()) {
+        return stats;
+    }
+    pqxx::work work{connection_};
+    SetDurability(work, durability);
+    work.exec_params("SELECT set_config($1, 'on', true);", BULK_LOAD_SETTING);
+    // line - номер записи в пачке, связывает книгу с её тегами; book_id заменяется на id уже
+    // существующей книги того же автора с тем же названием и годом
+    work.exec(R"(CREATE TEMP TABLE import_books (line integer PRIMARY KEY,
+                 book_id uuid NOT NULL DEFAULT gen_random_uuid(), existing boolean NOT NULL DEFAULT false,
+                 author_name varchar(100) NOT NULL, title varchar(100) NOT NULL, publication_year integer)
+                 ON COMMIT DROP;)"_zv);
+    work.exec(R"(CREATE TEMP TABLE import_tags (line integer NOT NULL, tag varchar(30) NOT NULL)
+                 ON COMMIT DROP;)"_zv);
+    // На соединении может быть открыт только один COPY, поэтому таблицы заполняются по очереди
+    auto books = pqxx::stream_to::table(work, {"import_books"}, {"line", "author_name", "title", "publication_year"});
+    for (std::size_t line = 0; line < records.size(); ++line) {
+        const auto& record = records[line];
+        books.write_values(static_cast<int>(line), record.author_name, record.title, record.year);
+    }
+    books.complete();
+    auto tags = pqxx::stream_to::table(work, {"import_tags"}, {"line", "tag"});
+    for (std::size_t line = 0; line < records.size(); ++line) {
+        for (const auto& tag : records[line].tags) {
+            tags.write_values(static_cast<int>(line), tag);
+        }
+    }
+    tags.complete();
+    // Без статистики планировщик считает временные таблицы маленькими и выбирает вложенные циклы
+    work.exec("ANALYZE import_books; ANALYZE import_tags;"_zv);
+
+    stats.authors = work.exec(
+            R"(INSERT INTO authors (id, name)
+               SELECT gen_random_uuid(), author_name FROM (SELECT DISTINCT author_name FROM import_books) AS names
+               ON CONFLICT (name) DO NOTHING;)"_zv).affected_rows();
+    work.exec(R"(UPDATE import_books SET book_id = books.id, existing = true
+                 FROM authors, books
+                 WHERE authors.name = import_books.author_name AND books.author_id = authors.id
+                   AND books.title = import_books.title
+                   AND books.publication_year IS NOT DISTINCT FROM import_books.publication_year;)"_zv);
+    stats.books = work.exec(
+            R"(INSERT INTO books (id, author_id, title, publication_year)
+               SELECT import_books.book_id, authors.id, import_books.title, import_books.publication_year
+               FROM import_books INNER JOIN authors ON authors.name = import_books.author_name
+               WHERE NOT import_books.existing;)"_zv).affected_rows();
+    // Новые теги попадут в TagDictionary при первом обращении к ним через BookTagsRepositoryImpl
+    work.exec(R"(INSERT INTO tags (name) SELECT DISTINCT tag FROM import_tags
+                 ON CONFLICT (name) DO NOTHING;)"_zv);
+    stats.book_tags = work.exec(
+            R"(INSERT INTO book_tags (book_id, tag_id)
+               SELECT import_books.book_id, tags.id
+               FROM import_tags
+               INNER JOIN import_books USING (line)
+               INNER JOIN tags ON tags.name = import_tags.tag
+               ON CONFLICT DO NOTHING;)"_zv).affected_rows();
+
+    work.exec_params("SELECT pg_notify($1, 'catalog:RESET:');", CHANGES_CHANNEL);
+    work.commit();
+    return stats;
+}
+
+}  // namespace postgres
@@ -0,0 +1,29 @@
+#pragma once
+#include <pqxx/connection>
+
+#include <vector>
+
+#include "../app/catalog_importer.h"
+
+namespace postgres {
+
+/**
+ * Импорт пачки через COPY: записи потоком (pqxx::stream_to) попадают во временные таблицы
+ * import_books/import_tags, после чего несколькими запросами над множествами создаются
+ * недостающие авторы и теги и добавляются книги и связи книга-тег. Построчные уведомления
+ * change feed на время пачки отключены, вместо них отправляется одно "catalog:RESET:".
+ */
+class CatalogImporterImpl : public app::CatalogImporter {
+public:
+    explicit CatalogImporterImpl(pqxx::connection& connection)
+        : connection_{connection} {
+    }
+
+    app::ImportStats ImportBatch(const std::vector<app::ImportRecord>& records,
+                                 app::Durability durability = app::Durability::kStrict) override;
+
+private:
+    pqxx::connection& connection_;
+};
+
+}  // namespace postgres
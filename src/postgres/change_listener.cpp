@@ -0,0 +1,159 @@
+#include "change_listener.h"
+
+#include <pqxx/pqxx>
+
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+namespace postgres {
+    namespace {
+        std::optional<app::EntityType> ParseEntity(std::string_view table) {
+            if (table == "authors") {
+                return app::EntityType::kAuthor;
+            }
+            if (table == "books") {
+                return app::EntityType::kBook;
+            }
+            if (table == "book_tags") {
+                return app::EntityType::kBookTags;
+            }
+            if (table == "catalog") {
+                return app::EntityType::kCatalog;
+            }
+            return std::nullopt;
+        }
+
+        std::optional<app::ChangeOp> ParseOp(std::string_view op) {
+            if (op == "INSERT") {
+                return app::ChangeOp::kInsert;
+            }
+            if (op == "UPDATE") {
+                return app::ChangeOp::kUpdate;
+            }
+            if (op == "DELETE") {
+                return app::ChangeOp::kDelete;
+            }
+            if (op == "RESET") {
+                return app::ChangeOp::kReset;
+            }
+            return std::nullopt;
+        }
+
+        // payload: "<table>:<op>:<id>:<name>" или "catalog:RESET:"; name (имя автора или название
+        // книги) может содержать ':' и отсутствует в уведомлениях старых версий триггера
+        std::optional<app::ChangeEvent> ParsePayload(std::string_view payload) {
+            auto first = payload.find(':');
+            auto second = payload.find(':', first == payload.npos ? first : first + 1);
+            if (second == payload.npos) {
+                return std::nullopt;
+            }
+            auto entity = ParseEntity(payload.substr(0, first));
+            auto op = ParseOp(payload.substr(first + 1, second - first - 1));
+            if (!entity || !op) {
+                return std::nullopt;
+            }
+            auto id = payload.substr(second + 1);
+            std::string_view name;
+            if (auto third = id.find(':'); third != id.npos) {
+                name = id.substr(third + 1);
+                id = id.substr(0, third);
+            }
+            return app::ChangeEvent{*entity, *op, std::string{id}, std::string{name}};
+        }
+    }
+
+    using namespace std::literals;
+
+    class ChangeListener::Receiver : public pqxx::notification_receiver {
+    public:
+        Receiver(pqxx::connection& connection, ChangeListener& listener)
+            : pqxx::notification_receiver(connection, CHANGES_CHANNEL), listener_{listener} {
+        }
+
+        void operator()(const std::string& payload, int backend_pid) override {
+            if (auto event = ParsePayload(payload)) {
+                event->local = listener_.local_backends_.Contains(backend_pid);
+                listener_.Publish(*event);
+            }
+        }
+
+    private:
+        ChangeListener& listener_;
+    };
+
+    void LocalBackends::Add(int pid) {
+        std::lock_guard lock{mutex_};
+        pids_.insert(pid);
+    }
+
+    void LocalBackends::Remove(int pid) {
+        std::lock_guard lock{mutex_};
+        if (auto it = pids_.find(pid); it != pids_.end()) {
+            pids_.erase(it);
+        }
+    }
+
+    bool LocalBackends::Contains(int pid) const {
+        std::lock_guard lock{mutex_};
+        return pids_.count(pid) > 0;
+    }
+
+    ChangeListener::ChangeListener(std::string db_url, const LocalBackends& local_backends)
+        : db_url_{std::move(db_url)}, local_backends_{local_backends} {
+        Connect();
+        thread_ = std::thread{[this] { Run(); }};
+    }
+
+    ChangeListener::~ChangeListener() {
+        stop_ = true;
+        thread_.join();
+    }
+
+    std::size_t ChangeListener::Subscribe(app::ChangeHandler handler) {
+        std::lock_guard lock{mutex_};
+        handlers_.emplace(next_subscription_, std::move(handler));
+        return next_subscription_++;
+    }
+
+    void ChangeListener::Unsubscribe(std::size_t subscription) {
+        std::lock_guard lock{mutex_};
+        handlers_.erase(subscription);
+    }
+
+    void ChangeListener::Connect() {
+        receiver_.reset();
+        connection_ = std::make_unique<pqxx::connection>(db_url_);
+        receiver_ = std::make_unique<Receiver>(*connection_, *this);
+    }
+
+    // await_notification ждёт не дольше секунды, чтобы вовремя заметить stop_.
+    // После потери соединения уведомления могли пропасть, поэтому подписчики получают kReset.
+    void ChangeListener::Run() {
+        while (!stop_) {
+            try {
+                if (!connection_) {
+                    Connect();
+                    Publish({});
+                }
+                connection_->await_notification(1, 0);
+            } catch (const std::exception&) {
+                receiver_.reset();
+                connection_.reset();
+                std::this_thread::sleep_for(1s);
+            }
+        }
+    }
+
+    void ChangeListener::Publish(const app::ChangeEvent &event) {
+        std::lock_guard lock{mutex_};
+        for (const auto& [subscription, handler] : handlers_) {
+            try {
+                handler(event);
+            } catch (const std::exception&) {
+                // ошибка одного подписчика не должна останавливать поток уведомлений
+            }
+        }
+    }
+
+}  // namespace postgres
@@ -0,0 +1,68 @@
+#pragma once
+#include <pqxx/connection>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "../app/change_feed.h"
+
+namespace postgres {
+
+// Канал, в который триггеры, созданные Database, отправляют "<table>:<op>:<id>"
+constexpr const char CHANGES_CHANNEL[]{"bookypedia_changes"};
+// Параметр транзакции: 'on' отключает построчные уведомления (массовая загрузка сама отправляет
+// "catalog:RESET:")
+constexpr const char BULK_LOAD_SETTING[]{"bookypedia.bulk_load"};
+
+// Backend pid соединений этого процесса с одной базой. Соединение, открытое заново, заменяет
+// свой pid. Потокобезопасен
+class LocalBackends {
+public:
+    void Add(int pid);
+    void Remove(int pid);
+    bool Contains(int pid) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::multiset<int> pids_;
+};
+
+// Слушает CHANGES_CHANNEL по отдельному соединению в фоновом потоке. Уведомления от соединений
+// из local_backends помечаются local
+class ChangeListener : public app::ChangeFeed {
+public:
+    ChangeListener(std::string db_url, const LocalBackends& local_backends);
+    ~ChangeListener();
+
+    ChangeListener(const ChangeListener&) = delete;
+    ChangeListener& operator=(const ChangeListener&) = delete;
+
+    std::size_t Subscribe(app::ChangeHandler handler) override;
+    void Unsubscribe(std::size_t subscription) override;
+
+private:
+    class Receiver;
+
+    void Connect();
+    void Run();
+    void Publish(const app::ChangeEvent& event);
+
+    std::string db_url_;
+    const LocalBackends& local_backends_;
+    std::unique_ptr<pqxx::connection> connection_;
+    std::unique_ptr<Receiver> receiver_;
+
+    std::mutex mutex_;
+    std::map<std::size_t, app::ChangeHandler> handlers_;
+    std::size_t next_subscription_ = 1;
+
+    std::atomic_bool stop_{false};
+    std::thread thread_;
+};
+
+}  // namespace postgres
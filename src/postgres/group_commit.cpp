@@ -0,0 +1,193 @@
+#include "group_commit.h"
+
+#include <pqxx/pqxx>
+#include <pqxx/zview.hxx>
+
+#include <stdexcept>
+
+namespace postgres {
+
+using pqxx::operator"" _zv;
+
+class GroupCommitUnitOfWorkFactory::OperationUnitOfWork : public app::UnitOfWork {
+public:
+    OperationUnitOfWork(GroupCommitUnitOfWorkFactory& factory, app::Durability durability)
+        : factory_{factory}, durability_{durability}, group_{factory.BeginOperation()}, work_{*factory.work_},
+          authors_{factory.connection_, work_}, books_{factory.connection_, work_},
+          book_tags_{factory.connection_, work_, factory.tags_} {
+    }
+
+    ~OperationUnitOfWork() override {
+        if (active_) {
+            factory_.EndOperation(false, Rollback());
+        }
+    }
+
+    domain::AuthorRepository* Author() override {
+        return &authors_;
+    }
+    domain::BookRepository* Book() override {
+        return &books_;
+    }
+    domain::BookTagsRepository* BookTags() override {
+        return &book_tags_;
+    }
+
+    // Use case вызывает Commit и после ошибки операции: тогда откатывается только её точка сохранения
+    void Commit() override {
+        if (!active_) {
+            return;
+        }
+        active_ = false;
+        try {
+            work_.exec("RELEASE SAVEPOINT group_operation;"_zv);
+        } catch (const std::exception&) {
+            factory_.EndOperation(false, Rollback());
+            throw;
+        }
+        factory_.EndOperation(true, nullptr, durability_);
+        factory_.WaitGroup(group_);
+        book_tags_.OnCommit();
+    }
+
+private:
+    // Ошибку отката (например, потерю соединения) получит вся группа
+    std::exception_ptr Rollback() noexcept {
+        try {
+            work_.exec("ROLLBACK TO SAVEPOINT group_operation; RELEASE SAVEPOINT group_operation;"_zv);
+            return nullptr;
+        } catch (...) {
+            return std::current_exception();
+        }
+    }
+
+    GroupCommitUnitOfWorkFactory& factory_;
+    app::Durability durability_;
+    std::shared_ptr<Group> group_;
+    pqxx::work& work_;
+    AuthorRepositoryImpl authors_;
+    BookRepositoryImpl books_;
+    BookTagsRepositoryImpl book_tags_;
+    bool active_ = true;
+};
+
+GroupCommitUnitOfWorkFactory::GroupCommitUnitOfWorkFactory(pqxx::connection& connection,
+                                                           app::UnitOfWorkFactory& reads,
+                                                           const GroupCommitConfig& config)
+    : connection_{connection}, reads_{reads}, config_{config} {
+    if (config_.max_operations == 0) {
+        config_.max_operations = 1;
+    }
+}
+
+GroupCommitUnitOfWorkFactory::~GroupCommitUnitOfWorkFactory() {
+    std::unique_lock lock{mutex_};
+    changed_.wait(lock, [this] {
+        return !busy_;
+    });
+    Flush(lock);
+}
+
+std::unique_ptr<app::UnitOfWork> GroupCommitUnitOfWorkFactory::CreateUnitOfWork(const app::UnitOfWorkOptions& options) {
+    if (options.read_only || options.consistent_snapshot) {
+        return reads_.CreateUnitOfWork(options);
+    }
+    return std::make_unique<OperationUnitOfWork>(*this, options.durability);
+}
+
+std::shared_ptr<GroupCommitUnitOfWorkFactory::Group> GroupCommitUnitOfWorkFactory::BeginOperation() {
+    std::shared_ptr<Group> group;
+    {
+        std::unique_lock lock{mutex_};
+        ++queued_;
+        changed_.wait(lock, [this] {
+            return !busy_;
+        });
+        --queued_;
+        busy_ = true;
+        if (!group_) {
+            group_ = std::make_shared<Group>();
+            group_->deadline = std::chrono::steady_clock::now() + config_.max_delay;
+        }
+        group = group_;
+    }
+    // Соединение и work_ принадлежат операции, пока busy_
+    try {
+        if (!work_) {
+            work_ = std::make_unique<pqxx::work>(connection_);
+        }
+        work_->exec("SAVEPOINT group_operation;"_zv);
+    } catch (...) {
+        EndOperation(false, std::current_exception());
+        throw;
+    }
+    return group;
+}
+
+void GroupCommitUnitOfWorkFactory::EndOperation(bool committed, std::exception_ptr error,
+                                                app::Durability durability) {
+    std::unique_lock lock{mutex_};
+    busy_ = false;
+    if (committed) {
+        ++group_->operations;
+        group_->strict = group_->strict || durability == app::Durability::kStrict;
+    }
+    if (error && !group_->error) {
+        group_->error = error;
+    }
+    if (queued_ == 0 || group_->operations >= config_.max_operations
+        || std::chrono::steady_clock::now() >= group_->deadline) {
+        Flush(lock);
+    } else {
+        changed_.notify_all();
+    }
+}
+
+void GroupCommitUnitOfWorkFactory::WaitGroup(const std::shared_ptr<Group>& group) {
+    std::unique_lock lock{mutex_};
+    while (!group->done) {
+        if (std::chrono::steady_clock::now() < group->deadline) {
+            changed_.wait_until(lock, group->deadline);
+        } else if (!busy_ && group_ == group) {
+            Flush(lock);
+        } else {
+            changed_.wait(lock);
+        }
+    }
+    if (group->error) {
+        std::rethrow_exception(group->error);
+    }
+}
+
+void GroupCommitUnitOfWorkFactory::Flush(std::unique_lock<std::mutex>& lock) {
+    auto group = std::move(group_);
+    auto work = std::move(work_);
+    if (!group) {
+        return;
+    }
+    busy_ = true;
+    auto error = group->error;
+    lock.unlock();
+    try {
+        if (work && error) {
+            work->abort();
+        } else if (work) {
+            if (!group->strict) {
+                SetDurability(*work, app::Durability::kAsync);
+            }
+            work->commit();
+        }
+    } catch (...) {
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+    work.reset();
+    lock.lock();
+    busy_ = false;
+    group->done = true;
+    group->error = error;
+    changed_.notify_all();
+}
+
+}  // namespace postgres
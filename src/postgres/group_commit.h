@@ -0,0 +1,85 @@
+#pragma once
+#include <pqxx/connection>
+#include <pqxx/transaction>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include "../app/unit_of_work.h"
+#include "postgres.h"
+#include "tag_dictionary.h"
+
+namespace postgres {
+
+struct GroupCommitConfig {
+    std::size_t max_operations = 64;                // операций в одной транзакции
+    std::chrono::milliseconds max_delay{5};         // сколько первая операция группы ждёт остальные
+};
+
+/**
+ * Group commit: пишущие unit of work выполняются по очереди в общей транзакции на отдельном
+ * соединении, каждый под своей точкой сохранения. Ошибка операции откатывает только её точку
+ * сохранения. Commit операции ждёт фиксации всей группы и сообщает её результат, поэтому после
+ * него изменения видны и долговечны, как при обычном коммите.
+ *
+ * Группа фиксируется, когда в ней max_operations операций, когда первая из них ждёт дольше
+ * max_delay или когда за соединение не ждёт ни одна операция - одиночный писатель не платит
+ * задержкой. Читающие unit of work (read_only) выполняются фабрикой reads, как и unit of work
+ * с consistent_snapshot: снимок нужен всей транзакции, а не точке сохранения в общей.
+ *
+ * Группа фиксируется с kAsync, только если kAsync все вошедшие в неё операции: SET LOCAL
+ * действует на всю транзакцию, а не на точку сохранения.
+ *
+ * Read-write unit of work держит соединение от создания до Commit или удаления, поэтому
+ * в одном потоке нельзя открыть второй, не закончив первый.
+ */
+class GroupCommitUnitOfWorkFactory : public app::UnitOfWorkFactory {
+public:
+    GroupCommitUnitOfWorkFactory(pqxx::connection& connection, app::UnitOfWorkFactory& reads,
+                                 const GroupCommitConfig& config);
+    ~GroupCommitUnitOfWorkFactory();
+
+    GroupCommitUnitOfWorkFactory(const GroupCommitUnitOfWorkFactory&) = delete;
+    GroupCommitUnitOfWorkFactory& operator=(const GroupCommitUnitOfWorkFactory&) = delete;
+
+    std::unique_ptr<app::UnitOfWork> CreateUnitOfWork(const app::UnitOfWorkOptions& options = {}) override;
+
+private:
+    class OperationUnitOfWork;
+
+    struct Group {
+        std::size_t operations = 0;
+        bool strict = false;            // есть операция с Durability::kStrict
+        std::chrono::steady_clock::time_point deadline;
+        bool done = false;
+        std::exception_ptr error;
+    };
+
+    // Занимает соединение и открывает точку сохранения в транзакции текущей группы
+    std::shared_ptr<Group> BeginOperation();
+    // Освобождает соединение; committed - операция вошла в группу, её Commit ждёт группу.
+    // error - транзакция группы испорчена и будет откатена с этой ошибкой
+    void EndOperation(bool committed, std::exception_ptr error = nullptr,
+                      app::Durability durability = app::Durability::kStrict);
+    void WaitGroup(const std::shared_ptr<Group>& group);
+    // Вызывается под mutex_, когда соединение свободно
+    void Flush(std::unique_lock<std::mutex>& lock);
+
+    pqxx::connection& connection_;
+    app::UnitOfWorkFactory& reads_;
+    GroupCommitConfig config_;
+    TagDictionary tags_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool busy_ = false;             // соединение занято операцией или фиксацией
+    std::size_t queued_ = 0;        // операций, ждущих соединения
+    std::unique_ptr<pqxx::work> work_;
+    std::shared_ptr<Group> group_;
+};
+
+}  // namespace postgres
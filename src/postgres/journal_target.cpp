@@ -0,0 +1,45 @@
+#include "journal_target.h"
+
+#include <pqxx/pqxx>
+
+#include <stdexcept>
+#include <utility>
+
+#include "postgres.h"
+
+namespace postgres {
+
+JournalTargetImpl::JournalTargetImpl(std::string db_url, LocalBackends& local_backends)
+    : db_url_{std::move(db_url)},
+      local_backends_{local_backends},
+      connection_{std::make_unique<pqxx::connection>(db_url_)},
+      backend_pid_{connection_->backend_pid()} {
+    local_backends_.Add(backend_pid_);
+}
+
+JournalTargetImpl::~JournalTargetImpl() {
+    local_backends_.Remove(backend_pid_);
+}
+
+std::unique_ptr<app::UnitOfWork> JournalTargetImpl::CreateUnitOfWork() {
+    return std::make_unique<UnitOfWorkImpl>(*connection_, tags_, app::UnitOfWorkOptions{});
+}
+
+bool JournalTargetImpl::IsPermanentError(const std::exception& error) const {
+    if (dynamic_cast<const pqxx::transaction_rollback*>(&error)
+        || dynamic_cast<const pqxx::insufficient_resources*>(&error)) {
+        return false;
+    }
+    return dynamic_cast<const pqxx::sql_error*>(&error) || dynamic_cast<const std::logic_error*>(&error);
+}
+
+void JournalTargetImpl::Recover() {
+    auto connection = std::make_unique<pqxx::connection>(db_url_);
+    auto backend_pid = connection->backend_pid();
+    local_backends_.Add(backend_pid);
+    local_backends_.Remove(backend_pid_);
+    connection_ = std::move(connection);
+    backend_pid_ = backend_pid;
+}
+
+}  // namespace postgres
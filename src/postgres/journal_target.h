@@ -0,0 +1,42 @@
+#pragma once
+#include <pqxx/connection>
+
+#include <exception>
+#include <memory>
+#include <string>
+
+#include "../app/write_journal.h"
+#include "change_listener.h"
+#include "tag_dictionary.h"
+
+namespace postgres {
+
+/**
+ * Хранилище журнала записи: собственное соединение с db_url. Нарушения ограничений и ошибки
+ * операций (нет книги) постоянны; потерянное соединение, конфликт сериализации и нехватка
+ * ресурсов - временные, соединение открывается заново, и его pid заменяет прежний в local_backends.
+ *
+ * Если соединение потеряно во время фиксации, пачка могла зафиксироваться: повтор упрётся
+ * в ограничения, и её unit of work будут пропущены как ошибочные.
+ */
+class JournalTargetImpl : public app::JournalTarget {
+public:
+    JournalTargetImpl(std::string db_url, LocalBackends& local_backends);
+    ~JournalTargetImpl();
+
+    JournalTargetImpl(const JournalTargetImpl&) = delete;
+    JournalTargetImpl& operator=(const JournalTargetImpl&) = delete;
+
+    std::unique_ptr<app::UnitOfWork> CreateUnitOfWork() override;
+    bool IsPermanentError(const std::exception& error) const override;
+    void Recover() override;
+
+private:
+    std::string db_url_;
+    LocalBackends& local_backends_;
+    std::unique_ptr<pqxx::connection> connection_;
+    int backend_pid_;
+    TagDictionary tags_;
+};
+
+}  // namespace postgres
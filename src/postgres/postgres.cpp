@@ -3,6 +3,12 @@
 #include <pqxx/zview.hxx>
 #include <pqxx/pqxx>
 
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "change_listener.h"
+
 namespace postgres {
     namespace {
         // for string delimiter
@@ -20,6 +26,26 @@ namespace postgres {
             res.push_back (s.substr (pos_start));
             return res;
         }
+
+        // CREATE TRIGGER без OR REPLACE, чтобы не брать эксклюзивную блокировку таблицы при каждом старте
+        void CreateTriggerIfNotExists(pqxx::work& work, const std::string& trigger_name,
+                                      const std::string& definition) {
+            work.exec("DO $$ BEGIN IF NOT EXISTS (SELECT 1 FROM pg_trigger WHERE tgname = "
+                      + work.quote(trigger_name) + ") THEN CREATE TRIGGER " + trigger_name + " "
+                      + definition + "; END IF; END $$;");
+        }
+
+        // Порог оператора % действует до конца транзакции; с % запрос использует GIN-индекс gin_trgm_ops
+        void SetSimilarityThreshold(pqxx::transaction_base& work, double threshold) {
+            work.exec_params("SELECT set_config('pg_trgm.similarity_threshold', $1, true);",
+                             std::to_string(threshold));
+        }
+
+        // Строка запроса "books.id, author_id, authors.name, title, publication_year"
+        domain::BookData ToBookData(const pqxx::row& row) {
+            return {row[0].as<std::string>(), row[1].as<std::string>(), row[2].as<std::string>(),
+                    row[3].as<std::string>(), row[4].as<int>()};
+        }
     }
 
     using namespace std::literals;
@@ -48,6 +74,37 @@ namespace postgres {
         return authors;
     }
 
+    std::optional<std::string> AuthorRepositoryImpl::ReadNameById(const std::string &id) {
+        auto result = work_.exec_params(R"(SELECT name FROM authors WHERE id=$1;)"_zv, id);
+        if (result.empty()) {
+            return std::nullopt;
+        }
+        return result[0][0].as<std::string>();
+    }
+
+    std::optional<std::string> AuthorRepositoryImpl::ReadIdByName(const std::string &name) {
+        auto result = work_.exec_params(R"(SELECT id FROM authors WHERE name=$1;)"_zv, name);
+        if (result.empty()) {
+            return std::nullopt;
+        }
+        return result[0][0].as<std::string>();
+    }
+
+    std::vector<std::pair<std::string, std::string>> AuthorRepositoryImpl::FindSimilar(const std::string &name,
+                                                                                       double threshold,
+                                                                                       std::size_t limit) {
+        SetSimilarityThreshold(work_, threshold);
+        std::vector<std::pair<std::string, std::string>> authors;
+        auto result = work_.exec_params(
+                R"(SELECT id, name FROM authors WHERE name % $1
+                   ORDER BY similarity(name, $1) DESC, name LIMIT $2;)"_zv,
+                name, limit);
+        for (const auto& row : result) {
+            authors.emplace_back(row[0].as<std::string>(), row[1].as<std::string>());
+        }
+        return authors;
+    }
+
     void AuthorRepositoryImpl::DeleteByName(const std::string &author_name) {
 
         auto query_author = "SELECT id, name FROM authors WHERE name='" + author_name;
@@ -128,7 +185,8 @@ namespace postgres {
 
     std::vector<domain::BookData> BookRepositoryImpl::Read() {
         std::vector<domain::BookData> books;
-        auto query_text = "SELECT books.id AS book_id, author_id, authors.name AS name, title, publication_year FROM books INNER JOIN authors ON authors.id = author_id ORDER BY title, name, publication_year;"_zv;
+        // book_listing уже отсортирована индексом: ни соединения, ни сортировки
+        auto query_text = "SELECT book_id, author_id, author_name, title, publication_year FROM book_listing ORDER BY title, author_name, publication_year;"_zv;
         for (auto [id, author_id, author_name, title, publication_year]
                 : work_.query<std::string, std::string, std::string, std::string, int>(query_text)) {
             books.emplace_back(id, author_id, author_name, title, publication_year);
@@ -152,9 +210,9 @@ namespace postgres {
     //Read books by title
     std::vector<domain::BookData> BookRepositoryImpl::ReadByName(const std::string &book_name) {
         std::vector<domain::BookData> books;
-        auto query_text = "SELECT books.id AS book_id, author_id, authors.name AS name, title, publication_year"
-            " FROM books INNER JOIN authors ON authors.id = author_id WHERE title='" + book_name;
-        query_text += "' ORDER BY title, name, publication_year;"_zv;
+        auto query_text = "SELECT book_id, author_id, author_name, title, publication_year"
+            " FROM book_listing WHERE title='" + book_name;
+        query_text += "' ORDER BY title, author_name, publication_year;"_zv;
         for (auto [id, author_id, author_name, title, publication_year]
                         : work_.query<std::string, std::string, std::string, std::string, int>(query_text)) {
             books.emplace_back(id, author_id, author_name, title, publication_year);
@@ -163,6 +221,58 @@ namespace postgres {
         return books;
     }
 
+    std::vector<domain::RankedBook> BookRepositoryImpl::Search(const std::string &query, std::size_t limit, std::size_t offset) {
+        std::vector<domain::RankedBook> books;
+        auto result = work_.exec_params(
+                R"(SELECT books.id, author_id, authors.name, title, publication_year,
+                          ts_rank(book_search.document, query) AS rank
+                   FROM book_search
+                   INNER JOIN books ON books.id = book_search.book_id
+                   INNER JOIN authors ON authors.id = books.author_id,
+                   websearch_to_tsquery('simple', $1) AS query
+                   WHERE book_search.document @@ query
+                   ORDER BY rank DESC, title, authors.name, publication_year
+                   LIMIT $2 OFFSET $3;)"_zv,
+                query, limit, offset);
+        for (const auto& row : result) {
+            books.push_back({row[5].as<double>(), ToBookData(row)});
+        }
+        return books;
+    }
+
+    std::vector<domain::BookData> BookRepositoryImpl::FindSimilar(const std::string &title, double threshold,
+                                                                 std::size_t limit) {
+        SetSimilarityThreshold(work_, threshold);
+        std::vector<domain::BookData> books;
+        auto result = work_.exec_params(
+                R"(SELECT books.id, author_id, authors.name, title, publication_year
+                   FROM books INNER JOIN authors ON authors.id = books.author_id
+                   WHERE title % $1
+                   ORDER BY similarity(title, $1) DESC, title, authors.name, publication_year
+                   LIMIT $2;)"_zv,
+                title, limit);
+        for (const auto& row : result) {
+            books.push_back(ToBookData(row));
+        }
+        return books;
+    }
+
+    std::vector<domain::BookData> BookRepositoryImpl::ReadByYearRange(int from, int to, std::size_t limit,
+                                                                     std::size_t offset) {
+        std::vector<domain::BookData> books;
+        auto result = work_.exec_params(
+                R"(SELECT books.id, author_id, authors.name, title, publication_year
+                   FROM books INNER JOIN authors ON authors.id = books.author_id
+                   WHERE publication_year BETWEEN $1 AND $2
+                   ORDER BY publication_year, title, authors.name, books.id
+                   LIMIT $3 OFFSET $4;)"_zv,
+                from, to, limit, offset);
+        for (const auto& row : result) {
+            books.push_back(ToBookData(row));
+        }
+        return books;
+    }
+
     void BookRepositoryImpl::DeleteByName(const std::string &book_name) {
 
         work_.exec_params(R"(DELETE FROM books WHERE title=$1;)"_zv,book_name);
@@ -205,57 +315,166 @@ namespace postgres {
         work_.exec_params(R"(UPDATE books SET publication_year=$2 WHERE id=$1;)"_zv, b_id, new_year);
     }
 
+    // Без предварительного SELECT: существование книги проверяется по RETURNING
+    void BookRepositoryImpl::Patch(const std::string &b_id, const std::optional<std::string> &new_title,
+                                   const std::optional<int> &new_year) {
+        auto result = work_.exec_params(
+                R"(UPDATE books SET title=COALESCE($2, title), publication_year=COALESCE($3, publication_year)
+                   WHERE id=$1 RETURNING id;)"_zv, b_id, new_title, new_year);
+        if (result.empty()) {
+            throw std::logic_error("Book not found");
+        }
+    }
+
     //------------------------------------------------------------------------
     //===============BookTagsRepositoryImpl==================================
     void BookTagsRepositoryImpl::Save(const domain::BookTags &book_tags) {
-        for(const auto& tag : book_tags.GetTags()){
-            work_.exec_params(R"(INSERT INTO book_tags (book_id, tag)
-                     VALUES ($1, $2);)"_zv, book_tags.GetBookId(), tag);
+        if (book_tags.GetTags().empty()) {
+            return;
         }
-
+        work_.exec_params(R"(INSERT INTO book_tags (book_id, tag_id) SELECT $1, unnest($2::integer[])
+                 ON CONFLICT DO NOTHING;)"_zv, book_tags.GetBookId(), ResolveTagIds(book_tags.GetTags()));
     }
 
     std::vector<std::pair<std::string, std::string>> BookTagsRepositoryImpl::Read() {
         std::vector<std::pair<std::string, std::string>> book_tags;
-        auto query_text = "SELECT book_id, tag FROM book_tags;"_zv;
+        auto query_text = "SELECT book_id, tags.name FROM book_tags INNER JOIN tags ON tags.id = book_tags.tag_id;"_zv;
         for (auto [book_id, tag] : work_.query<std::string, std::string>(query_text)) {
             book_tags.emplace_back(book_id, tag);
         }
         return book_tags;
     }
 
+    // Разница с текущими тегами одним запросом: неизменившиеся строки не удаляются и не вставляются
+    // заново, поэтому не срабатывают их триггеры и уведомления
     void BookTagsRepositoryImpl::Update(const domain::BookTags &book_tags) {
-        //TODO: delete old and insert new book_tags
-        auto query_text = "DELETE FROM book_tags WHERE book_id='" + book_tags.GetBookId();
-        query_text += "';"_zv;
-        work_.exec(query_text);
-        //---
-        for(const auto& tag : book_tags.GetTags()){
-            work_.exec_params(R"(INSERT INTO book_tags (book_id, tag)
-                     VALUES ($1, $2);)"_zv, book_tags.GetBookId(), tag);
-        }
+        work_.exec_params(R"(WITH removed AS (DELETE FROM book_tags
+                                               WHERE book_id=$1 AND NOT (tag_id = ANY($2::integer[])))
+                             INSERT INTO book_tags (book_id, tag_id) SELECT $1, unnest($2::integer[])
+                             ON CONFLICT DO NOTHING;)"_zv,
+                          book_tags.GetBookId(), ResolveTagIds(book_tags.GetTags()));
     }
 
     std::vector<std::string> BookTagsRepositoryImpl::ReadById(const std::string &book_id) {
-        std::vector<std::string> tags;
-        auto query_text = "SELECT tag FROM book_tags WHERE book_id='" + book_id;
-        query_text += "' LIMIT 1;"_zv;
-        std::optional result_tag = work_.query01<std::string>(query_text);
-        if (result_tag) {
-            auto query_text_all = "SELECT tag FROM book_tags WHERE book_id='" + book_id + "';";
-            for (auto [tag] : work_.query<std::string>(query_text_all)) {
-                tags.push_back(tag);
-            }
-            /*auto [str] = *result_tag;
-            tags = split(str, " ");  */
+        std::vector<TagId> ids;
+        auto result = work_.exec_params(R"(SELECT tag_id FROM book_tags WHERE book_id=$1;)"_zv, book_id);
+        for (const auto& row : result) {
+            ids.push_back(row[0].as<TagId>());
         }
+        auto tags = ResolveTagNames(ids);
+        std::sort(tags.begin(), tags.end());
         return tags;
     }
 
     void BookTagsRepositoryImpl::DeleteById(const std::string &book_id) {
-        auto query_text = "DELETE FROM book_tags WHERE book_id='" + book_id;
-        query_text += "';"_zv;
-        work_.exec(query_text);
+        work_.exec_params(R"(DELETE FROM book_tags WHERE book_id=$1;)"_zv, book_id);
+    }
+
+    std::vector<std::pair<std::string, std::size_t>> BookTagsRepositoryImpl::ReadTopTags(std::size_t top_k) {
+        std::vector<std::pair<std::string, std::size_t>> top_tags;
+        auto result = work_.exec_params(
+                R"(SELECT tags.name, book_count FROM tag_stats INNER JOIN tags ON tags.id = tag_stats.tag_id
+                   ORDER BY book_count DESC, tags.name LIMIT $1;)"_zv, top_k);
+        for (const auto& row : result) {
+            top_tags.emplace_back(row[0].as<std::string>(), row[1].as<std::size_t>());
+        }
+        return top_tags;
+    }
+
+    void BookTagsRepositoryImpl::OnCommit() {
+        tags_.Commit();
+    }
+
+    // Недостающие в словаре теги создаются одним запросом, а теги, уже вставленные параллельными
+    // транзакциями, читаются вторым, со своим снимком (READ COMMITTED) и FOR KEY SHARE, чтобы тег не
+    // удалили до коммита. В REPEATABLE READ (сессии use case'ов) тег, вставленный после начала
+    // транзакции, ей не виден: INSERT ... ON CONFLICT тогда завершается ошибкой сериализации,
+    // и сессию можно повторить
+    std::vector<TagId> BookTagsRepositoryImpl::ResolveTagIds(const std::vector<std::string> &names) {
+        std::vector<TagId> ids;
+        std::vector<std::string> missing;
+        for (const auto& name : names) {
+            if (auto id = tags_.FindId(name)) {
+                ids.push_back(*id);
+            } else {
+                missing.push_back(name);
+            }
+        }
+        if (missing.empty()) {
+            return ids;
+        }
+        auto resolve = [&](const pqxx::result& result) {
+            std::unordered_set<std::string> resolved;
+            for (const auto& row : result) {
+                auto id = row[0].as<TagId>();
+                auto name = row[1].as<std::string>();
+                tags_.Add(id, name);
+                ids.push_back(id);
+                resolved.insert(name);
+            }
+            std::erase_if(missing, [&resolved](const std::string& name) {
+                return resolved.count(name) > 0;
+            });
+        };
+        resolve(work_.exec_params(
+                R"(INSERT INTO tags (name) SELECT DISTINCT unnest($1::varchar[])
+                   ON CONFLICT (name) DO NOTHING RETURNING id, name;)"_zv,
+                missing));
+        if (!missing.empty()) {
+            resolve(work_.exec_params(
+                    R"(SELECT id, name FROM tags WHERE name = ANY($1::varchar[]) FOR KEY SHARE;)"_zv,
+                    missing));
+        }
+        if (!missing.empty()) {
+            throw std::runtime_error("Failed to resolve tag ids");
+        }
+        return ids;
+    }
+
+    std::vector<std::string> BookTagsRepositoryImpl::ResolveTagNames(const std::vector<TagId> &ids) {
+        std::vector<std::string> names;
+        std::vector<TagId> missing;
+        for (auto id : ids) {
+            if (auto name = tags_.FindName(id)) {
+                names.push_back(std::move(*name));
+            } else {
+                missing.push_back(id);
+            }
+        }
+        if (!missing.empty()) {
+            // Тег может быть создан этой же, ещё не закоммиченной транзакцией
+            auto result = work_.exec_params(R"(SELECT id, name FROM tags WHERE id = ANY($1::integer[]);)"_zv, missing);
+            for (const auto& row : result) {
+                auto name = row[1].as<std::string>();
+                tags_.Add(row[0].as<TagId>(), name);
+                names.push_back(std::move(name));
+            }
+        }
+        return names;
+    }
+
+    //------------------------------------------------------------------------
+    //===============UnitOfWorkImpl==================================
+    std::unique_ptr<pqxx::transaction_base> BeginTransaction(pqxx::connection &connection,
+                                                             const app::UnitOfWorkOptions &options) {
+        if (options.read_only) {
+            return std::make_unique<pqxx::transaction<pqxx::isolation_level::repeatable_read,
+                                                      pqxx::write_policy::read_only>>(connection);
+        }
+        std::unique_ptr<pqxx::transaction_base> work;
+        if (options.consistent_snapshot) {
+            work = std::make_unique<pqxx::transaction<pqxx::isolation_level::repeatable_read>>(connection);
+        } else {
+            work = std::make_unique<pqxx::work>(connection);
+        }
+        SetDurability(*work, options.durability);
+        return work;
+    }
+
+    void SetDurability(pqxx::transaction_base &work, app::Durability durability) {
+        if (durability == app::Durability::kAsync) {
+            work.exec("SET LOCAL synchronous_commit = off;"_zv);
+        }
     }
 
     Database::Database(pqxx::connection connection) : connection_{std::move(connection)} {
@@ -270,8 +489,211 @@ namespace postgres {
         author_id UUID NOT NULL, title varchar(100) NOT NULL, publication_year integer);)"_zv);*/
         work.exec(R"(CREATE TABLE IF NOT EXISTS books (id UUID PRIMARY KEY, author_id UUID REFERENCES authors(id) NOT NULL,
         title varchar(100) NOT NULL, publication_year integer);)"_zv);
+        //Книги автора: ReadAuthorBooks, каскадное удаление и поиск существующих книг при импорте
+        work.exec(R"(CREATE INDEX IF NOT EXISTS books_author_id_idx ON books (author_id, title);)"_zv);
+
+        //Словарь тегов: book_tags хранит id тега вместо строки
+        work.exec(R"(CREATE TABLE IF NOT EXISTS tags (id serial PRIMARY KEY, name varchar(30) UNIQUE NOT NULL);)"_zv);
+        //Миграция book_tags (book_id, tag varchar) прежних версий; повторяющиеся пары схлопываются
+        work.exec(R"(DO $$ BEGIN
+            IF EXISTS (SELECT 1 FROM information_schema.columns
+                       WHERE table_schema = current_schema() AND table_name = 'book_tags' AND column_name = 'tag') THEN
+                INSERT INTO tags (name) SELECT DISTINCT tag FROM book_tags ON CONFLICT (name) DO NOTHING;
+                CREATE TABLE book_tags_normalized (book_id UUID REFERENCES books(id) NOT NULL,
+                    tag_id integer REFERENCES tags(id) NOT NULL, PRIMARY KEY (book_id, tag_id));
+                INSERT INTO book_tags_normalized (book_id, tag_id)
+                    SELECT DISTINCT book_id, tags.id FROM book_tags INNER JOIN tags ON tags.name = book_tags.tag;
+                DROP TABLE book_tags;
+                ALTER TABLE book_tags_normalized RENAME TO book_tags;
+            END IF;
+        END $$;)"_zv);
+        work.exec(R"(CREATE TABLE IF NOT EXISTS book_tags (book_id UUID REFERENCES books(id) NOT NULL,
+        tag_id integer REFERENCES tags(id) NOT NULL, PRIMARY KEY (book_id, tag_id));)"_zv);
+        work.exec(R"(CREATE INDEX IF NOT EXISTS book_tags_tag_id_idx ON book_tags (tag_id);)"_zv);
+
+        //Число книг по тегам, поддерживаемое триггерами: TagStats не пересчитывает book_tags
+        work.exec(R"(DO $$ BEGIN
+            IF to_regclass('tag_stats') IS NULL THEN
+                CREATE TABLE tag_stats (tag_id integer PRIMARY KEY REFERENCES tags(id), book_count integer NOT NULL);
+                CREATE INDEX tag_stats_book_count_idx ON tag_stats (book_count DESC);
+                INSERT INTO tag_stats (tag_id, book_count) SELECT tag_id, count(*) FROM book_tags GROUP BY tag_id;
+            END IF;
+        END $$;)"_zv);
+        //Триггеры уровня оператора: массовая запись тегов обновляет каждый счётчик один раз
+        work.exec(R"(CREATE OR REPLACE FUNCTION bookypedia_count_book_tags() RETURNS trigger AS $$
+        BEGIN
+            IF TG_OP IN ('DELETE', 'UPDATE') THEN
+                UPDATE tag_stats SET book_count = tag_stats.book_count - removed.book_count
+                    FROM (SELECT tag_id, count(*) AS book_count FROM old_rows GROUP BY tag_id) AS removed
+                    WHERE tag_stats.tag_id = removed.tag_id;
+                DELETE FROM tag_stats WHERE book_count <= 0 AND tag_id IN (SELECT tag_id FROM old_rows);
+            END IF;
+            IF TG_OP IN ('INSERT', 'UPDATE') THEN
+                INSERT INTO tag_stats (tag_id, book_count)
+                    SELECT tag_id, count(*) FROM new_rows GROUP BY tag_id
+                    ON CONFLICT (tag_id) DO UPDATE SET book_count = tag_stats.book_count + EXCLUDED.book_count;
+            END IF;
+            RETURN NULL;
+        END;
+        $$ LANGUAGE plpgsql;)"_zv);
+        //Таблицы переходов нельзя объявить у триггера на несколько событий
+        CreateTriggerIfNotExists(work, "book_tags_count_insert",
+                                 "AFTER INSERT ON book_tags REFERENCING NEW TABLE AS new_rows"
+                                 " FOR EACH STATEMENT EXECUTE FUNCTION bookypedia_count_book_tags()");
+        CreateTriggerIfNotExists(work, "book_tags_count_update",
+                                 "AFTER UPDATE ON book_tags REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows"
+                                 " FOR EACH STATEMENT EXECUTE FUNCTION bookypedia_count_book_tags()");
+        CreateTriggerIfNotExists(work, "book_tags_count_delete",
+                                 "AFTER DELETE ON book_tags REFERENCING OLD TABLE AS old_rows"
+                                 " FOR EACH STATEMENT EXECUTE FUNCTION bookypedia_count_book_tags()");
+
+        //Change feed: каждая изменённая строка отправляет "<table>:<op>:<id>:<name>" в CHANGES_CHANNEL,
+        //name - имя автора или название книги из строки, чтобы подписчики дополняли фильтры без перечитывания.
+        //Массовая загрузка (BULK_LOAD_SETTING) вместо этого отправляет одно "catalog:RESET:"
+        work.exec(R"(CREATE OR REPLACE FUNCTION bookypedia_notify_change() RETURNS trigger AS $$
+        DECLARE
+            changed jsonb;
+        BEGIN
+            IF current_setting('bookypedia.bulk_load', true) = 'on' THEN
+                RETURN NULL;
+            END IF;
+            IF TG_OP = 'DELETE' THEN
+                changed := to_jsonb(OLD);
+            ELSE
+                changed := to_jsonb(NEW);
+            END IF;
+            PERFORM pg_notify(TG_ARGV[0], TG_TABLE_NAME || ':' || TG_OP || ':'
+                || COALESCE(changed->>'id', changed->>'book_id') || ':'
+                || COALESCE(changed->>'name', changed->>'title', ''));
+            RETURN NULL;
+        END;
+        $$ LANGUAGE plpgsql;)"_zv);
+        for (const std::string& table : {"authors"s, "books"s, "book_tags"s}) {
+            CreateTriggerIfNotExists(work, table + "_notify_change",
+                                     "AFTER INSERT OR UPDATE OR DELETE ON " + table
+                                     + " FOR EACH ROW EXECUTE FUNCTION bookypedia_notify_change('"
+                                     + CHANGES_CHANNEL + "')");
+        }
 
-        work.exec(R"(CREATE TABLE IF NOT EXISTS book_tags (book_id UUID REFERENCES books(id) NOT NULL, tag varchar(30) NOT NULL);)"_zv);
+        //Список книг для ShowBooks/SelectBook: books с именем автора, поддерживаемые триггерами,
+        //с индексом в порядке вывода вместо соединения и сортировки при каждом чтении
+        work.exec(R"(CREATE TABLE IF NOT EXISTS book_listing (book_id UUID PRIMARY KEY REFERENCES books(id) ON DELETE CASCADE,
+        author_id UUID NOT NULL, author_name varchar(100) NOT NULL, title varchar(100) NOT NULL, publication_year integer);)"_zv);
+        work.exec(R"(CREATE INDEX IF NOT EXISTS book_listing_order_idx ON book_listing (title, author_name, publication_year);)"_zv);
+        work.exec(R"(CREATE INDEX IF NOT EXISTS book_listing_author_idx ON book_listing (author_id);)"_zv);
+        //Имя автора читается с FOR SHARE: параллельное переименование либо ждёт эту транзакцию и потом
+        //обновляет её строку списка, либо завершается раньше, и здесь читается уже новое имя
+        work.exec(R"(CREATE OR REPLACE FUNCTION bookypedia_refresh_book_listing() RETURNS trigger AS $$
+        DECLARE
+            current_name varchar(100);
+        BEGIN
+            IF TG_TABLE_NAME = 'authors' THEN
+                UPDATE book_listing SET author_name = NEW.name WHERE author_id = NEW.id;
+            ELSE
+                SELECT name INTO current_name FROM authors WHERE id = NEW.author_id FOR SHARE;
+                IF FOUND THEN
+                    INSERT INTO book_listing (book_id, author_id, author_name, title, publication_year)
+                        VALUES (NEW.id, NEW.author_id, current_name, NEW.title, NEW.publication_year)
+                        ON CONFLICT (book_id) DO UPDATE SET author_id = EXCLUDED.author_id,
+                            author_name = EXCLUDED.author_name, title = EXCLUDED.title,
+                            publication_year = EXCLUDED.publication_year;
+                END IF;
+            END IF;
+            RETURN NULL;
+        END;
+        $$ LANGUAGE plpgsql;)"_zv);
+        CreateTriggerIfNotExists(work, "books_refresh_listing",
+                                 "AFTER INSERT OR UPDATE ON books"
+                                 " FOR EACH ROW EXECUTE FUNCTION bookypedia_refresh_book_listing()");
+        CreateTriggerIfNotExists(work, "authors_refresh_listing",
+                                 "AFTER UPDATE OF name ON authors"
+                                 " FOR EACH ROW EXECUTE FUNCTION bookypedia_refresh_book_listing()");
+        //Книги, добавленные до появления списка
+        work.exec(R"(INSERT INTO book_listing (book_id, author_id, author_name, title, publication_year)
+            SELECT books.id, author_id, authors.name, title, publication_year
+            FROM books INNER JOIN authors ON authors.id = books.author_id
+            WHERE NOT EXISTS (SELECT 1 FROM book_listing WHERE book_listing.book_id = books.id);)"_zv);
+
+        //Выборки по диапазону лет: архивные книги добавляются примерно в порядке года издания,
+        //и BRIN-индекс по нескольким страницам на диапазон остаётся крошечным
+        work.exec("CREATE INDEX IF NOT EXISTS books_publication_year_brin_idx ON books USING brin (publication_year);"_zv);
+
+        //Нечёткий поиск по триграммам для выбора книг и авторов по имени с опечатками
+        work.exec("CREATE EXTENSION IF NOT EXISTS pg_trgm;"_zv);
+        work.exec("CREATE INDEX IF NOT EXISTS books_title_trgm_idx ON books USING gin (title gin_trgm_ops);"_zv);
+        work.exec("CREATE INDEX IF NOT EXISTS authors_name_trgm_idx ON authors USING gin (name gin_trgm_ops);"_zv);
+
+        //Full-text search: документ книги (название, имя автора, теги) хранится в отдельной таблице,
+        //чтобы его пересчёт не переписывал строки books и не порождал лишних уведомлений об изменениях
+        work.exec(R"(CREATE TABLE IF NOT EXISTS book_search (book_id UUID PRIMARY KEY REFERENCES books(id) ON DELETE CASCADE,
+        document tsvector NOT NULL);)"_zv);
+        work.exec(R"(CREATE INDEX IF NOT EXISTS book_search_document_idx ON book_search USING gin (document);)"_zv);
+        work.exec(R"(CREATE OR REPLACE FUNCTION bookypedia_book_document(target UUID) RETURNS tsvector AS $$
+            SELECT setweight(to_tsvector('simple', books.title), 'A')
+                || setweight(to_tsvector('simple', coalesce(authors.name, '')), 'B')
+                || setweight(to_tsvector('simple', coalesce(
+                       (SELECT string_agg(tags.name, ' ') FROM book_tags
+                        INNER JOIN tags ON tags.id = book_tags.tag_id WHERE book_id = books.id), '')), 'C')
+            FROM books LEFT JOIN authors ON authors.id = books.author_id
+            WHERE books.id = target;
+        $$ LANGUAGE sql STABLE;)"_zv);
+        work.exec(R"(CREATE OR REPLACE FUNCTION bookypedia_refresh_book_search() RETURNS trigger AS $$
+        DECLARE
+            target UUID;
+        BEGIN
+            IF TG_TABLE_NAME = 'authors' THEN
+                FOR target IN SELECT id FROM books WHERE author_id = NEW.id LOOP
+                    UPDATE book_search SET document = bookypedia_book_document(target) WHERE book_id = target;
+                END LOOP;
+                RETURN NULL;
+            END IF;
+            target := NEW.id;
+            INSERT INTO book_search (book_id, document)
+                SELECT target, bookypedia_book_document(target) WHERE EXISTS (SELECT 1 FROM books WHERE id = target)
+                ON CONFLICT (book_id) DO UPDATE SET document = EXCLUDED.document;
+            RETURN NULL;
+        END;
+        $$ LANGUAGE plpgsql;)"_zv);
+        CreateTriggerIfNotExists(work, "books_refresh_search",
+                                 "AFTER INSERT OR UPDATE OF title, author_id ON books"
+                                 " FOR EACH ROW EXECUTE FUNCTION bookypedia_refresh_book_search()");
+        //Теги пересчитываются триггерами уровня оператора: сохранение нескольких тегов книги или пачка
+        //импорта строит документ каждой затронутой книги один раз, а не на каждую строку book_tags
+        work.exec(R"(CREATE OR REPLACE FUNCTION bookypedia_refresh_book_tags_search() RETURNS trigger AS $$
+        DECLARE
+            targets UUID[];
+        BEGIN
+            IF TG_OP = 'INSERT' THEN
+                targets := ARRAY(SELECT DISTINCT book_id FROM new_rows);
+            ELSIF TG_OP = 'DELETE' THEN
+                targets := ARRAY(SELECT DISTINCT book_id FROM old_rows);
+            ELSE
+                targets := ARRAY(SELECT book_id FROM old_rows UNION SELECT book_id FROM new_rows);
+            END IF;
+            INSERT INTO book_search (book_id, document)
+                SELECT id, bookypedia_book_document(id) FROM books WHERE id = ANY(targets)
+                ON CONFLICT (book_id) DO UPDATE SET document = EXCLUDED.document;
+            RETURN NULL;
+        END;
+        $$ LANGUAGE plpgsql;)"_zv);
+        //Построчный триггер прежних версий
+        work.exec("DROP TRIGGER IF EXISTS book_tags_refresh_search ON book_tags;"_zv);
+        CreateTriggerIfNotExists(work, "book_tags_search_insert",
+                                 "AFTER INSERT ON book_tags REFERENCING NEW TABLE AS new_rows"
+                                 " FOR EACH STATEMENT EXECUTE FUNCTION bookypedia_refresh_book_tags_search()");
+        CreateTriggerIfNotExists(work, "book_tags_search_update",
+                                 "AFTER UPDATE ON book_tags REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows"
+                                 " FOR EACH STATEMENT EXECUTE FUNCTION bookypedia_refresh_book_tags_search()");
+        CreateTriggerIfNotExists(work, "book_tags_search_delete",
+                                 "AFTER DELETE ON book_tags REFERENCING OLD TABLE AS old_rows"
+                                 " FOR EACH STATEMENT EXECUTE FUNCTION bookypedia_refresh_book_tags_search()");
+        CreateTriggerIfNotExists(work, "authors_refresh_search",
+                                 "AFTER UPDATE OF name ON authors"
+                                 " FOR EACH ROW EXECUTE FUNCTION bookypedia_refresh_book_search()");
+        //Книги, добавленные до появления поиска
+        work.exec(R"(INSERT INTO book_search (book_id, document)
+            SELECT id, bookypedia_book_document(id) FROM books
+            WHERE NOT EXISTS (SELECT 1 FROM book_search WHERE book_id = books.id);)"_zv);
 
         //Отключил очистку данных в таблицах для прохождения тестов в ../../../tests/test_s04_bookypedia-1.py
         //work.exec("DELETE FROM book_tags;"_zv); //Delete book_tags data
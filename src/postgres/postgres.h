@@ -1,24 +1,31 @@
 #pragma once
 #include <pqxx/connection>
 #include <pqxx/transaction>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "../domain/author.h"
 #include "../domain/book.h"
 #include "../app/unit_of_work.h"
+#include "tag_dictionary.h"
 
 namespace postgres {
 
 
 class AuthorRepositoryImpl : public domain::AuthorRepository {
 public:
-    explicit AuthorRepositoryImpl(pqxx::connection& connection, pqxx::work& work)
+    explicit AuthorRepositoryImpl(pqxx::connection& connection, pqxx::transaction_base& work)
         : connection_{connection}, work_{work}{
     }
 
     void Save(const domain::Author& author) override;
     std::vector<std::pair<std::string, std::string>> Read() override;
+    std::optional<std::string> ReadNameById(const std::string& id) override;
+    std::optional<std::string> ReadIdByName(const std::string& name) override;
+    std::vector<std::pair<std::string, std::string>> FindSimilar(const std::string& name, double threshold,
+                                                                 std::size_t limit) override;
     void DeleteByName(const std::string& author_name) override;
     void DeleteById(const std::string& author_id) override;
     void EditByName(const std::string& old_name, const std::string& new_name) override;
@@ -26,12 +33,12 @@ public:
 
 private:
     pqxx::connection& connection_;
-    pqxx::work& work_;
+    pqxx::transaction_base& work_;
 };
 
 class BookRepositoryImpl : public domain::BookRepository {
 public:
-    explicit BookRepositoryImpl(pqxx::connection& connection, pqxx::work& work)
+    explicit BookRepositoryImpl(pqxx::connection& connection, pqxx::transaction_base& work)
             : connection_{connection}, work_{work}{
     }
 
@@ -40,22 +47,27 @@ public:
     std::vector<domain::BookData> ReadByName(const std::string& book_name) override;
     domain::BookData ReadById(const std::string& book_id) override;
     std::vector<domain::BookData> ReadAuthorBooks(const std::string& author_id) override;
+    std::vector<domain::RankedBook> Search(const std::string& query, std::size_t limit, std::size_t offset) override;
+    std::vector<domain::BookData> FindSimilar(const std::string& title, double threshold, std::size_t limit) override;
+    std::vector<domain::BookData> ReadByYearRange(int from, int to, std::size_t limit, std::size_t offset) override;
 
     void DeleteByName(const std::string& book_name ) override;
     void DeleteById(const std::string& book_id ) override;
 
     void EditTitleById(const std::string& id, const std::string& new_name) override;
     void EditYearById(const std::string& id, int new_year) override;
+    void Patch(const std::string& id, const std::optional<std::string>& new_title,
+               const std::optional<int>& new_year) override;
 
 private:
     pqxx::connection& connection_;
-    pqxx::work& work_;
+    pqxx::transaction_base& work_;
 };
 
 class BookTagsRepositoryImpl : public domain::BookTagsRepository {
 public:
-    explicit BookTagsRepositoryImpl(pqxx::connection& connection, pqxx::work& work)
-            : connection_{connection}, work_{work}{
+    explicit BookTagsRepositoryImpl(pqxx::connection& connection, pqxx::transaction_base& work, TagDictionary& tags)
+            : connection_{connection}, work_{work}, tags_{tags}{
     }
 
     void Save(const domain::BookTags& book_tags) override;
@@ -63,43 +75,60 @@ public:
     std::vector<std::string> ReadById(const std::string& book_id) override;
     void Update(const domain::BookTags& book_tags) override;
     void DeleteById(const std::string& book_id) override;
+    std::vector<std::pair<std::string, std::size_t>> ReadTopTags(std::size_t top_k) override;
+
+    // Вызывается после коммита транзакции: теги, созданные в ней, попадают в словарь
+    void OnCommit();
 
 private:
+    std::vector<TagId> ResolveTagIds(const std::vector<std::string>& names);
+    std::vector<std::string> ResolveTagNames(const std::vector<TagId>& ids);
+
     pqxx::connection& connection_;
-    pqxx::work& work_;
+    pqxx::transaction_base& work_;
+    StagedTags tags_;
 };
 
+// Транзакция для чтения - REPEATABLE READ READ ONLY: все запросы видят один снимок, а ошибок
+// сериализации у читающих транзакций не бывает. Пишущие остаются READ COMMITTED, чтобы параллельные
+// правки других экземпляров не отклонялись; с consistent_snapshot (сессии) - REPEATABLE READ
+std::unique_ptr<pqxx::transaction_base> BeginTransaction(pqxx::connection& connection,
+                                                         const app::UnitOfWorkOptions& options);
+// kAsync - SET LOCAL synchronous_commit = off: действует только до конца транзакции
+void SetDurability(pqxx::transaction_base& work, app::Durability durability);
+
 //======================================UnitOfWorkImpl============================
 //--------------------------------------------------------------------------------
     class UnitOfWorkImpl : public app::UnitOfWork {
     public:
-        explicit UnitOfWorkImpl(pqxx::connection& connection)
-                : connection_(connection), work_(connection_),
-                  authors_(new AuthorRepositoryImpl(connection_, work_)),
-                  books_(new BookRepositoryImpl(connection_, work_)),
-                  book_tags_(new BookTagsRepositoryImpl(connection_, work_)) {
+        UnitOfWorkImpl(pqxx::connection& connection, TagDictionary& tags, const app::UnitOfWorkOptions& options)
+                : connection_(connection), work_(BeginTransaction(connection_, options)),
+                  authors_(connection_, *work_),
+                  books_(connection_, *work_),
+                  book_tags_(connection_, *work_, tags) {
         }
 
 
         domain::AuthorRepository* Author() override{
-            return authors_;
+            return &authors_;
         }
         domain::BookRepository* Book() override{
-            return books_;
+            return &books_;
         }
         domain::BookTagsRepository* BookTags() override{
-            return book_tags_;
+            return &book_tags_;
         }
         void Commit() override{
-            work_.commit();
+            work_->commit();
+            book_tags_.OnCommit();
         }
 
     private:
         pqxx::connection& connection_;
-        pqxx::work work_;
-        domain::AuthorRepository* authors_;
-        domain::BookRepository* books_;
-        domain::BookTagsRepository* book_tags_;
+        std::unique_ptr<pqxx::transaction_base> work_;
+        AuthorRepositoryImpl authors_;
+        BookRepositoryImpl books_;
+        BookTagsRepositoryImpl book_tags_;
     };
 
     class UnitOfWorkFactoryImpl : public app::UnitOfWorkFactory {
@@ -107,12 +136,13 @@ private:
         explicit UnitOfWorkFactoryImpl(pqxx::connection& connection)
                 : connection_(connection){}
 
-        app::UnitOfWork* CreateUnitOfWork() override{
-            return new UnitOfWorkImpl(connection_);
+        std::unique_ptr<app::UnitOfWork> CreateUnitOfWork(const app::UnitOfWorkOptions& options = {}) override{
+            return std::make_unique<UnitOfWorkImpl>(connection_, tags_, options);
         }
 
     private:
         pqxx::connection& connection_;
+        TagDictionary tags_;
     };
 
 
@@ -0,0 +1,61 @@
+#include "tag_dictionary.h"
+
+namespace postgres {
+
+std::optional<TagId> TagDictionary::FindId(const std::string& name) const {
+    std::lock_guard lock{mutex_};
+    if (auto it = ids_.find(name); it != ids_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> TagDictionary::FindName(TagId id) const {
+    std::lock_guard lock{mutex_};
+    if (auto it = names_.find(id); it != names_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+void TagDictionary::Put(const std::vector<std::pair<TagId, std::string>>& tags) {
+    std::lock_guard lock{mutex_};
+    for (const auto& [id, name] : tags) {
+        ids_.emplace(name, id);
+        names_.emplace(id, name);
+    }
+}
+
+std::optional<TagId> StagedTags::FindId(const std::string& name) const {
+    if (auto id = dictionary_.FindId(name)) {
+        return id;
+    }
+    if (auto it = ids_.find(name); it != ids_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> StagedTags::FindName(TagId id) const {
+    if (auto name = dictionary_.FindName(id)) {
+        return name;
+    }
+    if (auto it = names_.find(id); it != names_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+void StagedTags::Add(TagId id, const std::string& name) {
+    ids_.emplace(name, id);
+    names_.emplace(id, name);
+}
+
+void StagedTags::Commit() {
+    std::vector<std::pair<TagId, std::string>> tags{names_.begin(), names_.end()};
+    dictionary_.Put(tags);
+    ids_.clear();
+    names_.clear();
+}
+
+}  // namespace postgres
@@ -0,0 +1,52 @@
+#pragma once
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace postgres {
+
+using TagId = int;
+
+/**
+ * Кэш словаря тегов (таблица tags): имя <-> id. Строки tags не удаляются и не меняются,
+ * поэтому закоммиченные пары не устаревают. Пары, созданные незакоммиченной транзакцией,
+ * добавляются только после её коммита. Потокобезопасен.
+ */
+class TagDictionary {
+public:
+    std::optional<TagId> FindId(const std::string& name) const;
+    std::optional<std::string> FindName(TagId id) const;
+    void Put(const std::vector<std::pair<TagId, std::string>>& tags);
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, TagId> ids_;
+    std::unordered_map<TagId, std::string> names_;
+};
+
+/**
+ * Пары словаря, прочитанные или созданные одной транзакцией. Видны только ей: в словарь
+ * переносятся Commit() после коммита транзакции, без Commit (откат) отбрасываются.
+ */
+class StagedTags {
+public:
+    explicit StagedTags(TagDictionary& dictionary)
+        : dictionary_{dictionary} {
+    }
+
+    // Сначала словарь, затем пары этой транзакции
+    std::optional<TagId> FindId(const std::string& name) const;
+    std::optional<std::string> FindName(TagId id) const;
+    void Add(TagId id, const std::string& name);
+    void Commit();
+
+private:
+    TagDictionary& dictionary_;
+    std::unordered_map<std::string, TagId> ids_;
+    std::unordered_map<TagId, std::string> names_;
+};
+
+}  // namespace postgres
@@ -3,9 +3,11 @@
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string.hpp>
 #include <cassert>
+#include <fstream>
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <tuple>
 
 #include "../app/use_cases.h"
 #include "../menu/menu.h"
@@ -60,6 +62,97 @@ std::vector<std::string> ParseTags(std::string tags_str){
 
 }  // namespace detail
 
+std::ostream& operator<<(std::ostream& out, const app::ChangeEvent& event) {
+    switch (event.op) {
+        case app::ChangeOp::kInsert: out << "insert "sv; break;
+        case app::ChangeOp::kUpdate: out << "update "sv; break;
+        case app::ChangeOp::kDelete: out << "delete "sv; break;
+        case app::ChangeOp::kReset: return out << "reset (changes may have been missed)"sv;
+    }
+    switch (event.entity) {
+        case app::EntityType::kAuthor: out << "author "sv; break;
+        case app::EntityType::kBook: out << "book "sv; break;
+        case app::EntityType::kBookTags: out << "book tags "sv; break;
+        case app::EntityType::kCatalog: break;
+    }
+    out << event.id;
+    if (event.local) {
+        out << " (local)"sv;
+    }
+    return out;
+}
+
+constexpr std::size_t PAGE_SIZE = 10;
+constexpr std::size_t SUGGESTIONS_LIMIT = 5;
+// Списки длиннее этого сначала сужаются по префиксу имени или названия
+constexpr std::size_t MAX_LISTED = 100;
+constexpr std::size_t COMPLETIONS_LIMIT = 20;
+
+// Аргументы "<path> [csv|ndjson]": формат - последнее слово или расширение файла
+std::pair<std::string, std::optional<app::ImportFormat>> ReadPathAndFormat(std::istream& cmd_input) {
+    std::string args;
+    std::getline(cmd_input, args);
+    boost::algorithm::trim(args);
+    auto read_format = [](std::string_view name) -> std::optional<app::ImportFormat> {
+        if (name == "csv"sv) {
+            return app::ImportFormat::kCsv;
+        }
+        if (name == "ndjson"sv || name == "jsonl"sv) {
+            return app::ImportFormat::kNdjson;
+        }
+        return std::nullopt;
+    };
+    std::optional<app::ImportFormat> format;
+    auto path = args;
+    if (auto space = args.find_last_of(' '); space != std::string::npos) {
+        if ((format = read_format(std::string_view{args}.substr(space + 1)))) {
+            path = args.substr(0, space);
+            boost::algorithm::trim(path);
+        }
+    }
+    if (!format) {
+        auto dot = path.find_last_of('.');
+        format = read_format(dot == std::string::npos ? ""sv : std::string_view{path}.substr(dot + 1));
+    }
+    return {path, format};
+}
+
+// Шаги команды в одной сессии use case'ов; сессия фиксируется, если шаги завершились без исключения
+template <typename Steps>
+bool RunInSession(app::UseCases& use_cases, bool read_only, Steps&& steps) {
+    auto session = use_cases.OpenSession(read_only);
+    bool result = steps();
+    session->Commit();
+    return result;
+}
+
+// Номер из списка размера size, nullopt - пустая строка
+std::optional<std::size_t> ReadIndex(std::istream& input, std::size_t size, const char* error) {
+    std::string str;
+    if (!std::getline(input, str) || str.empty()) {
+        return std::nullopt;
+    }
+    int idx;
+    try {
+        idx = std::stoi(str);
+    } catch (std::exception const&) {
+        throw std::runtime_error(error);
+    }
+    if (idx < 1 || static_cast<std::size_t>(idx) > size) {
+        throw std::runtime_error(error);
+    }
+    return static_cast<std::size_t>(idx - 1);
+}
+
+std::vector<detail::BookInfo> ToBookInfo(const std::vector<app::BookData>& books) {
+    std::vector<detail::BookInfo> book_info;
+    book_info.reserve(books.size());
+    for (const auto& [id, author_id, author_name, title, year] : books) {
+        book_info.push_back({id, title, author_name, year});
+    }
+    return book_info;
+}
+
 template <typename T>
 void PrintVector(std::ostream& out, const std::vector<T>& vector) {
     int i = 1;
@@ -68,11 +161,13 @@ void PrintVector(std::ostream& out, const std::vector<T>& vector) {
     }
 }
 
-View::View(menu::Menu& menu, app::UseCases& use_cases, std::istream& input, std::ostream& output)
+View::View(menu::Menu& menu, app::UseCases& use_cases, std::istream& input, std::ostream& output,
+           bool interactive)
     : menu_{menu}
     , use_cases_{use_cases}
     , input_{input}
-    , output_{output} {
+    , output_{output}
+    , interactive_{interactive} {
     menu_.AddAction(  //
         "AddAuthor"s, "name"s, "Adds author"s, std::bind(&View::AddAuthor, this, ph::_1)
         // либо
@@ -95,6 +190,22 @@ View::View(menu::Menu& menu, app::UseCases& use_cases, std::istream& input, std:
                     std::bind(&View::DeleteBook, this, ph::_1));
     menu_.AddAction("EditBook"s, "name"s, "Edit book"s,
                     std::bind(&View::EditBook, this, ph::_1));
+    menu_.AddAction("Watch"s, {}, "Show catalog changes made by any instance"s,
+                    std::bind(&View::Watch, this));
+    menu_.AddAction("SearchBooks"s, "query"s, "Full-text search by title, author and tags"s,
+                    std::bind(&View::SearchBooks, this, ph::_1));
+    menu_.AddAction("FindBooksByTags"s, {}, "Find books by tags"s,
+                    std::bind(&View::FindBooksByTags, this));
+    menu_.AddAction("TagStats"s, "[top count]"s, "Show the most popular tags"s,
+                    std::bind(&View::TagStats, this, ph::_1));
+    menu_.AddAction("ShowBooksByYearRange"s, "<from year> <to year>"s, "Show books published in the years range"s,
+                    std::bind(&View::ShowBooksByYearRange, this, ph::_1));
+    menu_.AddAction("Snapshot"s, "<path>"s, "Write authors, books and tags to a snapshot file"s,
+                    std::bind(&View::Snapshot, this, ph::_1));
+    menu_.AddAction("Import"s, "<path> [csv|ndjson]"s, "Import authors, books and tags from a CSV or NDJSON file"s,
+                    std::bind(&View::Import, this, ph::_1));
+    menu_.AddAction("Export"s, "<path|-> [csv|ndjson]"s, "Export books with authors and tags to a CSV or NDJSON file"s,
+                    std::bind(&View::Export, this, ph::_1));
 }
 
 bool View::AddAuthor(std::istream& cmd_input) const {
@@ -120,7 +231,15 @@ bool View::DeleteAuthor(std::istream &cmd_input) {
         std::getline(cmd_input, author_name);
         boost::algorithm::trim(author_name);
         if(!author_name.empty()){
-            use_cases_.DeleteAuthorByName(author_name);
+            try {
+                use_cases_.DeleteAuthorByName(author_name);
+            } catch (const std::exception&) {
+                auto author_id = SuggestAuthor(author_name);
+                if (!author_id) {
+                    throw;
+                }
+                use_cases_.DeleteAuthorById(*author_id);
+            }
             return true;
         }
         //-----
@@ -145,8 +264,15 @@ bool View::EditAuthor(std::istream &cmd_input) {
             std::string new_name;
             std::getline(input_, new_name);
             boost::algorithm::trim(new_name);
-            use_cases_.EditAuthorByName(old_name, new_name);
-
+            try {
+                use_cases_.EditAuthorByName(old_name, new_name);
+            } catch (const std::exception&) {
+                auto author_id = SuggestAuthor(old_name);
+                if (!author_id) {
+                    throw;
+                }
+                use_cases_.EditAuthorById(*author_id, new_name);
+            }
             return true;
         }
         //-----
@@ -166,15 +292,12 @@ bool View::EditAuthor(std::istream &cmd_input) {
     return true;
 }
 
+// Автор, книга и теги добавляются одним use case'ом, то есть одной транзакцией, уже после всего ввода
 bool View::AddBook(std::istream& cmd_input) const {
     try {
         if (auto params = GetBookParams(cmd_input)) {
-            //assert(!"TODO: implement book adding");
-            std::string book_id = use_cases_.AddBook(params->author_id, params->title, params->publication_year);
-            //TODO: Create book_tag
-            if(!params->tags.empty()){
-                use_cases_.AddBookTags(book_id, params->tags);
-            }
+            use_cases_.AddBookWithTags({params->author_id, params->new_author_name}, params->title,
+                                       params->publication_year, params->tags);
         }
     } catch (const std::exception& e) {
         //std::cout << e.what() << std::endl; //TODO: delete this
@@ -199,44 +322,31 @@ bool View::ShowBook(std::istream& cmd_input) {
         std::string book_name;
         std::getline(cmd_input, book_name);
         boost::algorithm::trim(book_name);
+        // Книга выбирается до сессии: вопросы пользователю не держат её открытой
+        std::optional<std::string> book_id;
+        std::optional<app::BookData> found;
         if(!book_name.empty()){
 
             std::vector<app::BookData> book_datas = use_cases_.ShowBooksByTitle(book_name);
             if(book_datas.empty()){
-                return true;
+                book_id = SuggestBook(book_name);
             } else if(book_datas.size() > 1) {
                 //TODO: Choose book by id
                 //SelectBookByName
-                if (auto book_id = SelectBookByName(book_name)) {
-
-                    app::ShowBookData show_data = use_cases_.ShowBookById(*book_id);
-                    //Print:
-                    output_ << "Title: " << show_data.title << std::endl;
-                    output_ << "Author: " << show_data.author_name << std::endl;
-                    output_ << "Publication year: " << show_data.publication_year << std::endl;
-                    if(!show_data.tags.empty()){
-                        output_ << "Tags: ";
-                    }
-                    bool first = true;
-                    for(const auto& tag : show_data.tags){
-                        if (!first) {
-                            output_ << ", "s;
-                        }
-                        first = false;
-                        output_ << tag;
-                    }
-                    if(!show_data.tags.empty()){
-                        output_ << std::endl;
-                    }
-
-                }
-
+                book_id = SelectBookByName(book_name);
             } else {    //Equal one book
+                found = book_datas.front();
+            }
+        } else {
+            book_id = SelectBook();
+        }
+        if (found) {
+            return RunInSession(use_cases_, true, [&] {
                 //Print:
-                output_ << "Title: " << book_datas.front().title << std::endl;
-                output_ << "Author: " << book_datas.front().author_name << std::endl;
-                output_ << "Publication year: " << book_datas.front().year << std::endl;
-                std::vector<std::string> tags = use_cases_.GetBookTagsById(book_datas.front().id);
+                output_ << "Title: " << found->title << std::endl;
+                output_ << "Author: " << found->author_name << std::endl;
+                output_ << "Publication year: " << found->year << std::endl;
+                std::vector<std::string> tags = use_cases_.GetBookTagsById(found->id);
                 if(!tags.empty()){
                     output_ << "Tags: ";
                 }
@@ -251,32 +361,16 @@ bool View::ShowBook(std::istream& cmd_input) {
                 if(!tags.empty()){
                     output_ << std::endl;
                 }
-            }
-            return true;
+                return true;
+            });
         }
-        //-----
-        if (auto book_id = SelectBook()) {
-            app::ShowBookData show_data = use_cases_.ShowBookById(*book_id);
-            //Print:
-            output_ << "Title: " << show_data.title << std::endl;
-            output_ << "Author: " << show_data.author_name << std::endl;
-            output_ << "Publication year: " << show_data.publication_year << std::endl;
-            if(!show_data.tags.empty()){
-                output_ << "Tags: ";
-            }
-            bool first = true;
-            for(const auto& tag : show_data.tags){
-                if (!first) {
-                    output_ << ", "s;
-                }
-                first = false;
-                output_ << tag;
-            }
-            if(!show_data.tags.empty()){
-                output_ << std::endl;
-            }
+        if (!book_id) {
+            return true;
         }
-
+        return RunInSession(use_cases_, true, [&] {
+            PrintBook(use_cases_.ShowBookById(*book_id));
+            return true;
+        });
     } catch (const std::exception& e) {
         //std::cout << e.what() << std::endl;     //TODO: delete this
         //throw std::runtime_error("Failed to show book");
@@ -285,11 +379,170 @@ bool View::ShowBook(std::istream& cmd_input) {
     return true;
 }
 
+// События печатаются из потока ChangeFeed, пока основной поток ждёт пустую строку
+bool View::Watch() const {
+    try {
+        output_ << "Watching changes, enter empty line to stop:"sv << std::endl;
+        auto subscription = use_cases_.SubscribeChanges([this](const app::ChangeEvent& event) {
+            output_ << event << std::endl;
+        });
+        std::string line;
+        while (std::getline(input_, line) && !line.empty()) {
+        }
+        use_cases_.UnsubscribeChanges(subscription);
+    } catch (const std::exception&) {
+        output_ << "Failed to watch changes"sv << std::endl;
+    }
+    return true;
+}
+
+bool View::SearchBooks(std::istream& cmd_input) const {
+    try {
+        std::string query;
+        std::getline(cmd_input, query);
+        boost::algorithm::trim(query);
+        if (query.empty()) {
+            throw std::logic_error("SearchBooks: query.empty()");
+        }
+        PrintPaged([this, &query](std::size_t page) {
+            // Лишняя запись показывает, есть ли следующая страница
+            auto found = use_cases_.SearchBooks(query, PAGE_SIZE + 1, page * PAGE_SIZE);
+            bool has_more = found.size() > PAGE_SIZE;
+            found.resize(std::min(found.size(), PAGE_SIZE));
+            return std::make_pair(ToBookInfo(found), has_more);
+        });
+    } catch (const std::exception&) {
+        output_ << "Failed to search books"sv << std::endl;
+    }
+    return true;
+}
+
+bool View::FindBooksByTags() const {
+    try {
+        auto read_tags = [this](std::string_view prompt) {
+            output_ << prompt << std::endl;
+            std::string tags_str;
+            std::getline(input_, tags_str);
+            return detail::ParseTags(tags_str);
+        };
+        auto all_of = read_tags("Enter tags the book must have (comma separated):"sv);
+        auto any_of = read_tags("Enter tags the book must have at least one of (comma separated):"sv);
+        auto none_of = read_tags("Enter tags the book must not have (comma separated):"sv);
+        std::vector<detail::BookInfo> books;
+        for (const auto& [id, author_id, author_name, title, year]
+                : use_cases_.FindBooksByTags(all_of, any_of, none_of)) {
+            books.push_back({id, title, author_name, year});
+        }
+        PrintVector(output_, books);
+    } catch (const std::exception&) {
+        output_ << "Failed to find books"sv << std::endl;
+    }
+    return true;
+}
+
+bool View::TagStats(std::istream& cmd_input) const {
+    try {
+        std::size_t top_k = PAGE_SIZE;
+        std::string top_k_str;
+        std::getline(cmd_input, top_k_str);
+        boost::algorithm::trim(top_k_str);
+        if (!top_k_str.empty()) {
+            top_k = std::stoul(top_k_str);
+        }
+        int i = 1;
+        for (const auto& [tag, book_count] : use_cases_.TagStats(top_k)) {
+            output_ << i++ << " " << tag << ": " << book_count << std::endl;
+        }
+    } catch (const std::exception&) {
+        output_ << "Failed to show tag stats"sv << std::endl;
+    }
+    return true;
+}
+
+bool View::ShowBooksByYearRange(std::istream& cmd_input) const {
+    try {
+        int from = 0;
+        int to = 0;
+        if (!(cmd_input >> from >> to)) {
+            throw std::logic_error("ShowBooksByYearRange: invalid years");
+        }
+        PrintPaged([this, from, to](std::size_t page) {
+            auto [books, has_more] = use_cases_.ShowBooksByYearRange(from, to, page, PAGE_SIZE);
+            return std::make_pair(ToBookInfo(books), has_more);
+        });
+    } catch (const std::exception&) {
+        output_ << "Failed to show books"sv << std::endl;
+    }
+    return true;
+}
+
+bool View::Snapshot(std::istream& cmd_input) const {
+    try {
+        std::string path;
+        std::getline(cmd_input, path);
+        boost::algorithm::trim(path);
+        if (path.empty()) {
+            throw std::logic_error("Snapshot: path.empty()");
+        }
+        use_cases_.WriteSnapshot(path);
+    } catch (const std::exception&) {
+        output_ << "Failed to write snapshot"sv << std::endl;
+    }
+    return true;
+}
+
+bool View::Import(std::istream& cmd_input) const {
+    try {
+        auto [path, format] = ReadPathAndFormat(cmd_input);
+        if (path.empty() || !format) {
+            throw std::logic_error("Import: unknown format");
+        }
+        auto stats = use_cases_.ImportCatalog(path, *format, [this](const app::ImportStats& progress) {
+            output_ << "Imported "sv << progress.records << " records"sv << std::endl;
+        });
+        output_ << "Added "sv << stats.authors << " authors, "sv << stats.books << " books, "sv
+                << stats.book_tags << " book tags"sv << std::endl;
+    } catch (const std::invalid_argument& e) {
+        output_ << "Failed to import catalog: "sv << e.what() << std::endl;
+    } catch (const std::exception&) {
+        output_ << "Failed to import catalog"sv << std::endl;
+    }
+    return true;
+}
+
+bool View::Export(std::istream& cmd_input) const {
+    try {
+        auto [path, format] = ReadPathAndFormat(cmd_input);
+        if (path.empty() || !format) {
+            throw std::logic_error("Export: unknown format");
+        }
+        // "-" - в вывод программы, без итоговой строки, чтобы его можно было сразу передать дальше
+        if (path == "-"sv) {
+            use_cases_.ExportCatalog(output_, *format);
+            return true;
+        }
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        if (!file) {
+            throw std::logic_error("Export: cannot open file");
+        }
+        auto count = use_cases_.ExportCatalog(file, *format);
+        output_ << "Exported "sv << count << " books"sv << std::endl;
+    } catch (const std::exception&) {
+        output_ << "Failed to export catalog"sv << std::endl;
+    }
+    return true;
+}
+
 bool View::ShowAuthorBooks() const {
     try {
-        if (auto author_id = SelectAuthor()) {
-            PrintVector(output_, GetAuthorBooks(*author_id));
+        auto author_id = SelectAuthor();
+        if (!author_id) {
+            return true;
         }
+        return RunInSession(use_cases_, true, [&] {
+            PrintVector(output_, GetAuthorBooks(*author_id));
+            return true;
+        });
     } catch (const std::exception& e) {
         //std::cout << e.what() << std::endl;
         //throw std::runtime_error("Failed to Show Books");
@@ -323,8 +576,7 @@ std::optional<detail::AddBookParams> View::GetBookParams(std::istream& cmd_input
             if(answer_yes != "y" ){
                 throw std::logic_error("GetBookParams: answer_yes != yes");
             }
-            params.author_id =  use_cases_.AddAuthor(author_name);  //TODO: add author without commit
-            //TODO: add tags
+            params.new_author_name = author_name;
             output_ << "Enter tags (comma separated):" << std::endl;
             std::string tags_str;
             std::getline(input_, tags_str);
@@ -358,7 +610,25 @@ std::optional<detail::AddBookParams> View::GetBookParams(std::istream& cmd_input
 std::optional<std::string> View::SelectAuthor() const {
 
     output_ << "Select author:" << std::endl;
-    auto authors = GetAuthors();
+    std::vector<detail::AuthorInfo> authors;
+    if (use_cases_.CountCatalog().authors > MAX_LISTED) {
+        // Большой список не загружается: читаются по id только авторы с введённым префиксом
+        output_ << "Enter author name prefix or empty line to cancel:"sv << std::endl;
+        std::string prefix;
+        if (!std::getline(input_, prefix) || prefix.empty()) {
+            return std::nullopt;
+        }
+        for (auto& id : use_cases_.Autocomplete(prefix, COMPLETIONS_LIMIT).author_ids) {
+            if (auto name = use_cases_.ShowAuthorById(id)) {
+                authors.push_back({std::move(id), std::move(*name)});
+            }
+        }
+        std::sort(authors.begin(), authors.end(), [](const detail::AuthorInfo& lhs, const detail::AuthorInfo& rhs) {
+            return lhs.name < rhs.name;
+        });
+    } else {
+        authors = GetAuthors();
+    }
     PrintVector(output_, authors);
     output_ << "Enter author # or empty line to cancel" << std::endl;
 
@@ -385,7 +655,28 @@ std::optional<std::string> View::SelectAuthor() const {
 //TODO: SelectBook()
 std::optional<std::string> View::SelectBook() const {
 
-    auto book_info = GetBooks();
+    std::vector<detail::BookInfo> book_info;
+    if (use_cases_.CountCatalog().books > MAX_LISTED) {
+        output_ << "Enter book title prefix or empty line to cancel:"sv << std::endl;
+        std::string prefix;
+        if (!std::getline(input_, prefix) || prefix.empty()) {
+            return std::nullopt;
+        }
+        for (auto& id : use_cases_.Autocomplete(prefix, COMPLETIONS_LIMIT).book_ids) {
+            auto book = use_cases_.ShowBookById(id);
+            if (!book.title.empty()) {
+                book_info.push_back({std::move(id), std::move(book.title), std::move(book.author_name),
+                                     book.publication_year});
+            }
+        }
+        // Порядок как в ShowBooks
+        std::sort(book_info.begin(), book_info.end(), [](const detail::BookInfo& lhs, const detail::BookInfo& rhs) {
+            return std::tie(lhs.title, lhs.author_name, lhs.publication_year)
+                   < std::tie(rhs.title, rhs.author_name, rhs.publication_year);
+        });
+    } else {
+        book_info = GetBooks();
+    }
     PrintVector(output_, book_info);
     output_ << "Enter the book # or empty line to cancel:" << std::endl;
     std::string str;
@@ -433,6 +724,126 @@ std::optional<std::string> View::SelectBookByName(const std::string &title) cons
         return book_info[book_idx].id;
 }
 
+void View::PrintPaged(const PageFetcher& fetch) const {
+    std::size_t number = 0;
+    for (std::size_t page = 0;; ++page) {
+        auto [books, has_more] = fetch(page);
+        for (const auto& book : books) {
+            output_ << ++number << " " << book << std::endl;
+        }
+        if (!has_more) {
+            return;
+        }
+        output_ << "Enter any text for the next page or empty line to stop:"sv << std::endl;
+        std::string str;
+        if (!std::getline(input_, str) || str.empty()) {
+            return;
+        }
+    }
+}
+
+// Точного совпадения нет: предлагает похожие имена, nullopt - похожих нет или выбор отменён.
+// Без interactive_ похожие только выводятся: выбор прочитал бы следующую команду
+std::optional<std::string> View::SuggestAuthor(const std::string& name) const {
+    auto similar = use_cases_.FindSimilarAuthors(name, SUGGESTIONS_LIMIT);
+    if (similar.empty()) {
+        return std::nullopt;
+    }
+    std::vector<detail::AuthorInfo> authors;
+    for (auto& [id, author_name] : similar) {
+        authors.push_back({std::move(id), std::move(author_name)});
+    }
+    output_ << "Did you mean:"sv << std::endl;
+    PrintVector(output_, authors);
+    if (!interactive_) {
+        return std::nullopt;
+    }
+    output_ << "Enter author # or empty line to cancel" << std::endl;
+    if (auto author_idx = ReadIndex(input_, authors.size(), "Invalid author num")) {
+        return authors[*author_idx].id;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> View::SuggestBook(const std::string& title) const {
+    std::vector<detail::BookInfo> books;
+    for (const auto& [id, author_id, author_name, book_title, year]
+            : use_cases_.FindSimilarBooks(title, SUGGESTIONS_LIMIT)) {
+        books.push_back({id, book_title, author_name, year});
+    }
+    if (books.empty()) {
+        return std::nullopt;
+    }
+    output_ << "Did you mean:"sv << std::endl;
+    PrintVector(output_, books);
+    if (!interactive_) {
+        return std::nullopt;
+    }
+    output_ << "Enter the book # or empty line to cancel:" << std::endl;
+    if (auto book_idx = ReadIndex(input_, books.size(), "Invalid book num")) {
+        return books[*book_idx].id;
+    }
+    return std::nullopt;
+}
+
+void View::PrintBook(const app::ShowBookData& show_data) const {
+    output_ << "Title: " << show_data.title << std::endl;
+    output_ << "Author: " << show_data.author_name << std::endl;
+    output_ << "Publication year: " << show_data.publication_year << std::endl;
+    if(!show_data.tags.empty()){
+        output_ << "Tags: ";
+    }
+    bool first = true;
+    for(const auto& tag : show_data.tags){
+        if (!first) {
+            output_ << ", "s;
+        }
+        first = false;
+        output_ << tag;
+    }
+    if(!show_data.tags.empty()){
+        output_ << std::endl;
+    }
+}
+
+void View::EditBookById(const std::string& book_id) const {
+    std::optional<std::string> new_title_opt;
+    std::optional<int> new_year_opt;
+    app::ShowBookData show_data = use_cases_.ShowBookById(book_id);
+    //Title
+    output_ << "Enter new title or empty line to use the current one (" << show_data.title <<"):" << std::endl;
+    std::string new_title;
+    std::getline(input_, new_title);
+    boost::algorithm::trim(new_title);
+    if(!new_title.empty()){
+        new_title_opt = new_title;
+    }
+    //Year
+    output_ << "Enter publication year or empty line to use the current one (" << show_data.publication_year <<"):" << std::endl;
+    std::string new_year_str;
+    std::getline(input_, new_year_str);
+    boost::algorithm::trim(new_year_str);
+    if(!new_year_str.empty()){
+        int new_year = stoi(new_year_str);
+        new_year_opt = new_year;
+    }
+    //
+    output_ << "Enter tags (current tags: ";
+    bool first = true;
+    for(const auto& tag : show_data.tags){
+        if (!first) {
+            output_ << ", "s;
+        }
+        first = false;
+        output_ << tag;
+    }
+    output_ << "):" << std::endl;
+    //New tags
+    std::string tags_str;
+    std::getline(input_, tags_str);
+    use_cases_.PatchBook(book_id, new_title_opt, new_year_opt, detail::ParseTags(tags_str));
+}
+
 std::vector<detail::AuthorInfo> View::GetAuthors() const {
     std::vector<detail::AuthorInfo> dst_autors;
     //assert(!"TODO: implement GetAuthors()");
@@ -477,45 +888,50 @@ std::vector<detail::BookInfo> View::GetAuthorBooks(const std::string& a_id) cons
     return books;
 }
 
+    // Книга выбирается до открытия сессии: транзакция не держит блокировки, пока пользователь вводит номер
     bool View::DeleteBook(std::istream &cmd_input) {
 
         try {
             std::string book_name;
             std::getline(cmd_input, book_name);
             boost::algorithm::trim(book_name);
+            std::optional<std::string> book_id;
+            bool by_name = false;
             if(!book_name.empty()){
 
                 std::vector<app::BookData> book_datas = use_cases_.ShowBooksByTitle(book_name);
                 if(book_datas.empty()){
-                    throw std::logic_error("DeleteBook: book not exist");
-                    return false;
+                    book_id = SuggestBook(book_name);
+                    if (!book_id) {
+                        throw std::logic_error("DeleteBook: book not exist");
+                    }
                 } else if(book_datas.size() > 1) {
                     //TODO: Choose book by id
                     //SelectBookByName
-                    if (auto book_id = SelectBookByName(book_name)) {
-                        std::vector<std::string> tags = use_cases_.GetBookTagsById(*book_id);
-                        if(!tags.empty()){
-                            use_cases_.DeleteBookTagsById(*book_id);
-                        }
-                        use_cases_.DeleteBookById(*book_id);
-                    }
+                    book_id = SelectBookByName(book_name);
                 } else {    //Equal one book
-                    std::vector<std::string> tags = use_cases_.GetBookTagsById(book_datas.front().id);
-                    if(!tags.empty()){
-                        use_cases_.DeleteBookTagsById(book_datas.front().id);
-                    }
-                    use_cases_.DeleteBookByName(book_name);
+                    book_id = book_datas.front().id;
+                    by_name = true;
                 }
+            } else {
+                book_id = SelectBook();
+            }
+            if (!book_id) {
                 return true;
             }
-            //-----
-            if (auto book_id = SelectBook()) {
+            //Теги и книга удаляются в одной сессии
+            return RunInSession(use_cases_, false, [&] {
                 std::vector<std::string> tags = use_cases_.GetBookTagsById(*book_id);
                 if(!tags.empty()){
                     use_cases_.DeleteBookTagsById(*book_id);
                 }
-                use_cases_.DeleteBookById(*book_id);
-            }
+                if (by_name) {
+                    use_cases_.DeleteBookByName(book_name);
+                } else {
+                    use_cases_.DeleteBookById(*book_id);
+                }
+                return true;
+            });
         } catch (const std::exception& e) {
             //std::cout << e.what() << std::endl;     //TODO: delete this
             //throw std::runtime_error("Failed to delete book");
@@ -525,6 +941,7 @@ std::vector<detail::BookInfo> View::GetAuthorBooks(const std::string& a_id) cons
         return true;
     }
 
+    // Название, год и теги меняются одним use case'ом PatchBook после всего ввода, поэтому сессия не нужна
     bool View::EditBook(std::istream &cmd_input) {
 
         try {
@@ -538,57 +955,17 @@ std::vector<detail::BookInfo> View::GetAuthorBooks(const std::string& a_id) cons
 
                 std::vector<app::BookData> book_datas = use_cases_.ShowBooksByTitle(book_name);
                 if(book_datas.empty()){
+                    if (auto book_id = SuggestBook(book_name)) {
+                        EditBookById(*book_id);
+                        return true;
+                    }
                     throw std::logic_error("EditBook: book not exist");
                     return false;
                 } else if(book_datas.size() > 1) {
                     //TODO: Choose book by id
                     //SelectBookByName
                     if (auto book_id = SelectBookByName(book_name)) {
-
-                        app::ShowBookData show_data = use_cases_.ShowBookById(*book_id);
-                        //Title
-                        output_ << "Enter new title or empty line to use the current one (" << show_data.title <<"):" << std::endl;
-                        std::string new_title;
-                        std::getline(input_, new_title);
-                        boost::algorithm::trim(new_title);
-                        if(!new_title.empty()){
-                            new_title_opt = new_title;
-                        }
-                        //Year
-                        output_ << "Enter publication year or empty line to use the current one (" << show_data.publication_year <<"):" << std::endl;
-                        std::string new_year_str;
-                        std::getline(input_, new_year_str);
-                        boost::algorithm::trim(new_year_str);
-                        if(!new_year_str.empty()){
-                            int new_year = stoi(new_year_str);
-                            new_year_opt = new_year;
-                        }
-                        //
-                        output_ << "Enter tags (current tags: ";
-                        bool first = true;
-                        for(const auto& tag : show_data.tags){
-                            if (!first) {
-                                output_ << ", "s;
-                            }
-                            first = false;
-                            output_ << tag;
-                        }
-                        output_ << "):" << std::endl;
-                        //New tags
-                        std::string tags_str;
-                        std::getline(input_, tags_str);
-                        std::vector<std::string> new_tags;
-
-                        if(new_title_opt){
-                            use_cases_.EditBookTitleById(*book_id, *new_title_opt);
-                        }
-                        if(new_year_opt){
-                            use_cases_.EditBookYearById(*book_id, *new_year_opt);
-                        }
-                        new_tags = detail::ParseTags(tags_str);
-                        use_cases_.EditBookTagsById(*book_id, new_tags);
-
-
+                        EditBookById(*book_id);
                     }
                     else
                     {
@@ -629,65 +1006,15 @@ std::vector<detail::BookInfo> View::GetAuthorBooks(const std::string& a_id) cons
                     //New tags
                     std::string tags_str;
                     std::getline(input_, tags_str);
-                    std::vector<std::string> new_tags;
-
-                    if(new_title_opt){
-                        use_cases_.EditBookTitleById(book_datas.front().id, *new_title_opt);
-                    }
-                    if(new_year_opt){
-                        use_cases_.EditBookYearById(book_datas.front().id, *new_year_opt);
-                    }
-                    new_tags = detail::ParseTags(tags_str);
-                    use_cases_.EditBookTagsById(book_datas.front().id, new_tags);
+                    use_cases_.PatchBook(book_datas.front().id, new_title_opt, new_year_opt,
+                                         detail::ParseTags(tags_str));
 
                 }
                 return true;
             }
             //-----
             if (auto book_id = SelectBook()) {
-                app::ShowBookData show_data = use_cases_.ShowBookById(*book_id);
-                //Title
-                output_ << "Enter new title or empty line to use the current one (" << show_data.title <<"):" << std::endl;
-                std::string new_title;
-                std::getline(input_, new_title);
-                boost::algorithm::trim(new_title);
-                if(!new_title.empty()){
-                    new_title_opt = new_title;
-                }
-                //Year
-                output_ << "Enter publication year or empty line to use the current one (" << show_data.publication_year <<"):" << std::endl;
-                std::string new_year_str;
-                std::getline(input_, new_year_str);
-                boost::algorithm::trim(new_year_str);
-                if(!new_year_str.empty()){
-                    int new_year = stoi(new_year_str);
-                    new_year_opt = new_year;
-                }
-                //
-                output_ << "Enter tags (current tags: ";
-                bool first = true;
-                for(const auto& tag : show_data.tags){
-                    if (!first) {
-                        output_ << ", "s;
-                    }
-                    first = false;
-                    output_ << tag;
-                }
-                output_ << "):" << std::endl;
-                //New tags
-                std::string tags_str;
-                std::getline(input_, tags_str);
-                std::vector<std::string> new_tags;
-
-                if(new_title_opt){
-                    use_cases_.EditBookTitleById(*book_id, *new_title_opt);
-                }
-                if(new_year_opt){
-                    use_cases_.EditBookYearById(*book_id, *new_year_opt);
-                }
-                new_tags = detail::ParseTags(tags_str);
-                use_cases_.EditBookTagsById(*book_id, new_tags);
-
+                EditBookById(*book_id);
             }
             else
             {
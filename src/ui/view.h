@@ -1,9 +1,12 @@
 #pragma once
+#include <cstddef>
+#include <functional>
 #include <iosfwd>
 #include <optional>
 #include <string>
 #include <vector>
 #include <set>
+#include <utility>
 
 namespace menu {
 class Menu;
@@ -11,6 +14,7 @@ class Menu;
 
 namespace app {
 class UseCases;
+struct ShowBookData;
 }
 
 namespace ui {
@@ -19,6 +23,7 @@ namespace detail {
 struct AddBookParams {
     std::string title;
     std::string author_id;
+    std::string new_author_name;    // author_id пуст - автор создаётся вместе с книгой
     int publication_year = 0;
     std::vector<std::string> tags;
 };
@@ -39,7 +44,10 @@ struct BookInfo {
 
 class View {
 public:
-    View(menu::Menu& menu, app::UseCases& use_cases, std::istream& input, std::ostream& output);
+    // interactive - ввод набирает человек: на промах по имени можно выбрать из похожих.
+    // Иначе (ввод из файла или канала) похожие только выводятся, следующая строка остаётся командой
+    View(menu::Menu& menu, app::UseCases& use_cases, std::istream& input, std::ostream& output,
+         bool interactive = false);
 
 private:
     bool AddAuthor(std::istream& cmd_input) const;
@@ -52,20 +60,37 @@ private:
     bool ShowBook(std::istream& cmd_input);
     bool DeleteBook(std::istream& cmd_input);
     bool EditBook(std::istream& cmd_input);
+    bool Watch() const;
+    bool SearchBooks(std::istream& cmd_input) const;
+    bool FindBooksByTags() const;
+    bool TagStats(std::istream& cmd_input) const;
+    bool ShowBooksByYearRange(std::istream& cmd_input) const;
+    bool Snapshot(std::istream& cmd_input) const;
+    bool Import(std::istream& cmd_input) const;
+    bool Export(std::istream& cmd_input) const;
 
     std::optional<detail::AddBookParams> GetBookParams(std::istream& cmd_input) const;
     std::optional<std::string> SelectAuthor() const;
     std::optional<std::string> SelectBook() const;
     std::optional<std::string> SelectBookByName(const std::string& title) const;
+    std::optional<std::string> SuggestAuthor(const std::string& name) const;
+    std::optional<std::string> SuggestBook(const std::string& title) const;
+    void PrintBook(const app::ShowBookData& show_data) const;
+    void EditBookById(const std::string& book_id) const;
     std::vector<detail::AuthorInfo> GetAuthors() const;
     std::vector<detail::BookInfo> GetBooks() const;
     std::vector<detail::BookInfo> GetBooksByName(const std::string& title) const;
     std::vector<detail::BookInfo> GetAuthorBooks(const std::string& author_id) const;
+    // Страница с номером page (с нуля) и признак того, что за ней есть ещё
+    using PageFetcher = std::function<std::pair<std::vector<detail::BookInfo>, bool>(std::size_t page)>;
+    // Печать постранично со сквозной нумерацией
+    void PrintPaged(const PageFetcher& fetch) const;
 
     menu::Menu& menu_;
     app::UseCases& use_cases_;
     std::istream& input_;
     std::ostream& output_;
+    bool interactive_;
 };
 
 }  // namespace ui
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace util {
+namespace {
+
+// FNV-1a: вторая, независимая от std::hash функция для двойного хеширования
+std::uint64_t Fnv1a(std::string_view key) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+}  // namespace
+
+BloomFilter::BloomFilter(std::size_t expected_items, double false_positive_rate, std::size_t max_bytes) {
+    const double ln2 = std::log(2.0);
+    expected_items = std::max<std::size_t>(expected_items, 1);
+    false_positive_rate = std::clamp(false_positive_rate, 1e-9, 0.5);
+    auto bits = static_cast<std::size_t>(
+        std::ceil(-static_cast<double>(expected_items) * std::log(false_positive_rate) / (ln2 * ln2)));
+    bits = std::clamp<std::size_t>(bits, 64, std::max<std::size_t>(max_bytes, 8) * 8);
+    bits_.assign((bits + 63) / 64, 0);
+    bit_count_ = bits_.size() * 64;
+    hash_count_ = std::clamp<std::size_t>(
+        static_cast<std::size_t>(std::round(static_cast<double>(bit_count_) / expected_items * ln2)), 1, 16);
+}
+
+// Двойное хеширование (Kirsch-Mitzenmacher): i-й хеш = h1 + i * h2
+void BloomFilter::Add(std::string_view key) {
+    const std::uint64_t h1 = std::hash<std::string_view>{}(key);
+    const std::uint64_t h2 = Fnv1a(key) | 1;
+    for (std::size_t i = 0; i < hash_count_; ++i) {
+        const std::uint64_t bit = (h1 + i * h2) % bit_count_;
+        bits_[bit / 64] |= std::uint64_t{1} << (bit % 64);
+    }
+}
+
+bool BloomFilter::MayContain(std::string_view key) const {
+    const std::uint64_t h1 = std::hash<std::string_view>{}(key);
+    const std::uint64_t h2 = Fnv1a(key) | 1;
+    for (std::size_t i = 0; i < hash_count_; ++i) {
+        const std::uint64_t bit = (h1 + i * h2) % bit_count_;
+        if ((bits_[bit / 64] & (std::uint64_t{1} << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace util
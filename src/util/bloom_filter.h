@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+/**
+ * Фильтр Блума над строками: MayContain() == false означает, что строка точно не добавлялась.
+ * Размер подбирается по ожидаемому числу элементов и желаемой доле ложных срабатываний,
+ * но не превышает max_bytes (тогда доля ложных срабатываний будет выше заданной).
+ */
+class BloomFilter {
+public:
+    BloomFilter(std::size_t expected_items, double false_positive_rate, std::size_t max_bytes);
+
+    void Add(std::string_view key);
+    bool MayContain(std::string_view key) const;
+
+    std::size_t GetSizeBytes() const noexcept {
+        return bits_.size() * sizeof(std::uint64_t);
+    }
+
+    std::size_t GetHashCount() const noexcept {
+        return hash_count_;
+    }
+
+private:
+    std::vector<std::uint64_t> bits_;
+    std::size_t bit_count_ = 0;
+    std::size_t hash_count_ = 1;
+};
+
+}  // namespace util
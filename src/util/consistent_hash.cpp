@@ -0,0 +1,51 @@
+#include "consistent_hash.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace util {
+namespace {
+
+// FNV-1a с перемешиванием из splitmix64: у близких строк ("shard-1#2", "shard-1#3") точки
+// разбросаны по всему кольцу
+std::uint64_t StableHash(std::string_view key) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+}  // namespace
+
+ConsistentHashRing::ConsistentHashRing(std::size_t nodes, std::size_t virtual_nodes)
+    : nodes_(nodes) {
+    if (nodes == 0) {
+        throw std::invalid_argument("Consistent hash ring needs at least one node");
+    }
+    virtual_nodes = std::max<std::size_t>(virtual_nodes, 1);
+    ring_.reserve(nodes * virtual_nodes);
+    for (std::size_t node = 0; node < nodes; ++node) {
+        for (std::size_t point = 0; point < virtual_nodes; ++point) {
+            ring_.emplace_back(StableHash("shard-" + std::to_string(node) + "#" + std::to_string(point)), node);
+        }
+    }
+    std::sort(ring_.begin(), ring_.end());
+}
+
+std::size_t ConsistentHashRing::GetNode(std::string_view key) const {
+    auto hash = StableHash(key);
+    auto it = std::lower_bound(ring_.begin(), ring_.end(), hash, [](const auto& point, std::uint64_t value) {
+        return point.first < value;
+    });
+    return it == ring_.end() ? ring_.front().second : it->second;
+}
+
+}  // namespace util
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+/**
+ * Кольцо согласованного хеширования: ключ принадлежит узлу первой точки кольца не меньше
+ * хеша ключа. У каждого узла virtual_nodes точек, чтобы ключи делились поровну. Хеш не зависит
+ * от платформы и запуска, поэтому размещение данных по узлам стабильно, а при добавлении
+ * узла в конец на новый узел переезжает лишь около 1/N ключей.
+ */
+class ConsistentHashRing {
+public:
+    explicit ConsistentHashRing(std::size_t nodes, std::size_t virtual_nodes = 128);
+
+    std::size_t GetNode(std::string_view key) const;
+
+    std::size_t GetNodeCount() const noexcept {
+        return nodes_;
+    }
+
+private:
+    std::vector<std::pair<std::uint64_t, std::size_t>> ring_;   // точка, узел; по возрастанию
+    std::size_t nodes_;
+};
+
+}  // namespace util
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+/**
+ * Слияние k упорядоченных по less последовательностей в одну: O(n log k) через кучу из
+ * голов последовательностей. Равные элементы идут в порядке номеров последовательностей,
+ * так что результат детерминирован. Не более limit элементов после пропуска offset первых.
+ */
+template <typename T, typename Less = std::less<T>>
+std::vector<T> MergeSorted(std::vector<std::vector<T>> runs, Less less = {}, std::size_t offset = 0,
+                           std::size_t limit = static_cast<std::size_t>(-1)) {
+    using Head = std::pair<std::size_t, std::size_t>;    // последовательность, позиция
+    auto greater = [&runs, &less](const Head& lhs, const Head& rhs) {
+        const auto& a = runs[lhs.first][lhs.second];
+        const auto& b = runs[rhs.first][rhs.second];
+        if (less(b, a)) {
+            return true;
+        }
+        return !less(a, b) && lhs.first > rhs.first;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads{greater};
+    for (std::size_t run = 0; run < runs.size(); ++run) {
+        if (!runs[run].empty()) {
+            heads.emplace(run, 0);
+        }
+    }
+    std::vector<T> merged;
+    while (!heads.empty() && merged.size() < limit) {
+        auto [run, pos] = heads.top();
+        heads.pop();
+        if (offset > 0) {
+            --offset;
+        } else {
+            merged.push_back(std::move(runs[run][pos]));
+        }
+        if (pos + 1 < runs[run].size()) {
+            heads.emplace(run, pos + 1);
+        }
+    }
+    return merged;
+}
+
+}  // namespace util
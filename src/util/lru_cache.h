@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace util {
+
+/**
+ * Кэш с вытеснением давно не использованных элементов (LRU).
+ * Ёмкость задаётся в байтах: при добавлении элемента указывается его примерный размер,
+ * и самые старые элементы вытесняются, пока суммарный размер не уложится в ёмкость.
+ * Класс не потокобезопасен, синхронизацию обеспечивает владелец.
+ */
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(std::size_t capacity_bytes)
+        : capacity_bytes_(capacity_bytes) {
+    }
+
+    std::optional<Value> Get(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return std::nullopt;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->value;
+    }
+
+    // Элемент, не помещающийся в кэш целиком, не сохраняется
+    void Put(const Key& key, Value value, std::size_t size_bytes) {
+        Erase(key);
+        if (size_bytes > capacity_bytes_) {
+            return;
+        }
+        while (size_bytes_ + size_bytes > capacity_bytes_) {
+            EraseEntry(std::prev(entries_.end()));
+        }
+        entries_.push_front({key, std::move(value), size_bytes});
+        index_.emplace(key, entries_.begin());
+        size_bytes_ += size_bytes;
+    }
+
+    void Erase(const Key& key) {
+        if (auto it = index_.find(key); it != index_.end()) {
+            EraseEntry(it->second);
+        }
+    }
+
+    template <typename Predicate>
+    void EraseIf(Predicate pred) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            auto next = std::next(it);
+            if (pred(it->key, it->value)) {
+                EraseEntry(it);
+            }
+            it = next;
+        }
+    }
+
+    void Clear() {
+        index_.clear();
+        entries_.clear();
+        size_bytes_ = 0;
+    }
+
+    std::size_t GetCount() const noexcept {
+        return entries_.size();
+    }
+
+    std::size_t GetSizeBytes() const noexcept {
+        return size_bytes_;
+    }
+
+    std::size_t GetCapacityBytes() const noexcept {
+        return capacity_bytes_;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        std::size_t size_bytes;
+    };
+    using EntryIt = typename std::list<Entry>::iterator;
+
+    void EraseEntry(EntryIt it) {
+        size_bytes_ -= it->size_bytes;
+        index_.erase(it->key);
+        entries_.erase(it);
+    }
+
+    std::size_t capacity_bytes_;
+    std::size_t size_bytes_ = 0;
+    std::list<Entry> entries_;
+    std::unordered_map<Key, EntryIt, Hasher> index_;
+};
+
+}  // namespace util
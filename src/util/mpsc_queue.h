@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace util {
+
+/**
+ * Неограниченная очередь многих производителей и одного потребителя (алгоритм Вьюкова).
+ * Push из любого потока без блокировок - один atomic exchange; Pop вызывает только
+ * потребитель. Порядок элементов - порядок exchange в Push.
+ *
+ * Производитель, прерванный между exchange и связыванием звена, ненадолго "закрывает"
+ * очередь: Pop вернёт nullopt, хотя за ним уже есть элементы. Поэтому потребитель не
+ * должен считать nullopt признаком того, что все Push завершились, - для ожидания нужен
+ * отдельный сигнал после Push.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue()
+        : head_{new Node{}}, tail_{head_.load(std::memory_order_relaxed)} {
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        while (Pop()) {
+        }
+        delete tail_;
+    }
+
+    void Push(T value) {
+        auto* node = new Node{std::move(value)};
+        auto* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    std::optional<T> Pop() {
+        auto* tail = tail_;
+        auto* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return std::nullopt;
+        }
+        // next становится новым пустым звеном-заглушкой
+        std::optional<T> value{std::move(next->value)};
+        next->value.reset();
+        tail_ = next;
+        delete tail;
+        return value;
+    }
+
+private:
+    struct Node {
+        std::optional<T> value;
+        std::atomic<Node*> next{nullptr};
+    };
+
+    std::atomic<Node*> head_;   // последнее добавленное звено
+    Node* tail_;                // заглушка перед первым элементом, только у потребителя
+};
+
+}  // namespace util
@@ -0,0 +1,101 @@
+#include "posting_list.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+namespace util {
+namespace {
+
+// Во сколько раз длинный список должен превосходить короткий, чтобы галоп был выгоднее слияния
+constexpr std::size_t GALLOP_RATIO = 16;
+
+using Iterator = PostingList::const_iterator;
+
+// Первый элемент >= value: шаги 1, 2, 4... от first, затем двоичный поиск в найденном отрезке
+Iterator Gallop(Iterator first, Iterator last, std::uint32_t value) {
+    std::size_t step = 1;
+    auto lo = first;
+    while (lo != last && *lo < value) {
+        first = lo;
+        if (static_cast<std::size_t>(last - lo) <= step) {
+            lo = last;
+            break;
+        }
+        lo += step;
+        step *= 2;
+    }
+    return std::lower_bound(first, lo, value);
+}
+
+PostingList GallopIntersect(const PostingList& small, const PostingList& large) {
+    PostingList result;
+    result.reserve(small.size());
+    auto it = large.begin();
+    for (auto value : small) {
+        it = Gallop(it, large.end(), value);
+        if (it == large.end()) {
+            break;
+        }
+        if (*it == value) {
+            result.push_back(value);
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+PostingList Intersect(const PostingList& lhs, const PostingList& rhs) {
+    const auto& small = lhs.size() <= rhs.size() ? lhs : rhs;
+    const auto& large = lhs.size() <= rhs.size() ? rhs : lhs;
+    if (small.empty()) {
+        return {};
+    }
+    if (large.size() / small.size() >= GALLOP_RATIO) {
+        return GallopIntersect(small, large);
+    }
+    PostingList result;
+    result.reserve(small.size());
+    std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result));
+    return result;
+}
+
+PostingList Unite(const PostingList& lhs, const PostingList& rhs) {
+    PostingList result;
+    result.reserve(lhs.size() + rhs.size());
+    std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result));
+    return result;
+}
+
+PostingList Subtract(const PostingList& lhs, const PostingList& rhs) {
+    PostingList result;
+    result.reserve(lhs.size());
+    std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result));
+    return result;
+}
+
+bool Insert(PostingList& list, std::uint32_t value) {
+    // Новые номера обычно больше всех имеющихся
+    if (list.empty() || list.back() < value) {
+        list.push_back(value);
+        return true;
+    }
+    auto it = std::lower_bound(list.begin(), list.end(), value);
+    if (*it == value) {
+        return false;
+    }
+    list.insert(it, value);
+    return true;
+}
+
+bool Erase(PostingList& list, std::uint32_t value) {
+    auto it = std::lower_bound(list.begin(), list.end(), value);
+    if (it == list.end() || *it != value) {
+        return false;
+    }
+    list.erase(it);
+    return true;
+}
+
+}  // namespace util
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace util {
+
+/**
+ * Отсортированный по возрастанию список номеров без повторов (posting list инвертированного индекса)
+ * и операции над такими списками. Результат операций тоже отсортирован.
+ */
+using PostingList = std::vector<std::uint32_t>;
+
+// Пересечение: при сильно различающихся размерах - галопирующий поиск по длинному списку
+PostingList Intersect(const PostingList& lhs, const PostingList& rhs);
+PostingList Unite(const PostingList& lhs, const PostingList& rhs);
+// Элементы lhs, которых нет в rhs
+PostingList Subtract(const PostingList& lhs, const PostingList& rhs);
+
+// Вставка и удаление с сохранением порядка; false - элемент уже был / отсутствовал
+bool Insert(PostingList& list, std::uint32_t value);
+bool Erase(PostingList& list, std::uint32_t value);
+
+}  // namespace util
@@ -0,0 +1,85 @@
+#include "prefix_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <tuple>
+
+namespace util {
+namespace {
+
+std::string ToKey(std::string_view value) {
+    std::string key{value};
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return key;
+}
+
+}  // namespace
+
+void PrefixIndex::Assign(const std::vector<std::string>& values) {
+    entries_.clear();
+    entries_.reserve(values.size());
+    for (const auto& value : values) {
+        entries_.push_back({ToKey(value), value, 1});
+    }
+    std::sort(entries_.begin(), entries_.end(), [](const Entry& lhs, const Entry& rhs) {
+        return std::tie(lhs.key, lhs.value) < std::tie(rhs.key, rhs.value);
+    });
+    // Повторы схлопываются в одну запись со счётчиком
+    std::vector<Entry> unique;
+    unique.reserve(entries_.size());
+    for (auto& entry : entries_) {
+        if (!unique.empty() && unique.back().value == entry.value) {
+            ++unique.back().count;
+        } else {
+            unique.push_back(std::move(entry));
+        }
+    }
+    entries_ = std::move(unique);
+}
+
+void PrefixIndex::Add(const std::string& value) {
+    auto key = ToKey(value);
+    auto it = Locate(key, value);
+    if (it != entries_.end() && it->value == value) {
+        ++it->count;
+        return;
+    }
+    entries_.insert(it, {std::move(key), value, 1});
+}
+
+void PrefixIndex::Remove(const std::string& value) {
+    auto it = Locate(ToKey(value), value);
+    if (it != entries_.end() && it->value == value && --it->count == 0) {
+        entries_.erase(it);
+    }
+}
+
+void PrefixIndex::Erase(const std::string& value) {
+    auto it = Locate(ToKey(value), value);
+    if (it != entries_.end() && it->value == value) {
+        entries_.erase(it);
+    }
+}
+
+std::vector<std::string> PrefixIndex::Find(std::string_view prefix, std::size_t limit) const {
+    std::vector<std::string> result;
+    auto key = ToKey(prefix);
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), key, [](const Entry& entry, const std::string& key) {
+        return entry.key < key;
+    });
+    for (; it != entries_.end() && result.size() < limit && it->key.compare(0, key.size(), key) == 0; ++it) {
+        result.push_back(it->value);
+    }
+    return result;
+}
+
+std::vector<PrefixIndex::Entry>::iterator PrefixIndex::Locate(const std::string& key, const std::string& value) {
+    return std::lower_bound(entries_.begin(), entries_.end(), std::tie(key, value),
+                            [](const Entry& entry, const auto& target) {
+                                return std::tie(entry.key, entry.value) < target;
+                            });
+}
+
+}  // namespace util
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+/**
+ * Компактный индекс строк для автодополнения: отсортированный массив ключей без учёта регистра
+ * (ASCII). Строки с общим префиксом лежат подряд, поэтому поиск - двоичный поиск начала
+ * диапазона и не более limit шагов по нему. Одинаковые строки хранятся один раз со счётчиком.
+ */
+class PrefixIndex {
+public:
+    void Assign(const std::vector<std::string>& values);
+    void Add(const std::string& value);
+    // Убирает одно вхождение строки
+    void Remove(const std::string& value);
+    // Убирает все вхождения строки
+    void Erase(const std::string& value);
+
+    // Не более limit различных строк с префиксом prefix (без учёта регистра) по алфавиту
+    std::vector<std::string> Find(std::string_view prefix, std::size_t limit) const;
+
+    std::size_t GetSize() const noexcept {
+        return entries_.size();
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        std::string value;
+        std::size_t count = 0;
+    };
+
+    std::vector<Entry>::iterator Locate(const std::string& key, const std::string& value);
+
+    std::vector<Entry> entries_;
+};
+
+}  // namespace util
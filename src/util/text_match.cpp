@@ -0,0 +1,74 @@
+#include "text_match.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+namespace util {
+namespace {
+
+bool IsWordChar(unsigned char c) {
+    return std::isalnum(c) || c >= 0x80;
+}
+
+std::vector<std::string> Trigrams(std::string_view text) {
+    std::vector<std::string> trigrams;
+    for (const auto& word : SplitWords(text)) {
+        auto padded = "  " + word + " ";
+        for (std::size_t i = 0; i + 3 <= padded.size(); ++i) {
+            trigrams.push_back(padded.substr(i, 3));
+        }
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+}  // namespace
+
+std::vector<std::string> SplitWords(std::string_view text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (unsigned char c : text) {
+        if (IsWordChar(c)) {
+            word.push_back(static_cast<char>(std::tolower(c)));
+        } else if (!word.empty()) {
+            words.push_back(std::move(word));
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+double TrigramSimilarity(std::string_view lhs, std::string_view rhs) {
+    auto lhs_trigrams = Trigrams(lhs);
+    auto rhs_trigrams = Trigrams(rhs);
+    if (lhs_trigrams.empty() || rhs_trigrams.empty()) {
+        return 0.0;
+    }
+    std::vector<std::string> common;
+    std::set_intersection(lhs_trigrams.begin(), lhs_trigrams.end(), rhs_trigrams.begin(), rhs_trigrams.end(),
+                          std::back_inserter(common));
+    auto total = lhs_trigrams.size() + rhs_trigrams.size() - common.size();
+    return static_cast<double>(common.size()) / static_cast<double>(total);
+}
+
+std::optional<double> RankDocument(const std::vector<std::string>& query_words,
+                                   const std::vector<WeightedWords>& fields) {
+    double rank = 0.0;
+    for (const auto& word : query_words) {
+        auto field = std::find_if(fields.begin(), fields.end(), [&word](const WeightedWords& field) {
+            return std::find(field.words.begin(), field.words.end(), word) != field.words.end();
+        });
+        if (field == fields.end()) {
+            return std::nullopt;
+        }
+        rank += field->weight;
+    }
+    return rank;
+}
+
+}  // namespace util
@@ -0,0 +1,32 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+// Слова текста в нижнем регистре (ASCII). Словом считается последовательность букв и цифр;
+// байты не из ASCII (UTF-8) относятся к слову и не меняются
+std::vector<std::string> SplitWords(std::string_view text);
+
+// Сходство строк по триграммам в смысле pg_trgm: каждое слово дополняется двумя пробелами
+// слева и одним справа, результат - доля общих триграмм, от 0 до 1
+double TrigramSimilarity(std::string_view lhs, std::string_view rhs);
+
+// Веса полей документа как у ts_rank по умолчанию для меток A, B и C
+constexpr double WEIGHT_A = 1.0;
+constexpr double WEIGHT_B = 0.4;
+constexpr double WEIGHT_C = 0.2;
+
+struct WeightedWords {
+    std::vector<std::string> words;
+    double weight = 0.0;
+};
+
+// Ранг документа: сумма по словам запроса веса первого поля, где слово встречается.
+// std::nullopt, если какого-то слова запроса нет ни в одном поле
+std::optional<double> RankDocument(const std::vector<std::string>& query_words,
+                                   const std::vector<WeightedWords>& fields);
+
+}  // namespace util
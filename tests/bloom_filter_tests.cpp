@@ -0,0 +1,36 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include "../src/util/bloom_filter.h"
+
+using util::BloomFilter;
+
+TEST_CASE("Bloom filter has no false negatives") {
+    BloomFilter filter{1000, 0.01, 1024 * 1024};
+    for (int i = 0; i < 1000; ++i) {
+        filter.Add("author " + std::to_string(i));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(filter.MayContain("author " + std::to_string(i)));
+    }
+}
+
+TEST_CASE("Bloom filter keeps false positive rate near the target") {
+    BloomFilter filter{1000, 0.01, 1024 * 1024};
+    for (int i = 0; i < 1000; ++i) {
+        filter.Add("title " + std::to_string(i));
+    }
+    int false_positives = 0;
+    for (int i = 0; i < 10000; ++i) {
+        false_positives += filter.MayContain("missing " + std::to_string(i));
+    }
+    CHECK(false_positives < 300);
+}
+
+TEST_CASE("Bloom filter respects memory budget") {
+    BloomFilter filter{1'000'000, 0.001, 4096};
+    CHECK(filter.GetSizeBytes() <= 4096);
+    filter.Add("Harry Potter");
+    CHECK(filter.MayContain("Harry Potter"));
+}
@@ -0,0 +1,55 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/app/book_columns.h"
+
+using app::BookColumns;
+
+namespace {
+
+std::vector<domain::BookData> MakeBooks() {
+    return {
+        {"b1", "a1", "John Tolkien", "The Hobbit", 1937},
+        {"b2", "a2", "Joanne Rowling", "Harry Potter", 1997},
+        {"b3", "a1", "John Tolkien", "The Lord of the Rings", 1954},
+        {"b4", "a2", "Joanne Rowling", "The Casual Vacancy", 2012},
+        {"b5", "a1", "John Tolkien", "The Silmarillion", 1977},
+    };
+}
+
+}  // namespace
+
+TEST_CASE("Columnar snapshot keeps titles and dense authors") {
+    BookColumns columns{MakeBooks()};
+    REQUIRE(columns.GetBookCount() == 5);
+    REQUIRE(columns.GetAuthorCount() == 2);
+    CHECK(columns.GetTitle(0) == "The Hobbit");
+    CHECK(columns.GetTitle(4) == "The Silmarillion");
+    CHECK(columns.GetAuthorId(0) == "a1");
+    CHECK(columns.GetAuthorName(1) == "Joanne Rowling");
+}
+
+TEST_CASE("Columnar snapshot aggregates by year and author") {
+    BookColumns columns{MakeBooks()};
+    CHECK(columns.CountInYearRange(1950, 2000) == 3);
+    CHECK(columns.CountInYearRange(2013, 2100) == 0);
+    CHECK(columns.CountByYear(1950, 2000)
+          == std::vector<std::pair<int, std::size_t>>{{1954, 1}, {1977, 1}, {1997, 1}});
+    CHECK(columns.CountByYearBucket(50)
+          == std::vector<std::pair<int, std::size_t>>{{1900, 1}, {1950, 3}, {2000, 1}});
+    CHECK(columns.CountByAuthor() == std::vector<std::size_t>{3, 2});
+    CHECK(columns.YearSpanByAuthor() == std::vector<std::pair<int, int>>{{1937, 1977}, {1997, 2012}});
+    CHECK_THROWS_AS(columns.CountByYearBucket(0), std::invalid_argument);
+}
+
+TEST_CASE("Columnar snapshot handles empty catalogs and out-of-range years") {
+    BookColumns empty{{}};
+    CHECK(empty.CountByYear(0, 3000).empty());
+    CHECK(empty.CountByYearBucket(10).empty());
+    CHECK(empty.YearSpanByAuthor().empty());
+    CHECK_THROWS_AS(BookColumns({{"b1", "a1", "Author", "Title", 100000}}), std::out_of_range);
+}
@@ -0,0 +1,117 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <filesystem>
+
+#include "../src/catalog/catalog_image.h"
+#include "../src/catalog/shared_memory_catalog.h"
+#include "../src/domain/author.h"
+#include "../src/domain/book.h"
+
+namespace {
+
+struct Fixture {
+    std::string rowling = domain::AuthorId::New().ToString();
+    std::string tolkien = domain::AuthorId::New().ToString();
+    std::string potter = domain::BookId::New().ToString();
+    std::string hobbit = domain::BookId::New().ToString();
+    std::string rings = domain::BookId::New().ToString();
+
+    catalog::CatalogData MakeData() const {
+        return {
+            {{rowling, "Joanne Rowling"}, {tolkien, "John Tolkien"}},
+            {{potter, rowling, "Joanne Rowling", "Harry Potter", 1997},
+             {rings, tolkien, "John Tolkien", "The Lord of the Rings", 1954},
+             {hobbit, tolkien, "John Tolkien", "The Hobbit", 1937}},
+            {{hobbit, "adventure"}, {potter, "magic"}, {hobbit, "fantasy"}},
+        };
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "Catalog image round trip") {
+    GIVEN("An image built from a catalog") {
+        auto image = catalog::BuildImage(MakeData());
+        catalog::ImageView view{image.data(), image.size()};
+
+        THEN("listings keep the repository order") {
+            auto authors = view.ReadAuthors();
+            REQUIRE(authors.size() == 2);
+            CHECK(authors[0].second == "Joanne Rowling");
+            auto books = view.ReadBooks();
+            REQUIRE(books.size() == 3);
+            CHECK(books[1].title == "The Lord of the Rings");
+            CHECK(books[1].author_name == "John Tolkien");
+            CHECK(books[1].author_id == tolkien);
+        }
+        THEN("books are found by id with their tags") {
+            auto book = view.FindBook(hobbit);
+            REQUIRE(book.has_value());
+            CHECK(book->year == 1937);
+            CHECK(view.ReadTagsOf(hobbit) == std::vector<std::string>{"adventure", "fantasy"});
+            CHECK_FALSE(view.FindBook(domain::BookId::New().ToString()).has_value());
+            CHECK(view.ReadBookTags().size() == 3);
+        }
+        THEN("author books are ordered by year") {
+            auto books = view.ReadAuthorBooks(tolkien);
+            REQUIRE(books.size() == 2);
+            CHECK(books[0].title == "The Hobbit");
+            CHECK(books[1].title == "The Lord of the Rings");
+            CHECK(view.ReadAuthorBooks(domain::AuthorId::New().ToString()).empty());
+        }
+        THEN("a truncated image is rejected") {
+            CHECK_THROWS(catalog::ImageView{image.data(), image.size() / 2});
+        }
+    }
+    GIVEN("An image with books of the same title") {
+        auto data = MakeData();
+        auto other_hobbit = domain::BookId::New().ToString();
+        data.books.push_back({other_hobbit, rowling, "Joanne Rowling", "The Hobbit", 2001});
+        auto image = catalog::BuildImage(data);
+        catalog::ImageView view{image.data(), image.size()};
+
+        THEN("titles are found by the title index in the listing order") {
+            auto books = view.ReadBooksByTitle("The Hobbit");
+            REQUIRE(books.size() == 2);
+            CHECK(books[0].id == hobbit);
+            CHECK(books[1].id == other_hobbit);
+            CHECK(view.ReadBooksByTitle("Harry Potter").size() == 1);
+            CHECK(view.ReadBooksByTitle("The Hobbi").empty());
+            CHECK(view.ReadBooksByTitle("A").empty());
+            CHECK(view.ReadBooksByTitle("Zorro").empty());
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Shared memory catalog") {
+    const std::string name = "bookypedia_test_" + domain::BookId::New().ToString();
+    GIVEN("An empty segment") {
+        catalog::SharedMemoryCatalog shared{name, 1024 * 1024};
+        CHECK_FALSE(shared.ReadBooks().has_value());
+
+        WHEN("a snapshot is published") {
+            auto data = MakeData();
+            auto generation = shared.GetGeneration();
+            REQUIRE(shared.Publish(generation, data.authors, data.books, data.book_tags));
+
+            THEN("other handles to the segment read it") {
+                catalog::SharedMemoryCatalog other{name, 1024 * 1024};
+                auto books = other.ReadBooks();
+                REQUIRE(books.has_value());
+                CHECK(books->size() == 3);
+                auto book = other.ReadBook(potter);
+                REQUIRE(book.has_value());
+                CHECK(book->second == std::vector<std::string>{"magic"});
+            }
+            THEN("invalidation hides the snapshot") {
+                shared.Invalidate();
+                CHECK_FALSE(shared.ReadAuthors().has_value());
+                CHECK_FALSE(shared.Publish(generation, data.authors, data.books, data.book_tags));
+            }
+        }
+    }
+    boost::interprocess::shared_memory_object::remove(name.c_str());
+    std::filesystem::remove(std::filesystem::temp_directory_path() / (name + ".lock"));
+}
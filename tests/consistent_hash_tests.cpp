@@ -0,0 +1,40 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include "../src/util/consistent_hash.h"
+
+using util::ConsistentHashRing;
+
+TEST_CASE("Consistent hash ring spreads keys over nodes") {
+    ConsistentHashRing ring{4};
+    std::vector<int> counts(4, 0);
+    for (int i = 0; i < 10000; ++i) {
+        ++counts[ring.GetNode("author-" + std::to_string(i))];
+    }
+    for (auto count : counts) {
+        CHECK(count > 1500);
+        CHECK(count < 3500);
+    }
+    CHECK(ring.GetNode("author-42") == ConsistentHashRing{4}.GetNode("author-42"));
+}
+
+TEST_CASE("Consistent hash ring moves few keys when a node is added") {
+    ConsistentHashRing three{3};
+    ConsistentHashRing four{4};
+    int moved = 0;
+    int moved_between_old_nodes = 0;
+    for (int i = 0; i < 10000; ++i) {
+        auto key = "author-" + std::to_string(i);
+        auto before = three.GetNode(key);
+        auto after = four.GetNode(key);
+        if (before != after) {
+            ++moved;
+            moved_between_old_nodes += after != 3;
+        }
+    }
+    CHECK(moved_between_old_nodes == 0);
+    CHECK(moved > 1500);
+    CHECK(moved < 3500);
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include "../src/app/entity_cache.h"
+
+using app::CachedBook;
+using app::EntityCache;
+
+namespace {
+
+CachedBook MakeBook(const std::string& author_id, const std::string& author_name, const std::string& title) {
+    return {{domain::BookId::New().ToString(), author_id, author_name, title, 1900}, {"classic"}};
+}
+
+}  // namespace
+
+TEST_CASE("Entity cache invalidates books by id, title and author") {
+    EntityCache cache{1024 * 1024};
+    auto tolkien = domain::AuthorId::New().ToString();
+    auto rowling = domain::AuthorId::New().ToString();
+    auto hobbit = MakeBook(tolkien, "John Tolkien", "The Hobbit");
+    auto silmarillion = MakeBook(tolkien, "John Tolkien", "The Silmarillion");
+    auto potter = MakeBook(rowling, "Joanne Rowling", "Harry Potter");
+    auto fill = [&] {
+        for (const auto& book : {hobbit, silmarillion, potter}) {
+            cache.PutBook(cache.GetGeneration(), book);
+        }
+        cache.PutBooks(cache.GetGeneration(), {hobbit.data, silmarillion.data, potter.data});
+        cache.PutAuthors(cache.GetGeneration(), {{tolkien, "John Tolkien"}, {rowling, "Joanne Rowling"}});
+    };
+
+    fill();
+    REQUIRE(cache.FindBook(hobbit.data.id).has_value());
+    CHECK(cache.FindBook(hobbit.data.id)->tags == std::vector<std::string>{"classic"});
+    CHECK(cache.FindBooks()->size() == 3);
+
+    cache.InvalidateBook(hobbit.data.id);
+    CHECK_FALSE(cache.FindBook(hobbit.data.id).has_value());
+    CHECK(cache.FindBook(silmarillion.data.id).has_value());
+    CHECK_FALSE(cache.FindBooks().has_value());
+    CHECK(cache.FindAuthors().has_value());
+
+    fill();
+    cache.InvalidateBooksByTitle("The Silmarillion");
+    CHECK_FALSE(cache.FindBook(silmarillion.data.id).has_value());
+    CHECK(cache.FindBook(hobbit.data.id).has_value());
+    CHECK_FALSE(cache.FindBooks().has_value());
+
+    fill();
+    cache.InvalidateAuthor(tolkien);
+    CHECK_FALSE(cache.FindBook(hobbit.data.id).has_value());
+    CHECK_FALSE(cache.FindBook(silmarillion.data.id).has_value());
+    CHECK(cache.FindBook(potter.data.id).has_value());
+    CHECK_FALSE(cache.FindAuthors().has_value());
+    CHECK_FALSE(cache.FindBooks().has_value());
+
+    fill();
+    cache.InvalidateAuthorByName("Joanne Rowling");
+    CHECK_FALSE(cache.FindBook(potter.data.id).has_value());
+    CHECK(cache.FindBook(hobbit.data.id).has_value());
+    CHECK_FALSE(cache.FindAuthors().has_value());
+
+    fill();
+    cache.InvalidateAuthorList();
+    CHECK_FALSE(cache.FindAuthors().has_value());
+    CHECK(cache.FindBooks().has_value());
+    cache.InvalidateBookList();
+    CHECK_FALSE(cache.FindBooks().has_value());
+    CHECK(cache.FindBook(potter.data.id).has_value());
+
+    fill();
+    cache.Clear();
+    CHECK_FALSE(cache.FindBook(hobbit.data.id).has_value());
+    CHECK_FALSE(cache.FindAuthors().has_value());
+    CHECK_FALSE(cache.FindBooks().has_value());
+}
+
+TEST_CASE("Entity cache skips reads started before an invalidation") {
+    EntityCache cache{1024 * 1024};
+    auto book = MakeBook(domain::AuthorId::New().ToString(), "John Tolkien", "The Hobbit");
+
+    auto generation = cache.GetGeneration();
+    cache.InvalidateBook(book.data.id);
+    cache.PutBook(generation, book);
+    cache.PutBooks(generation, {book.data});
+    cache.PutAuthors(generation, {{book.data.author_id, book.data.author_name}});
+    CHECK_FALSE(cache.FindBook(book.data.id).has_value());
+    CHECK_FALSE(cache.FindBooks().has_value());
+    CHECK_FALSE(cache.FindAuthors().has_value());
+
+    cache.PutBook(cache.GetGeneration(), book);
+    CHECK(cache.FindBook(book.data.id).has_value());
+}
+
+TEST_CASE("Entity cache keeps authors by id") {
+    EntityCache cache{1024 * 1024};
+    auto tolkien = domain::AuthorId::New().ToString();
+    auto rowling = domain::AuthorId::New().ToString();
+    auto fill = [&] {
+        cache.PutAuthor(cache.GetGeneration(), tolkien, "John Tolkien");
+        cache.PutAuthor(cache.GetGeneration(), rowling, "Joanne Rowling");
+    };
+
+    fill();
+    CHECK(cache.FindAuthor(tolkien) == "John Tolkien");
+    CHECK_FALSE(cache.FindAuthor(domain::AuthorId::New().ToString()).has_value());
+    CHECK_FALSE(cache.FindAuthor("not an id").has_value());
+
+    cache.InvalidateAuthor(tolkien);
+    CHECK_FALSE(cache.FindAuthor(tolkien).has_value());
+    CHECK(cache.FindAuthor(rowling).has_value());
+
+    fill();
+    cache.InvalidateAuthorByName("Joanne Rowling");
+    CHECK_FALSE(cache.FindAuthor(rowling).has_value());
+    CHECK(cache.FindAuthor(tolkien).has_value());
+
+    // Книги автора не затрагивают запись о нём самом
+    fill();
+    cache.InvalidateBooksByTitle("The Hobbit");
+    CHECK(cache.FindAuthor(tolkien).has_value());
+
+    auto generation = cache.GetGeneration();
+    cache.Clear();
+    CHECK_FALSE(cache.FindAuthor(tolkien).has_value());
+    cache.PutAuthor(generation, tolkien, "John Tolkien");
+    CHECK_FALSE(cache.FindAuthor(tolkien).has_value());
+}
+
+TEST_CASE("Entity cache with zero capacity stores nothing") {
+    EntityCache cache{0};
+    auto book = MakeBook(domain::AuthorId::New().ToString(), "John Tolkien", "The Hobbit");
+    cache.PutBook(cache.GetGeneration(), book);
+    cache.PutBooks(cache.GetGeneration(), {book.data});
+    CHECK_FALSE(cache.FindBook(book.data.id).has_value());
+    CHECK_FALSE(cache.FindBooks().has_value());
+}
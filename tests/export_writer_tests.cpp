@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+#include "../src/app/export_writer.h"
+
+namespace {
+
+const app::ExportRecord HOBBIT{"John Tolkien", "The Hobbit", 1937, "adventure,fantasy"};
+const app::ExportRecord QUOTED{"Joanne \"Jo\" Rowling", "Line\nbreak, comma\\", 1997, ""};
+
+}  // namespace
+
+SCENARIO("Export writer") {
+    std::ostringstream output;
+
+    GIVEN("A CSV writer") {
+        app::ExportWriter writer{output, app::ImportFormat::kCsv};
+
+        THEN("the header is written even without records") {
+            CHECK(output.str() == "author,title,year,tags\n");
+        }
+        WHEN("books are written") {
+            writer.Write(HOBBIT);
+            writer.Write(QUOTED);
+
+            THEN("fields with separators are quoted") {
+                CHECK(writer.GetCount() == 2);
+                CHECK(output.str() == "author,title,year,tags\n"
+                                      "John Tolkien,The Hobbit,1937,\"adventure,fantasy\"\n"
+                                      "\"Joanne \"\"Jo\"\" Rowling\",\"Line\nbreak, comma\\\",1997,\n");
+            }
+        }
+    }
+    GIVEN("An NDJSON writer") {
+        app::ExportWriter writer{output, app::ImportFormat::kNdjson};
+        writer.Write(HOBBIT);
+        writer.Write(QUOTED);
+        writer.Write({"A", "\x01", std::nullopt, "one"});
+
+        THEN("one escaped object per line is written") {
+            CHECK(output.str() ==
+                  "{\"author\": \"John Tolkien\", \"title\": \"The Hobbit\", \"year\": 1937, \"tags\": [\"adventure\", \"fantasy\"]}\n"
+                  "{\"author\": \"Joanne \\\"Jo\\\" Rowling\", \"title\": \"Line\\nbreak, comma\\\\\", \"year\": 1997, \"tags\": []}\n"
+                  "{\"author\": \"A\", \"title\": \"\\u0001\", \"year\": null, \"tags\": [\"one\"]}\n");
+        }
+    }
+}
+
+SCENARIO("Export can be imported back") {
+    for (auto format : {app::ImportFormat::kCsv, app::ImportFormat::kNdjson}) {
+        std::stringstream stream;
+        app::ExportWriter writer{stream, format};
+        writer.Write(HOBBIT);
+        writer.Write(QUOTED);
+
+        app::ImportReader reader{stream, format};
+        auto hobbit = reader.Next();
+        auto quoted = reader.Next();
+        REQUIRE(hobbit);
+        REQUIRE(quoted);
+        CHECK_FALSE(reader.Next());
+        CHECK(hobbit->author_name == HOBBIT.author_name);
+        CHECK(hobbit->tags == std::vector<std::string>{"adventure", "fantasy"});
+        CHECK(quoted->author_name == QUOTED.author_name);
+        CHECK(quoted->title == QUOTED.title);
+        CHECK(quoted->year == 1997);
+        CHECK(quoted->tags.empty());
+    }
+}
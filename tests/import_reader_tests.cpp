@@ -0,0 +1,92 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+#include "../src/app/import_reader.h"
+
+namespace {
+
+std::vector<app::ImportRecord> ReadAll(const std::string& text, app::ImportFormat format) {
+    std::istringstream input{text};
+    app::ImportReader reader{input, format};
+    std::vector<app::ImportRecord> records;
+    while (auto record = reader.Next()) {
+        records.push_back(std::move(*record));
+    }
+    return records;
+}
+
+}  // namespace
+
+SCENARIO("CSV import records") {
+    GIVEN("A CSV file with a header") {
+        const std::string csv =
+                "title,Author,year,tags\r\n"
+                "The Hobbit,John Tolkien,1937,\"fantasy, adventure,  fantasy\"\r\n"
+                "\r\n"
+                "\"Quotes \"\"inside\"\", commas\",  Joanne Rowling ,1997,\n"
+                "\"Two\nlines\",Someone,2000,magic\n";
+
+        THEN("fields are read by header names") {
+            auto records = ReadAll(csv, app::ImportFormat::kCsv);
+            REQUIRE(records.size() == 3);
+            CHECK(records[0].title == "The Hobbit");
+            CHECK(records[0].author_name == "John Tolkien");
+            CHECK(records[0].year == 1937);
+            CHECK(records[0].tags == std::vector<std::string>{"adventure", "fantasy"});
+            CHECK(records[1].title == "Quotes \"inside\", commas");
+            CHECK(records[1].author_name == "Joanne Rowling");
+            CHECK(records[1].tags.empty());
+            CHECK(records[2].title == "Two\nlines");
+            CHECK(records[2].tags == std::vector<std::string>{"magic"});
+        }
+    }
+    GIVEN("Malformed CSV files") {
+        THEN("errors carry the line number") {
+            CHECK_THROWS_AS(ReadAll("author,title\nA,B\n", app::ImportFormat::kCsv), std::invalid_argument);
+            try {
+                ReadAll("author,title,year\nA,B,1999\nA,B,year\n", app::ImportFormat::kCsv);
+                FAIL("no error");
+            } catch (const std::invalid_argument& e) {
+                CHECK(std::string{e.what()}.find("Line 3") == 0);
+            }
+            CHECK_THROWS_AS(ReadAll("author,title,year\n\"A,B,1999\n", app::ImportFormat::kCsv),
+                            std::invalid_argument);
+            CHECK_THROWS_AS(ReadAll("author,title,year\n,B,1999\n", app::ImportFormat::kCsv),
+                            std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("NDJSON import records") {
+    GIVEN("An NDJSON file") {
+        const std::string ndjson =
+                R"({"author": "John Tolkien", "title": "The Hobbit", "year": 1937, "tags": ["fantasy", " fantasy "]})" "\n"
+                "\n"
+                R"({"isbn": {"10": null, "13": [1, 2.5e3]}, "year": 2001, "title": "Café \"😀\"", "author": "A\/B", "draft": true})" "\n";
+
+        THEN("known fields are read and others skipped") {
+            auto records = ReadAll(ndjson, app::ImportFormat::kNdjson);
+            REQUIRE(records.size() == 2);
+            CHECK(records[0].author_name == "John Tolkien");
+            CHECK(records[0].year == 1937);
+            CHECK(records[0].tags == std::vector<std::string>{"fantasy"});
+            CHECK(records[1].title == "Caf\xC3\xA9 \"\xF0\x9F\x98\x80\"");
+            CHECK(records[1].author_name == "A/B");
+            CHECK(records[1].year == 2001);
+        }
+    }
+    GIVEN("Malformed NDJSON lines") {
+        THEN("they are rejected") {
+            CHECK_THROWS_AS(ReadAll(R"({"author": "A", "title": "B"})", app::ImportFormat::kNdjson),
+                            std::invalid_argument);
+            CHECK_THROWS_AS(ReadAll(R"({"author": "A", "title": "B", "year": 19.5})", app::ImportFormat::kNdjson),
+                            std::invalid_argument);
+            CHECK_THROWS_AS(ReadAll(R"({"author": "A", "title": "B", "year": 1} x)", app::ImportFormat::kNdjson),
+                            std::invalid_argument);
+            CHECK_THROWS_AS(ReadAll(R"({"author": "A\q", "title": "B", "year": 1})", app::ImportFormat::kNdjson),
+                            std::invalid_argument);
+        }
+    }
+}
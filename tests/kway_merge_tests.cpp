@@ -0,0 +1,26 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/util/kway_merge.h"
+
+using util::MergeSorted;
+
+TEST_CASE("K-way merge keeps the common order") {
+    std::vector<std::vector<int>> runs{{1, 4, 7}, {}, {2, 5, 8, 9}, {3, 6}};
+    CHECK(MergeSorted(runs) == std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9});
+    CHECK(MergeSorted(runs, std::less<int>{}, 2, 3) == std::vector<int>{3, 4, 5});
+    CHECK(MergeSorted(runs, std::less<int>{}, 8, 5) == std::vector<int>{9});
+    CHECK(MergeSorted(std::vector<std::vector<int>>{}).empty());
+}
+
+TEST_CASE("K-way merge puts equal elements in run order") {
+    using Item = std::pair<int, std::string>;
+    std::vector<std::vector<Item>> runs{{{1, "a"}, {2, "a"}}, {{1, "b"}, {2, "b"}}};
+    auto merged = MergeSorted(runs, [](const Item& lhs, const Item& rhs) {
+        return lhs.first < rhs.first;
+    });
+    CHECK(merged == std::vector<Item>{{1, "a"}, {1, "b"}, {2, "a"}, {2, "b"}});
+}
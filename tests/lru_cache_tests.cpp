@@ -0,0 +1,46 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include "../src/util/lru_cache.h"
+
+using util::LruCache;
+
+TEST_CASE("LRU cache evicts least recently used entries") {
+    LruCache<int, std::string> cache{30};
+    cache.Put(1, "one", 10);
+    cache.Put(2, "two", 10);
+    cache.Put(3, "three", 10);
+    CHECK(cache.Get(1) == "one");
+
+    cache.Put(4, "four", 10);
+    CHECK(cache.GetCount() == 3);
+    CHECK(cache.GetSizeBytes() == 30);
+    CHECK_FALSE(cache.Get(2).has_value());
+    CHECK(cache.Get(1) == "one");
+    CHECK(cache.Get(3) == "three");
+    CHECK(cache.Get(4) == "four");
+}
+
+TEST_CASE("LRU cache replaces, erases and skips oversized entries") {
+    LruCache<int, std::string> cache{20};
+    cache.Put(1, "one", 10);
+    cache.Put(1, "uno", 15);
+    CHECK(cache.Get(1) == "uno");
+    CHECK(cache.GetSizeBytes() == 15);
+
+    cache.Put(2, "huge", 21);
+    CHECK_FALSE(cache.Get(2).has_value());
+    CHECK(cache.Get(1) == "uno");
+
+    cache.Put(3, "three", 5);
+    cache.EraseIf([](int key, const std::string&) {
+        return key == 1;
+    });
+    CHECK_FALSE(cache.Get(1).has_value());
+    CHECK(cache.GetSizeBytes() == 5);
+
+    cache.Erase(3);
+    CHECK(cache.GetCount() == 0);
+    CHECK(cache.GetSizeBytes() == 0);
+}
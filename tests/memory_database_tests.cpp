@@ -0,0 +1,140 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+
+#include "../src/memory/memory_database.h"
+
+namespace {
+
+struct Fixture {
+    memory::Database database;
+    memory::UnitOfWorkFactoryImpl factory{database};
+    std::string tolkien = domain::AuthorId::New().ToString();
+    std::string hobbit = domain::BookId::New().ToString();
+
+    void AddTolkien() {
+        auto unit = factory.CreateUnitOfWork();
+        unit->Author()->Save({domain::AuthorId::FromString(tolkien), "John Tolkien"});
+        unit->Book()->Save({domain::BookId::FromString(hobbit), tolkien, "The Hobbit", 1937});
+        unit->BookTags()->Save({hobbit, {"fantasy"}});
+        unit->Commit();
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "In-memory unit of work") {
+    GIVEN("A committed author with a book") {
+        AddTolkien();
+
+        WHEN("a unit of work is destroyed without commit") {
+            {
+                auto unit = factory.CreateUnitOfWork();
+                unit->Author()->EditById(tolkien, "J. R. R. Tolkien");
+                CHECK(unit->Author()->Read().at(0).second == "J. R. R. Tolkien");
+            }
+            THEN("its changes are rolled back") {
+                auto unit = factory.CreateUnitOfWork();
+                CHECK(unit->Author()->Read().at(0).second == "John Tolkien");
+            }
+        }
+        WHEN("another unit of work reads before commit") {
+            auto writer = factory.CreateUnitOfWork();
+            writer->Book()->EditYearById(hobbit, 1938);
+            auto reader = factory.CreateUnitOfWork();
+
+            THEN("it sees only committed data") {
+                CHECK(reader->Book()->ReadById(hobbit).year == 1937);
+                writer->Commit();
+                CHECK(reader->Book()->ReadById(hobbit).year == 1938);
+            }
+        }
+        WHEN("an operation fails") {
+            auto unit = factory.CreateUnitOfWork();
+            unit->Book()->EditTitleById(hobbit, "There and Back Again");
+            CHECK_THROWS_AS(unit->Book()->DeleteById(hobbit), std::logic_error);
+            unit->Commit();
+
+            THEN("the whole transaction is rolled back") {
+                auto check = factory.CreateUnitOfWork();
+                CHECK(check->Book()->ReadById(hobbit).title == "The Hobbit");
+            }
+        }
+        WHEN("a read-only unit of work has read once") {
+            auto reader = factory.CreateUnitOfWork({.read_only = true});
+            CHECK(reader->Book()->ReadById(hobbit).year == 1937);
+            auto writer = factory.CreateUnitOfWork();
+            writer->Book()->EditYearById(hobbit, 1938);
+            writer->Commit();
+
+            THEN("it keeps seeing the same snapshot until commit") {
+                CHECK(reader->Book()->ReadById(hobbit).year == 1937);
+                reader->Commit();
+                CHECK(reader->Book()->ReadById(hobbit).year == 1938);
+            }
+            THEN("it cannot write") {
+                CHECK_THROWS_AS(reader->Author()->EditById(tolkien, "J. R. R. Tolkien"), std::logic_error);
+            }
+        }
+        WHEN("a unit of work is used after a failed operation") {
+            auto unit = factory.CreateUnitOfWork();
+            CHECK_THROWS_AS(unit->Book()->DeleteById(hobbit), std::logic_error);
+
+            THEN("it rejects queries until rollback") {
+                CHECK_THROWS_AS(unit->Book()->Read(), std::logic_error);
+                unit->Commit();
+                CHECK(unit->Book()->Read().size() == 1);
+            }
+        }
+        THEN("schema constraints are enforced") {
+            auto unit = factory.CreateUnitOfWork();
+            CHECK_THROWS_AS(unit->Author()->Save({domain::AuthorId::New(), "John Tolkien"}), std::logic_error);
+            CHECK_THROWS_AS(unit->Book()->Save({domain::BookId::FromString(hobbit), tolkien, "Copy", 2000}),
+                            std::logic_error);
+            CHECK_THROWS_AS(unit->BookTags()->Save({domain::BookId::New().ToString(), {"tag"}}), std::logic_error);
+            CHECK_THROWS_AS(unit->Author()->DeleteByName("Nobody"), std::logic_error);
+        }
+        THEN("a missing book is read as empty data") {
+            auto unit = factory.CreateUnitOfWork();
+            CHECK(unit->Book()->ReadById(domain::BookId::New().ToString()).id.empty());
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "In-memory indexes") {
+    GIVEN("Books of two authors") {
+        auto rowling = domain::AuthorId::New();
+        auto unit = factory.CreateUnitOfWork();
+        unit->Author()->Save({domain::AuthorId::FromString(tolkien), "John Tolkien"});
+        unit->Author()->Save({rowling, "Joanne Rowling"});
+        unit->Book()->Save({domain::BookId::New(), tolkien, "Same Title", 1954});
+        unit->Book()->Save({domain::BookId::New(), rowling.ToString(), "Same Title", 1997});
+        unit->Book()->Save({domain::BookId::FromString(hobbit), tolkien, "The Hobbit", 1937});
+        unit->Commit();
+
+        THEN("equal titles are ordered by author name") {
+            auto books = unit->Book()->Read();
+            REQUIRE(books.size() == 3);
+            CHECK(books.at(0).author_name == "Joanne Rowling");
+            CHECK(books.at(1).author_name == "John Tolkien");
+            CHECK(unit->Book()->ReadByName("Same Title").size() == 2);
+        }
+        THEN("renaming an author reorders books") {
+            unit->Author()->EditById(tolkien, "Alan Tolkien");
+            unit->Commit();
+            CHECK(unit->Book()->Read().at(0).author_name == "Alan Tolkien");
+        }
+        THEN("year range reads a slice of the year index") {
+            auto books = unit->Book()->ReadByYearRange(1937, 1960, 10, 0);
+            REQUIRE(books.size() == 2);
+            CHECK(books.at(0).id == hobbit);
+            CHECK(unit->Book()->ReadByYearRange(1937, 1960, 10, 1).size() == 1);
+        }
+        THEN("author books are read by the author index") {
+            auto books = unit->Book()->ReadAuthorBooks(tolkien);
+            REQUIRE(books.size() == 2);
+            CHECK(books.at(0).id == hobbit);
+            CHECK(books.at(0).author_name.empty());
+        }
+    }
+}
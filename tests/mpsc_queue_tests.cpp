@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../src/util/mpsc_queue.h"
+
+using util::MpscQueue;
+
+TEST_CASE("MPSC queue pops elements in push order") {
+    MpscQueue<std::string> queue;
+    CHECK_FALSE(queue.Pop().has_value());
+
+    queue.Push("one");
+    queue.Push("two");
+    CHECK(queue.Pop() == "one");
+    queue.Push("three");
+    CHECK(queue.Pop() == "two");
+    CHECK(queue.Pop() == "three");
+    CHECK_FALSE(queue.Pop().has_value());
+
+    queue.Push("left in queue");
+}
+
+TEST_CASE("MPSC queue keeps each producer's order") {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    MpscQueue<std::pair<int, int>> queue;
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < PRODUCERS; ++producer) {
+        producers.emplace_back([&queue, producer] {
+            for (int i = 0; i < PER_PRODUCER; ++i) {
+                queue.Push({producer, i});
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int popped = 0;
+    bool ordered = true;
+    while (popped < PRODUCERS * PER_PRODUCER) {
+        if (auto item = queue.Pop()) {
+            ordered = ordered && item->second == next[item->first];
+            next[item->first] = item->second + 1;
+            ++popped;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    CHECK(ordered);
+    CHECK(next == std::vector<int>(PRODUCERS, PER_PRODUCER));
+    CHECK_FALSE(queue.Pop().has_value());
+}
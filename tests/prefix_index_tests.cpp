@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include "../src/util/prefix_index.h"
+
+using util::PrefixIndex;
+using Names = std::vector<std::string>;
+
+TEST_CASE("Prefix index finds names by case-insensitive prefix") {
+    PrefixIndex index;
+    index.Assign({"Tolkien", "Pushkin", "Tolstoy", "tolstaya", "Pushkin"});
+    CHECK(index.GetSize() == 4);
+    CHECK(index.Find("tol", 10) == Names{"Tolkien", "tolstaya", "Tolstoy"});
+    CHECK(index.Find("TOLK", 10) == Names{"Tolkien"});
+    CHECK(index.Find("tol", 1).size() == 1);
+    CHECK(index.Find("x", 10).empty());
+    CHECK(index.Find("", 10).size() == 4);
+}
+
+TEST_CASE("Prefix index counts duplicates on updates") {
+    PrefixIndex index;
+    index.Add("The Hobbit");
+    index.Add("The Hobbit");
+    index.Add("The Lord of the Rings");
+    CHECK(index.Find("the", 10) == Names{"The Hobbit", "The Lord of the Rings"});
+
+    index.Remove("The Hobbit");
+    CHECK(index.Find("the h", 10) == Names{"The Hobbit"});
+    index.Remove("The Hobbit");
+    CHECK(index.Find("the h", 10).empty());
+
+    index.Add("The Lord of the Rings");
+    index.Erase("The Lord of the Rings");
+    CHECK(index.GetSize() == 0);
+    index.Remove("missing");
+}
@@ -0,0 +1,158 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/app/replica_routing.h"
+#include "../src/app/use_cases_impl.h"
+#include "../src/memory/memory_database.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Реплика без соединения: не открывает транзакций
+class UnavailableFactory : public app::UnitOfWorkFactory {
+public:
+    std::unique_ptr<app::UnitOfWork> CreateUnitOfWork(const app::UnitOfWorkOptions& = {}) override {
+        ++attempts;
+        throw std::runtime_error("Connection is broken");
+    }
+
+    int attempts = 0;
+};
+
+// Каждая база - отдельный экземпляр: реплики видят только свои данные, как отставшие от primary
+struct Instance {
+    explicit Instance(const std::string& author_name) {
+        auto unit = factory.CreateUnitOfWork();
+        unit->Author()->Save({domain::AuthorId::New(), author_name});
+        unit->Commit();
+    }
+
+    memory::Database database;
+    memory::UnitOfWorkFactoryImpl factory{database};
+};
+
+// Одна и та же книга на primary и на реплике, которая ещё не получила правку года издания
+struct LaggingReplica {
+    LaggingReplica() {
+        for (auto* factory : {&primary.factory, &replica.factory}) {
+            auto unit = factory->CreateUnitOfWork();
+            unit->Author()->Save({author_id, "John Tolkien"});
+            unit->Book()->Save({book_id, author_id.ToString(), "The Hobbit", 1937});
+            unit->Commit();
+        }
+        auto unit = primary.factory.CreateUnitOfWork();
+        unit->Book()->EditYearById(book_id.ToString(), 1938);
+        unit->Commit();
+    }
+
+    domain::AuthorId author_id = domain::AuthorId::New();
+    domain::BookId book_id = domain::BookId::New();
+    Instance primary{"Primary"};
+    Instance replica{"Replica"};
+};
+
+std::string ReadAuthor(app::UnitOfWorkFactory& factory, const app::UnitOfWorkOptions& options = {.read_only = true}) {
+    auto authors = factory.CreateUnitOfWork(options)->Author()->Read();
+    return authors.empty() ? std::string{} : authors.back().second;
+}
+
+}  // namespace
+
+SCENARIO("Replica routing") {
+    Instance primary{"Primary"};
+    Instance first{"First replica"};
+    Instance second{"Second replica"};
+
+    GIVEN("Two replicas without stickiness") {
+        app::ReplicaRoutingUnitOfWorkFactory router{primary.factory, {&first.factory, &second.factory},
+                                                    {.sticky_for = 0ms}};
+
+        THEN("reads go to replicas in turn") {
+            CHECK(ReadAuthor(router) == "First replica");
+            CHECK(ReadAuthor(router) == "Second replica");
+            CHECK(ReadAuthor(router) == "First replica");
+        }
+        THEN("reads that fill caches go to the primary") {
+            CHECK(ReadAuthor(router, {.read_only = true, .primary = true}) == "Primary");
+            CHECK(ReadAuthor(router) == "First replica");
+        }
+        THEN("writes go to the primary") {
+            auto unit = router.CreateUnitOfWork();
+            unit->Author()->Save({domain::AuthorId::New(), "Written"});
+            unit->Commit();
+            CHECK(ReadAuthor(primary.factory) == "Written");
+            CHECK(ReadAuthor(router) == "First replica");
+        }
+    }
+    GIVEN("Read-your-writes stickiness") {
+        app::ReplicaRoutingUnitOfWorkFactory router{primary.factory, {&first.factory}, {.sticky_for = 1h}};
+        CHECK(ReadAuthor(router) == "First replica");
+
+        WHEN("the thread commits a write") {
+            auto unit = router.CreateUnitOfWork();
+            unit->Author()->Save({domain::AuthorId::New(), "Written"});
+            unit->Commit();
+
+            THEN("its reads go to the primary") {
+                CHECK(ReadAuthor(router) == "Written");
+            }
+        }
+        WHEN("a write unit of work is not committed") {
+            router.CreateUnitOfWork()->Author()->Save({domain::AuthorId::New(), "Written"});
+
+            THEN("reads stay on the replica") {
+                CHECK(ReadAuthor(router) == "First replica");
+            }
+        }
+    }
+    GIVEN("An unavailable replica") {
+        UnavailableFactory broken;
+        app::ReplicaRoutingUnitOfWorkFactory router{primary.factory, {&broken, &first.factory},
+                                                    {.sticky_for = 0ms, .retry_after = 1h}};
+
+        THEN("reads fall back to the next replica and skip the broken one") {
+            CHECK(ReadAuthor(router) == "First replica");
+            CHECK(ReadAuthor(router) == "First replica");
+            CHECK(ReadAuthor(router) == "First replica");
+            CHECK(broken.attempts == 1);
+        }
+    }
+    GIVEN("No available replicas") {
+        UnavailableFactory broken;
+        app::ReplicaRoutingUnitOfWorkFactory router{primary.factory, {&broken}};
+
+        THEN("reads go to the primary") {
+            CHECK(ReadAuthor(router) == "Primary");
+        }
+    }
+}
+
+SCENARIO_METHOD(LaggingReplica, "Sessions over a lagging replica") {
+    GIVEN("Use cases over replica routing") {
+        app::ReplicaRoutingUnitOfWorkFactory router{primary.factory, {&replica.factory}, {.sticky_for = 0ms}};
+        app::UseCasesImpl use_cases{router};
+
+        WHEN("a read-only session reads through the replica") {
+            auto session = use_cases.OpenSession(true);
+            auto titles = use_cases.ShowBooksByTitle("The Hobbit");
+            auto book = use_cases.ShowBookById(book_id.ToString());
+            session->Commit();
+
+            THEN("the session sees the replica while the cache is filled from the primary") {
+                REQUIRE(titles.size() == 1);
+                CHECK(titles[0].year == 1937);
+                CHECK(book.publication_year == 1938);
+                CHECK(use_cases.ShowAuthorById(author_id.ToString()) == "John Tolkien");
+            }
+            THEN("the cache keeps the primary version after the session") {
+                CHECK(use_cases.ShowBookById(book_id.ToString()).publication_year == 1938);
+            }
+        }
+    }
+}
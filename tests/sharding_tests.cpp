@@ -0,0 +1,146 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/app/sharding.h"
+#include "../src/app/use_cases_impl.h"
+#include "../src/memory/memory_database.h"
+
+namespace {
+
+struct Shard {
+    memory::Database database;
+    memory::UnitOfWorkFactoryImpl factory{database};
+
+    std::vector<std::pair<std::string, std::string>> ReadAuthors() {
+        return factory.CreateUnitOfWork({.read_only = true})->Author()->Read();
+    }
+};
+
+struct Fixture {
+    Shard shards[3];
+    app::ShardedUnitOfWorkFactory factory{{&shards[0].factory, &shards[1].factory, &shards[2].factory}};
+    app::UseCasesImpl use_cases{factory};
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "Sharded catalog") {
+    GIVEN("Authors with books") {
+        std::vector<std::string> names{"Leo Tolstoy", "Alexander Pushkin", "Fyodor Dostoevsky", "John Tolkien",
+                                       "Joanne Rowling", "Anton Chekhov", "Nikolai Gogol", "Ivan Turgenev"};
+        std::vector<std::string> ids;
+        std::vector<std::string> books;
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            ids.push_back(use_cases.AddAuthor(names[i]));
+            books.push_back(use_cases.AddBookWithTags({ids.back(), {}}, "Book " + std::to_string(names.size() - i),
+                                                      1900 + static_cast<int>(i), {"classic"}));
+        }
+
+        THEN("each author with their books lives on the shard of its id") {
+            std::size_t placed = 0;
+            for (std::size_t shard = 0; shard < 3; ++shard) {
+                for (const auto& [id, name] : shards[shard].ReadAuthors()) {
+                    CHECK(factory.GetAuthorShard(id) == shard);
+                    auto unit = shards[shard].factory.CreateUnitOfWork({.read_only = true});
+                    CHECK(unit->Book()->ReadAuthorBooks(id).size() == 1);
+                    ++placed;
+                }
+            }
+            CHECK(placed == names.size());
+        }
+        THEN("lists are merged from all shards in listing order") {
+            auto authors = use_cases.ShowAuthors();
+            REQUIRE(authors.size() == names.size());
+            CHECK(authors.front().second == "Alexander Pushkin");
+            CHECK(authors.back().second == "Nikolai Gogol");
+            CHECK(std::is_sorted(authors.begin(), authors.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.second < rhs.second;
+            }));
+
+            auto listing = use_cases.ShowBooks();
+            REQUIRE(listing.size() == names.size());
+            for (std::size_t i = 0; i < listing.size(); ++i) {
+                CHECK(listing[i].title == "Book " + std::to_string(i + 1));
+            }
+
+            auto page = use_cases.ShowBooksByYearRange(1901, 1906, 1, 2);
+            REQUIRE(page.books.size() == 2);
+            CHECK(page.books.at(0).year == 1903);
+            CHECK(page.books.at(1).year == 1904);
+            CHECK(page.has_more);
+        }
+        THEN("books are edited and deleted by id on their shard") {
+            use_cases.PatchBook(books[3], "The Hobbit", 1937, std::vector<std::string>{"fantasy"});
+            auto hobbit = use_cases.ShowBookById(books[3]);
+            CHECK(hobbit.title == "The Hobbit");
+            CHECK(hobbit.author_name == "John Tolkien");
+            CHECK(hobbit.tags == std::vector<std::string>{"fantasy"});
+
+            use_cases.DeleteBookTagsById(books[0]);
+            use_cases.DeleteBookById(books[0]);
+            CHECK(use_cases.ShowBooks().size() == names.size() - 1);
+            CHECK(use_cases.ShowAuthorBooks(ids[0]).empty());
+        }
+        THEN("full-text search pages are merged by the shards' ranks") {
+            use_cases.AddBook(ids[0], "Classic Tales", 1950);
+            auto found = use_cases.SearchBooks("classic", 3);
+            REQUIRE(found.size() == 3);
+            CHECK(found.at(0).title == "Classic Tales");
+            CHECK(found.at(1).title == "Book 1");
+            CHECK(found.at(2).title == "Book 2");
+
+            found = use_cases.SearchBooks("classic", 2, 4);
+            REQUIRE(found.size() == 2);
+            CHECK(found.at(0).title == "Book 4");
+            CHECK(found.at(1).title == "Book 5");
+        }
+        THEN("tag statistics are summed over shards") {
+            auto top_tags = use_cases.TagStats(5);
+            REQUIRE(top_tags.size() == 1);
+            CHECK(top_tags.at(0) == std::pair<std::string, std::size_t>{"classic", names.size()});
+        }
+        THEN("an author is edited and deleted by name on its shard") {
+            use_cases.EditAuthorByName("John Tolkien", "J. R. R. Tolkien");
+            use_cases.DeleteAuthorByName("Leo Tolstoy");
+            auto authors = use_cases.ShowAuthors();
+            CHECK(authors.size() == names.size() - 1);
+            CHECK(std::find_if(authors.begin(), authors.end(), [](const auto& author) {
+                return author.second == "J. R. R. Tolkien";
+            }) != authors.end());
+        }
+        THEN("author names stay unique across shards") {
+            auto tolstoy_shard = factory.GetAuthorShard(ids[0]);
+            auto id = domain::AuthorId::New();
+            while (factory.GetAuthorShard(id.ToString()) == tolstoy_shard) {
+                id = domain::AuthorId::New();
+            }
+            auto unit = factory.CreateUnitOfWork();
+            CHECK_THROWS_AS(unit->Author()->Save({id, "Leo Tolstoy"}), std::logic_error);
+            CHECK(unit->Author()->ReadIdByName("Leo Tolstoy") == ids[0]);
+            CHECK_FALSE(unit->Author()->ReadIdByName("Leo Tolstoi").has_value());
+            CHECK_THROWS(use_cases.EditAuthorByName("John Tolkien", "Leo Tolstoy"));
+            CHECK_THROWS(use_cases.EditAuthorById(ids[3], "Leo Tolstoy"));
+            CHECK(use_cases.ShowAuthors().size() == names.size());
+        }
+        THEN("a writing unit of work reads all shards but writes to one") {
+            auto first = ids[0];
+            auto other = std::find_if(ids.begin(), ids.end(), [&](const auto& id) {
+                return factory.GetAuthorShard(id) != factory.GetAuthorShard(first);
+            });
+            REQUIRE(other != ids.end());
+
+            auto unit = factory.CreateUnitOfWork();
+            CHECK(unit->Author()->Read().size() == names.size());
+            unit->Author()->EditById(first, "Lev Tolstoy");
+            CHECK_THROWS_AS(unit->Author()->EditById(*other, "Renamed"), std::logic_error);
+            unit->Commit();
+            CHECK(shards[factory.GetAuthorShard(first)].factory.CreateUnitOfWork({.read_only = true})
+                      ->Author()->ReadNameById(first) == "Lev Tolstoy");
+        }
+    }
+}
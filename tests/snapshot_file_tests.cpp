@@ -0,0 +1,122 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "../src/catalog/snapshot_file.h"
+#include "../src/catalog/snapshot_repositories.h"
+#include "../src/domain/author.h"
+#include "../src/domain/book.h"
+
+namespace {
+
+struct Fixture {
+    std::string rowling = domain::AuthorId::New().ToString();
+    std::string tolkien = domain::AuthorId::New().ToString();
+    std::string potter = domain::BookId::New().ToString();
+    std::string hobbit = domain::BookId::New().ToString();
+    std::string rings = domain::BookId::New().ToString();
+    std::filesystem::path path = std::filesystem::temp_directory_path()
+                                 / ("bookypedia_snapshot_test_" + domain::BookId::New().ToString());
+
+    ~Fixture() {
+        std::filesystem::remove(path);
+    }
+
+    catalog::CatalogData MakeData() const {
+        return {
+            {{rowling, "Joanne Rowling"}, {tolkien, "John Tolkien"}},
+            {{potter, rowling, "Joanne Rowling", "Harry Potter", 1997},
+             {rings, tolkien, "John Tolkien", "The Lord of the Rings", 1954},
+             {hobbit, tolkien, "John Tolkien", "The Hobbit", 1937}},
+            {{hobbit, "adventure"}, {potter, "magic"}, {hobbit, "fantasy"}, {rings, "fantasy"}},
+        };
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "Snapshot file round trip") {
+    GIVEN("A snapshot written to a file") {
+        catalog::WriteSnapshotFile(path, MakeData());
+
+        WHEN("the file is mapped") {
+            catalog::SnapshotFile snapshot{path};
+            const auto& image = snapshot.GetImage();
+
+            THEN("it contains the catalog") {
+                CHECK(image.GetAuthorCount() == 2);
+                CHECK(image.GetBookCount() == 3);
+                CHECK(image.GetTagCount() == 4);
+                CHECK(image.ReadBooks()[0].title == "Harry Potter");
+                CHECK_NOTHROW(snapshot.Verify());
+            }
+        }
+        WHEN("the image is corrupted") {
+            {
+                std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+                file.seekp(-1, std::ios::end);
+                file.put('\x7f');
+            }
+            THEN("the file still opens and the checksum does not match on demand") {
+                catalog::SnapshotFile snapshot{path};
+                CHECK_THROWS_AS(snapshot.Verify(), std::runtime_error);
+            }
+        }
+        WHEN("the file is truncated") {
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+            THEN("it is rejected") {
+                CHECK_THROWS_AS(catalog::SnapshotFile{path}, std::runtime_error);
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Read-only repositories over a snapshot") {
+    GIVEN("A unit of work over the mapped snapshot") {
+        catalog::WriteSnapshotFile(path, MakeData());
+        catalog::SnapshotFile snapshot{path};
+        catalog::SnapshotUnitOfWork unit{snapshot.GetImage()};
+
+        THEN("listings and lookups match the image") {
+            CHECK(unit.Author()->Read().size() == 2);
+            CHECK(unit.Book()->ReadByName("The Hobbit").size() == 1);
+            CHECK(unit.Book()->ReadByName("The Hobbi").empty());
+            CHECK(unit.Book()->ReadByName("Zorro").empty());
+            CHECK(unit.Book()->ReadById(rings).year == 1954);
+            CHECK_THROWS(unit.Book()->ReadById(domain::BookId::New().ToString()));
+            CHECK(unit.BookTags()->ReadById(hobbit) == std::vector<std::string>{"adventure", "fantasy"});
+        }
+        THEN("search ranks title matches above author and tag matches") {
+            auto books = unit.Book()->Search("tolkien hobbit", 10, 0);
+            REQUIRE(books.size() == 1);
+            CHECK(books[0].data.id == hobbit);
+            books = unit.Book()->Search("fantasy", 10, 0);
+            REQUIRE(books.size() == 2);
+            CHECK(books[0].data.id == hobbit);
+            CHECK(unit.Book()->Search("fantasy", 10, 1).size() == 1);
+        }
+        THEN("similar names are found by trigrams") {
+            auto authors = unit.Author()->FindSimilar("Jon Tolkien", 0.3, 5);
+            REQUIRE(authors.size() == 1);
+            CHECK(authors[0].first == tolkien);
+            auto books = unit.Book()->FindSimilar("Hobit", 0.3, 5);
+            REQUIRE_FALSE(books.empty());
+            CHECK(books[0].id == hobbit);
+        }
+        THEN("year range and top tags are computed from the image") {
+            auto books = unit.Book()->ReadByYearRange(1930, 1960, 1, 1);
+            REQUIRE(books.size() == 1);
+            CHECK(books[0].id == rings);
+            auto tags = unit.BookTags()->ReadTopTags(1);
+            REQUIRE(tags.size() == 1);
+            CHECK(tags[0] == std::pair<std::string, std::size_t>{"fantasy", 2});
+        }
+        THEN("writes are rejected") {
+            CHECK_THROWS_AS(unit.Author()->DeleteById(tolkien), std::logic_error);
+            CHECK_THROWS_AS(unit.Book()->EditYearById(hobbit, 1938), std::logic_error);
+            CHECK_THROWS_AS(unit.BookTags()->Update({hobbit, {"tale"}}), std::logic_error);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include "../src/postgres/tag_dictionary.h"
+
+using postgres::StagedTags;
+using postgres::TagDictionary;
+
+TEST_CASE("Tag dictionary keeps committed pairs") {
+    TagDictionary dictionary;
+    dictionary.Put({{1, "fantasy"}, {2, "classic"}});
+    CHECK(dictionary.FindId("fantasy") == 1);
+    CHECK(dictionary.FindName(2) == "classic");
+    CHECK_FALSE(dictionary.FindId("poetry").has_value());
+    CHECK_FALSE(dictionary.FindName(3).has_value());
+}
+
+TEST_CASE("Staged tags are visible only to their transaction until commit") {
+    TagDictionary dictionary;
+    dictionary.Put({{1, "fantasy"}});
+    StagedTags staged{dictionary};
+    staged.Add(2, "classic");
+    CHECK(staged.FindId("fantasy") == 1);
+    CHECK(staged.FindId("classic") == 2);
+    CHECK(staged.FindName(2) == "classic");
+    CHECK_FALSE(dictionary.FindId("classic").has_value());
+    CHECK_FALSE(dictionary.FindName(2).has_value());
+
+    staged.Commit();
+    CHECK(dictionary.FindId("classic") == 2);
+    CHECK(dictionary.FindName(2) == "classic");
+    CHECK(dictionary.FindId("fantasy") == 1);
+    StagedTags next{dictionary};
+    CHECK(next.FindId("classic") == 2);
+}
+
+TEST_CASE("Staged tags are discarded on rollback") {
+    TagDictionary dictionary;
+    {
+        StagedTags staged{dictionary};
+        staged.Add(2, "classic");
+    }
+    CHECK_FALSE(dictionary.FindId("classic").has_value());
+    StagedTags next{dictionary};
+    CHECK_FALSE(next.FindId("classic").has_value());
+    CHECK_FALSE(next.FindName(2).has_value());
+}
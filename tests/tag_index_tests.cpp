@@ -0,0 +1,87 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../src/app/tag_index.h"
+#include "../src/util/posting_list.h"
+
+using app::TagIndex;
+using util::PostingList;
+
+namespace {
+
+std::vector<std::string> Sorted(std::vector<std::string> values) {
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+}  // namespace
+
+TEST_CASE("Posting list operations keep lists sorted") {
+    PostingList evens;
+    PostingList threes;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        if (i % 2 == 0) {
+            evens.push_back(i);
+        }
+        if (i % 3 == 0) {
+            threes.push_back(i);
+        }
+    }
+    auto sixes = util::Intersect(evens, threes);
+    CHECK(sixes.size() == 167);
+    CHECK(std::all_of(sixes.begin(), sixes.end(), [](auto v) { return v % 6 == 0; }));
+    CHECK(util::Unite(evens, threes).size() == 500 + 334 - 167);
+    CHECK(util::Subtract(evens, threes).size() == 500 - 167);
+
+    // Галопирующее пересечение короткого списка с длинным
+    PostingList sparse{0, 3, 998, 999};
+    CHECK(util::Intersect(sparse, evens) == PostingList{0, 998});
+    CHECK(util::Intersect(evens, sparse) == PostingList{0, 998});
+    CHECK(util::Intersect(PostingList{}, evens).empty());
+
+    PostingList list{1, 5};
+    CHECK(util::Insert(list, 3));
+    CHECK_FALSE(util::Insert(list, 3));
+    CHECK(util::Insert(list, 7));
+    CHECK(list == PostingList{1, 3, 5, 7});
+    CHECK(util::Erase(list, 5));
+    CHECK_FALSE(util::Erase(list, 5));
+    CHECK(list == PostingList{1, 3, 7});
+}
+
+TEST_CASE("Tag index answers all/any/none queries") {
+    TagIndex index;
+    CHECK_FALSE(index.Find({"fantasy"}, {}, {}).has_value());
+
+    REQUIRE(index.Rebuild(index.GetGeneration(), {"b1", "b2", "b3", "b4"},
+                          {{"b1", "fantasy"}, {"b1", "classic"}, {"b2", "fantasy"}, {"b3", "classic"}}));
+
+    CHECK(Sorted(*index.Find({"fantasy"}, {}, {})) == std::vector<std::string>{"b1", "b2"});
+    CHECK(*index.Find({"fantasy", "classic"}, {}, {}) == std::vector<std::string>{"b1"});
+    CHECK(Sorted(*index.Find({}, {"fantasy", "classic"}, {})) == std::vector<std::string>{"b1", "b2", "b3"});
+    CHECK(Sorted(*index.Find({}, {}, {"fantasy"})) == std::vector<std::string>{"b3", "b4"});
+    CHECK(*index.Find({"classic"}, {}, {"fantasy"}) == std::vector<std::string>{"b3"});
+    CHECK(index.Find({"missing"}, {}, {})->empty());
+
+    index.SetTags("b2", {"classic"});
+    index.AddBook("b5");
+    index.AddTags("b5", {"fantasy"});
+    index.RemoveBook("b1");
+    CHECK(Sorted(*index.Find({}, {}, {"fantasy"})) == std::vector<std::string>{"b2", "b3", "b4"});
+    CHECK(*index.Find({"fantasy"}, {}, {}) == std::vector<std::string>{"b5"});
+}
+
+TEST_CASE("Tag index rebuild is discarded after concurrent changes") {
+    TagIndex index;
+    auto generation = index.GetGeneration();
+    index.AddTags("b1", {"fantasy"});  // индекс ещё не построен
+    CHECK_FALSE(index.Rebuild(generation, {"b1"}, {}));
+    CHECK_FALSE(index.Find({}, {}, {}).has_value());
+
+    REQUIRE(index.Rebuild(index.GetGeneration(), {"b1"}, {{"b1", "fantasy"}}));
+    index.MarkStale();
+    CHECK_FALSE(index.Find({"fantasy"}, {}, {}).has_value());
+}
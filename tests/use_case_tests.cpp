@@ -1,80 +1,457 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
 #include "../src/app/use_cases_impl.h"
-#include "../src/domain/author.h"
-#include "../src/domain/book.h"
+#include "../src/memory/memory_database.h"
 
 namespace {
 
-struct MockAuthorRepository : domain::AuthorRepository {
-    std::vector<domain::Author> saved_authors;
+struct Fixture {
+    memory::Database database;
+    memory::UnitOfWorkFactoryImpl factory{database};
+    memory::CatalogImporterImpl importer{database};
+    memory::CatalogExporterImpl exporter{database};
+};
 
-    void Save(const domain::Author& author) override {
-        saved_authors.emplace_back(author);
+// Запоминает долговечность, с которой use case'ы открывают пишущие unit of work
+class RecordingFactory : public app::UnitOfWorkFactory {
+public:
+    explicit RecordingFactory(app::UnitOfWorkFactory& factory)
+        : factory_{factory} {
     }
-    std::vector<std::pair<std::string, std::string>> Read() {
-        return std::vector<std::pair<std::string, std::string>>();
+
+    std::unique_ptr<app::UnitOfWork> CreateUnitOfWork(const app::UnitOfWorkOptions& options = {}) override {
+        ++created;
+        if (!options.read_only) {
+            writes.push_back(options.durability);
+        }
+        return factory_.CreateUnitOfWork(options);
     }
-};
 
-struct MockBookRepository : domain::BookRepository {
-    std::vector<domain::Book> saved_books;
+    std::vector<app::Durability> writes;
+    std::size_t created = 0;
 
-    void Save(const domain::Book& book) override {
-        saved_books.emplace_back(book);
-    }
-    std::vector<domain::BookData> Read() {
-        return  std::vector<domain::BookData>();
-    }
-    std::vector<domain::BookData> ReadAuthorBooks(const std::string& author_id) {
-        return std::vector<domain::BookData>();
-    }
+private:
+    app::UnitOfWorkFactory& factory_;
 };
 
-struct MockBookTagsRepository : domain::BookTagsRepository {
-    std::vector<domain::BookTags> saved_book_tags;
-
-    void Save(const domain::BookTags& book_tags) override {
-        saved_book_tags.emplace_back(book_tags);
+// Поток изменений, в который тест сам публикует изменения "другого процесса"
+class ManualChangeFeed : public app::ChangeFeed {
+public:
+    std::size_t Subscribe(app::ChangeHandler handler) override {
+        handler_ = std::move(handler);
+        return 1;
     }
-    std::vector<std::pair<std::string, std::string>> Read() {
-        return  std::vector<std::pair<std::string, std::string>>();
+    void Unsubscribe(std::size_t) override {
+        handler_ = nullptr;
     }
-};
 
-struct MockUnitOfWorkImpl : app::UnitOfWork{
-    MockAuthorRepository* Author();
-    MockBookRepository* Book();
-    MockBookTagsRepository* BookTags();
-   void Commit();
-};
-
-struct MockUnitOfWorkFactoryImpl : public app::UnitOfWorkFactory {
-
-    app::UnitOfWork* CreateUnitOfWork() override{
-        return new MockUnitOfWorkImpl();
+    void Publish(const app::ChangeEvent& event) {
+        if (handler_) {
+            handler_(event);
+        }
     }
-};
 
-struct Fixture {
-    MockUnitOfWorkFactoryImpl factory;
+private:
+    app::ChangeHandler handler_;
 };
 
 }  // namespace
 
-SCENARIO_METHOD(Fixture, "Book Adding") {
+SCENARIO_METHOD(Fixture, "Author Adding") {
     GIVEN("Use cases") {
         app::UseCasesImpl use_cases{factory};
 
         WHEN("Adding an author") {
             const auto author_name = "Joanne Rowling";
-            use_cases.AddAuthor(author_name);
+            auto author_id = use_cases.AddAuthor(author_name);
+
+            THEN("author with the specified name is saved to repository") {
+                auto authors = use_cases.ShowAuthors();
+                REQUIRE(authors.size() == 1);
+                CHECK(authors.at(0).first == author_id);
+                CHECK(authors.at(0).second == author_name);
+            }
+            THEN("an author with the same name is rejected") {
+                CHECK_THROWS_AS(use_cases.AddAuthor(author_name), std::logic_error);
+                CHECK(use_cases.ShowAuthors().size() == 1);
+            }
+        }
+        WHEN("Adding several authors") {
+            use_cases.AddAuthor("Leo Tolstoy");
+            use_cases.AddAuthor("Alexander Pushkin");
+            use_cases.AddAuthor("Fyodor Dostoevsky");
+
+            THEN("authors are listed by name") {
+                auto authors = use_cases.ShowAuthors();
+                REQUIRE(authors.size() == 3);
+                CHECK(authors.at(0).second == "Alexander Pushkin");
+                CHECK(authors.at(1).second == "Fyodor Dostoevsky");
+                CHECK(authors.at(2).second == "Leo Tolstoy");
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Book Adding") {
+    GIVEN("Use cases with an author") {
+        app::UseCasesImpl use_cases{factory};
+        auto tolkien = use_cases.AddAuthor("John Tolkien");
+
+        WHEN("Adding books with tags") {
+            auto rings = use_cases.AddBook(tolkien, "The Lord of the Rings", 1954);
+            auto hobbit = use_cases.AddBook(tolkien, "The Hobbit", 1937);
+            use_cases.AddBookTags(hobbit, {"fantasy", "adventure"});
+            use_cases.AddBookTags(rings, {"fantasy"});
+
+            THEN("books are listed by title with the author name") {
+                auto books = use_cases.ShowBooks();
+                REQUIRE(books.size() == 2);
+                CHECK(books.at(0).title == "The Hobbit");
+                CHECK(books.at(0).author_name == "John Tolkien");
+                CHECK(books.at(1).id == rings);
+            }
+            THEN("author books are listed by year") {
+                auto books = use_cases.ShowAuthorBooks(tolkien);
+                REQUIRE(books.size() == 2);
+                CHECK(books.at(0).id == hobbit);
+            }
+            THEN("a book is shown with sorted tags") {
+                auto book = use_cases.ShowBookById(hobbit);
+                CHECK(book.title == "The Hobbit");
+                CHECK(book.author_name == "John Tolkien");
+                CHECK(book.publication_year == 1937);
+                CHECK(book.tags == std::vector<std::string>{"adventure", "fantasy"});
+            }
+            THEN("books are found by tags, text and year") {
+                CHECK(use_cases.FindBooksByTags({"fantasy"}, {}, {"adventure"}).at(0).id == rings);
+                auto fantasy = use_cases.FindBooksByTags({"fantasy"}, {}, {});
+                REQUIRE(fantasy.size() == 2);
+                CHECK(fantasy.at(0).id == hobbit);
+                CHECK(fantasy.at(0).author_name == "John Tolkien");
+                CHECK(fantasy.at(1).id == rings);
+                CHECK(use_cases.SearchBooks("hobbit", 10).at(0).id == hobbit);
+                auto page = use_cases.ShowBooksByYearRange(1900, 2000, 0, 1);
+                REQUIRE(page.books.size() == 1);
+                CHECK(page.books.at(0).id == hobbit);
+                CHECK(page.has_more);
+            }
+            THEN("tag stats count books") {
+                auto stats = use_cases.TagStats(10);
+                REQUIRE(stats.size() == 2);
+                CHECK(stats.at(0) == std::pair<std::string, std::size_t>{"fantasy", 2});
+            }
+            THEN("names are completed by prefix") {
+                auto completions = use_cases.Autocomplete("the", 10);
+                CHECK(completions.titles == std::vector<std::string>{"The Hobbit", "The Lord of the Rings"});
+                CHECK(use_cases.Autocomplete("john", 10).authors == std::vector<std::string>{"John Tolkien"});
+            }
+        }
+        WHEN("Adding a book with tags and a new author at once") {
+            auto dune = use_cases.AddBookWithTags({{}, "Frank Herbert"}, "Dune", 1965, {"sci-fi", "desert"});
+            auto hobbit = use_cases.AddBookWithTags({tolkien, {}}, "The Hobbit", 1937, {});
+
+            THEN("the author, the books and the tags are saved") {
+                auto authors = use_cases.ShowAuthors();
+                REQUIRE(authors.size() == 2);
+                CHECK(authors.at(0).second == "Frank Herbert");
+                auto book = use_cases.ShowBookById(dune);
+                CHECK(book.author_name == "Frank Herbert");
+                CHECK(book.tags == std::vector<std::string>{"desert", "sci-fi"});
+                CHECK(use_cases.ShowBookById(hobbit).tags.empty());
+                CHECK(use_cases.FindBooksByTags({"desert"}, {}, {}).at(0).id == dune);
+                CHECK(use_cases.Autocomplete("fra", 10).authors == std::vector<std::string>{"Frank Herbert"});
+            }
+        }
+        WHEN("Adding a book with a new author that already exists") {
+            THEN("nothing is saved") {
+                CHECK_THROWS_AS(use_cases.AddBookWithTags({{}, "John Tolkien"}, "Dune", 1965, {"sci-fi"}),
+                                std::logic_error);
+                CHECK(use_cases.ShowAuthors().size() == 1);
+                CHECK(use_cases.ShowBooks().empty());
+                CHECK(use_cases.TagStats(10).empty());
+            }
+        }
+        WHEN("Adding a book of an unknown author") {
+            THEN("the book is rejected") {
+                CHECK_THROWS_AS(use_cases.AddBook(domain::AuthorId::New().ToString(), "Dune", 1965),
+                                std::logic_error);
+                CHECK(use_cases.ShowBooks().empty());
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Catalog Editing") {
+    GIVEN("Use cases with a book") {
+        app::UseCasesImpl use_cases{factory};
+        auto tolkien = use_cases.AddAuthor("John Tolkien");
+        auto hobbit = use_cases.AddBook(tolkien, "The Hobbit", 1937);
+        use_cases.AddBookTags(hobbit, {"fantasy"});
+
+        WHEN("Editing the author and the book") {
+            use_cases.EditAuthorById(tolkien, "J. R. R. Tolkien");
+            use_cases.EditBookTitleById(hobbit, "The Hobbit, or There and Back Again");
+            use_cases.EditBookYearById(hobbit, 1938);
+            use_cases.EditBookTagsById(hobbit, {"tale"});
+
+            THEN("changes are visible") {
+                auto book = use_cases.ShowBookById(hobbit);
+                CHECK(book.title == "The Hobbit, or There and Back Again");
+                CHECK(book.author_name == "J. R. R. Tolkien");
+                CHECK(book.publication_year == 1938);
+                CHECK(book.tags == std::vector<std::string>{"tale"});
+                CHECK(use_cases.ShowAuthorById(tolkien) == "J. R. R. Tolkien");
+                CHECK(use_cases.Autocomplete("J. R.", 10).authors == std::vector<std::string>{"J. R. R. Tolkien"});
+                CHECK(use_cases.Autocomplete("J. R.", 10).author_ids == std::vector<std::string>{tolkien});
+                CHECK(use_cases.Autocomplete("the hobbit,", 10).book_ids == std::vector<std::string>{hobbit});
+                CHECK(use_cases.CountCatalog().authors == 1);
+                CHECK(use_cases.CountCatalog().books == 1);
+                CHECK(use_cases.Autocomplete("John", 10).authors.empty());
+            }
+        }
+        WHEN("Patching only the title") {
+            use_cases.PatchBook(hobbit, "There and Back Again", std::nullopt, std::nullopt);
+
+            THEN("other fields are kept") {
+                auto book = use_cases.ShowBookById(hobbit);
+                CHECK(book.title == "There and Back Again");
+                CHECK(book.publication_year == 1937);
+                CHECK(book.tags == std::vector<std::string>{"fantasy"});
+            }
+        }
+        WHEN("Patching the year and the tags") {
+            use_cases.PatchBook(hobbit, std::nullopt, 1938, std::vector<std::string>{"fantasy", "tale"});
+
+            THEN("both are changed") {
+                auto book = use_cases.ShowBookById(hobbit);
+                CHECK(book.title == "The Hobbit");
+                CHECK(book.publication_year == 1938);
+                CHECK(book.tags == std::vector<std::string>{"fantasy", "tale"});
+                CHECK(use_cases.FindBooksByTags({"tale"}, {}, {}).size() == 1);
+            }
+        }
+        WHEN("Patching an unknown book") {
+            THEN("the use case fails and nothing is changed") {
+                CHECK_THROWS_AS(use_cases.PatchBook(domain::BookId::New().ToString(), "Dune", 1965,
+                                                    std::vector<std::string>{"sci-fi"}),
+                                std::logic_error);
+                CHECK(use_cases.TagStats(10).size() == 1);
+            }
+        }
+        WHEN("Deleting the author") {
+            CHECK(use_cases.ShowAuthorById(tolkien) == "John Tolkien");
+            use_cases.DeleteAuthorById(tolkien);
+
+            THEN("the author books and their tags are deleted too") {
+                CHECK_FALSE(use_cases.ShowAuthorById(tolkien).has_value());
+                CHECK(use_cases.ShowAuthors().empty());
+                CHECK(use_cases.ShowBooks().empty());
+                CHECK(use_cases.TagStats(10).empty());
+            }
+        }
+        WHEN("Deleting the book tags and the book") {
+            use_cases.DeleteBookTagsById(hobbit);
+            use_cases.DeleteBookById(hobbit);
+
+            THEN("the author stays") {
+                CHECK(use_cases.ShowBooks().empty());
+                CHECK(use_cases.ShowAuthors().size() == 1);
+            }
+        }
+        WHEN("Deleting an unknown author") {
+            THEN("the use case fails") {
+                CHECK_THROWS_AS(use_cases.DeleteAuthorById(domain::AuthorId::New().ToString()), std::logic_error);
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Use case sessions") {
+    GIVEN("Use cases with an author") {
+        app::UseCasesImpl use_cases{factory};
+        auto tolkien = use_cases.AddAuthor("John Tolkien");
+
+        WHEN("A read-write session is committed") {
+            auto session = use_cases.OpenSession(false);
+            auto hobbit = use_cases.AddBook(tolkien, "The Hobbit", 1937);
+            use_cases.AddBookTags(hobbit, {"fantasy"});
+            CHECK(use_cases.ShowBookById(hobbit).tags == std::vector<std::string>{"fantasy"});
+            session->Commit();
+
+            THEN("its changes are saved and use cases work without it") {
+                CHECK(use_cases.ShowBooks().size() == 1);
+                use_cases.AddAuthor("Frank Herbert");
+                CHECK(use_cases.ShowAuthors().size() == 2);
+            }
+        }
+        WHEN("A read-write session is closed without commit") {
+            {
+                auto session = use_cases.OpenSession(false);
+                use_cases.EditAuthorById(tolkien, "J. R. R. Tolkien");
+                use_cases.AddBookWithTags({tolkien, {}}, "The Hobbit", 1937, {"fantasy"});
+                CHECK(use_cases.ShowAuthors().at(0).second == "J. R. R. Tolkien");
+                CHECK(use_cases.FindBooksByTags({"fantasy"}, {}, {}).size() == 1);
+            }
+
+            THEN("its changes and derived indexes are rolled back") {
+                CHECK(use_cases.ShowAuthors().at(0).second == "John Tolkien");
+                CHECK(use_cases.ShowBooks().empty());
+                CHECK(use_cases.FindBooksByTags({"fantasy"}, {}, {}).empty());
+                CHECK(use_cases.Autocomplete("j. r.", 10).authors.empty());
+            }
+        }
+        WHEN("A read-only session is open") {
+            auto session = use_cases.OpenSession(true);
+
+            THEN("writes fail and another session cannot be opened") {
+                CHECK(use_cases.ShowAuthors().size() == 1);
+                CHECK_THROWS_AS(use_cases.AddAuthor("Frank Herbert"), std::logic_error);
+                CHECK_THROWS_AS(use_cases.OpenSession(true), std::logic_error);
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Catalog Import") {
+    GIVEN("Use cases with an importer and an existing book") {
+        app::UseCasesConfig config;
+        config.import_batch_size = 2;
+        app::UseCasesImpl use_cases{factory, config, nullptr, nullptr, nullptr, &importer};
+        auto tolkien = use_cases.AddAuthor("John Tolkien");
+        auto hobbit = use_cases.AddBook(tolkien, "The Hobbit", 1937);
+        REQUIRE(use_cases.ShowBooks().size() == 1);
+
+        auto path = std::filesystem::temp_directory_path()
+                    / ("bookypedia_import_test_" + domain::BookId::New().ToString() + ".csv");
+        {
+            std::ofstream out{path};
+            out << "author,title,year,tags\n"
+                << "John Tolkien,The Hobbit,1937,fantasy\n"
+                << "John Tolkien,The Silmarillion,1977,\n"
+                << "Joanne Rowling,Harry Potter,1997,magic\n"
+                << "Joanne Rowling,Harry Potter,1997,\"magic,school\"\n";
+        }
+
+        WHEN("Importing the file") {
+            std::vector<std::size_t> progress;
+            auto stats = use_cases.ImportCatalog(path.string(), app::ImportFormat::kCsv,
+                                                 [&progress](const app::ImportStats& stats) {
+                                                     progress.push_back(stats.records);
+                                                 });
+            std::filesystem::remove(path);
+
+            THEN("new authors and books are added and existing ones are merged") {
+                CHECK(stats.records == 4);
+                CHECK(stats.authors == 1);
+                CHECK(stats.books == 2);
+                CHECK(stats.book_tags == 3);
+                CHECK(progress == std::vector<std::size_t>{2, 4});
+                CHECK(use_cases.ShowAuthors().size() == 2);
+                CHECK(use_cases.ShowBooks().size() == 3);
+                CHECK(use_cases.ShowBookById(hobbit).tags == std::vector<std::string>{"fantasy"});
+                auto potter = use_cases.ShowBooksByTitle("Harry Potter");
+                REQUIRE(potter.size() == 1);
+                CHECK(use_cases.GetBookTagsById(potter.at(0).id) == std::vector<std::string>{"magic", "school"});
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Catalog Export") {
+    GIVEN("Use cases with an exporter and books with the same title") {
+        app::UseCasesImpl use_cases{factory, {}, nullptr, nullptr, nullptr, nullptr, &exporter};
+        auto tolkien = use_cases.AddAuthor("John Tolkien");
+        auto rowling = use_cases.AddAuthor("Joanne Rowling");
+        auto hobbit = use_cases.AddBook(tolkien, "The Hobbit", 1937);
+        use_cases.AddBook(tolkien, "Same", 1954);
+        use_cases.AddBook(rowling, "Same", 1997);
+        use_cases.AddBookTags(hobbit, {"fantasy", "adventure"});
+
+        WHEN("Exporting to CSV") {
+            std::ostringstream output;
+            auto count = use_cases.ExportCatalog(output, app::ImportFormat::kCsv);
+
+            THEN("books are written in the ShowBooks order with tags") {
+                CHECK(count == 3);
+                CHECK(output.str() == "author,title,year,tags\n"
+                                      "Joanne Rowling,Same,1997,\n"
+                                      "John Tolkien,Same,1954,\n"
+                                      "John Tolkien,The Hobbit,1937,\"adventure,fantasy\"\n");
+            }
+        }
+        WHEN("Exporting without an exporter") {
+            app::UseCasesImpl plain{factory};
+            std::ostringstream output;
+
+            THEN("the use case fails") {
+                CHECK_THROWS_AS(plain.ExportCatalog(output, app::ImportFormat::kNdjson), std::logic_error);
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Durability levels") {
+    GIVEN("Use cases with asynchronous tag edits") {
+        RecordingFactory recording{factory};
+        app::UseCasesConfig config;
+        config.tags_durability = app::Durability::kAsync;
+        app::UseCasesImpl use_cases{recording, config};
+
+        WHEN("a book is added and its tags are edited") {
+            auto tolkien = use_cases.AddAuthor("John Tolkien");
+            auto hobbit = use_cases.AddBook(tolkien, "The Hobbit", 1937);
+            use_cases.AddBookTags(hobbit, {"fantasy"});
+            use_cases.EditBookTagsById(hobbit, {"classic", "fantasy"});
+            use_cases.DeleteBookTagsById(hobbit);
+
+            THEN("only tag edits are committed asynchronously") {
+                using app::Durability;
+                CHECK(recording.writes == std::vector{Durability::kStrict, Durability::kStrict, Durability::kAsync,
+                                                      Durability::kAsync, Durability::kAsync});
+                CHECK(use_cases.GetBookTagsById(hobbit).empty());
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Changes of other processes") {
+    GIVEN("Use cases with built name filters and another process on the same database") {
+        RecordingFactory recording{factory};
+        ManualChangeFeed feed;
+        app::UseCasesImpl use_cases{recording, {}, &feed};
+        app::UseCasesImpl other{factory};
+        use_cases.AddAuthor("John Tolkien");
+        CHECK_THROWS_AS(use_cases.DeleteAuthorByName("Nobody"), std::logic_error);
+
+        WHEN("the other process adds an author") {
+            auto herbert = other.AddAuthor("Frank Herbert");
+            feed.Publish({app::EntityType::kAuthor, app::ChangeOp::kInsert, herbert, "Frank Herbert"});
+
+            THEN("the name is added to the filter without rebuilding it") {
+                auto created = recording.created;
+                CHECK_THROWS_AS(use_cases.DeleteAuthorByName("Nobody"), std::logic_error);
+                CHECK(recording.created == created);
+                use_cases.EditAuthorByName("Frank Herbert", "F. Herbert");
+                CHECK(use_cases.Autocomplete("F", 10).authors == std::vector<std::string>{"F. Herbert"});
+            }
+        }
+        WHEN("the other process deletes an author") {
+            auto herbert = other.AddAuthor("Frank Herbert");
+            feed.Publish({app::EntityType::kAuthor, app::ChangeOp::kInsert, herbert, "Frank Herbert"});
+            other.DeleteAuthorById(herbert);
+            feed.Publish({app::EntityType::kAuthor, app::ChangeOp::kDelete, herbert, "Frank Herbert"});
 
-            /*THEN("author with the specified name is saved to repository") {
-                REQUIRE(authors.saved_authors.size() == 1);
-                CHECK(authors.saved_authors.at(0).GetName() == author_name);
-                CHECK(authors.saved_authors.at(0).GetId() != domain::AuthorId{});
-            }*/
+            THEN("the filter is rebuilt and the name is no longer completed") {
+                CHECK(use_cases.Autocomplete("Frank", 10).authors.empty());
+                CHECK_THROWS_AS(use_cases.DeleteAuthorByName("Frank Herbert"), std::logic_error);
+            }
         }
     }
-}
\ No newline at end of file
+}
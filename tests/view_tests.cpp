@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include "../src/app/use_cases_impl.h"
+#include "../src/memory/memory_database.h"
+#include "../src/menu/menu.h"
+#include "../src/ui/view.h"
+
+namespace {
+
+struct Fixture {
+    memory::Database database;
+    memory::UnitOfWorkFactoryImpl factory{database};
+    app::UseCasesImpl use_cases{factory};
+
+    // Выполняет команды из input и возвращает весь вывод
+    std::string Run(const std::string& commands, bool interactive) {
+        std::istringstream input{commands};
+        std::ostringstream output;
+        menu::Menu menu{input, output};
+        ui::View view{menu, use_cases, input, output, interactive};
+        menu.Run();
+        return output.str();
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "Name lookup misses in the View") {
+    GIVEN("An author with a book") {
+        auto tolkien = use_cases.AddAuthor("John Tolkien");
+        use_cases.AddBook(tolkien, "The Hobbit", 1937);
+
+        WHEN("a misspelled author name is followed by another command in piped input") {
+            auto output = Run("DeleteAuthor Jon Tolkien\nShowAuthors\n", false);
+
+            THEN("the suggestions are printed and the next command still runs") {
+                CHECK(output == "Did you mean:\n1 John Tolkien\nFailed to delete author\n1 John Tolkien\n");
+            }
+        }
+        WHEN("a misspelled book title is followed by another command in piped input") {
+            auto output = Run("ShowBook The Hobit\nShowBooks\n", false);
+
+            THEN("the suggestions are printed and the next command still runs") {
+                CHECK(output == "Did you mean:\n1 The Hobbit by John Tolkien, 1937\n"
+                                "1 The Hobbit by John Tolkien, 1937\n");
+            }
+        }
+        WHEN("a misspelled author name is entered interactively") {
+            auto output = Run("DeleteAuthor Jon Tolkien\n1\nShowAuthors\n", true);
+
+            THEN("a suggestion can be chosen") {
+                CHECK(output == "Did you mean:\n1 John Tolkien\nEnter author # or empty line to cancel\n");
+                CHECK(use_cases.ShowAuthors().empty());
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Selecting from long lists in the View") {
+    GIVEN("More authors and books than are listed at once") {
+        for (int i = 0; i < 101; ++i) {
+            char name[16];
+            std::snprintf(name, sizeof(name), "Author %03d", i);
+            auto author = use_cases.AddAuthor(name);
+            use_cases.AddBook(author, std::string{"Book of "} + name, 1900 + i);
+        }
+        auto tolkien = use_cases.AddAuthor("John Tolkien");
+        use_cases.AddBook(tolkien, "The Hobbit", 1937);
+        use_cases.AddBook(tolkien, "The Silmarillion", 1977);
+
+        WHEN("an author is selected") {
+            auto output = Run("ShowAuthorBooks\nJohn\n1\n", false);
+
+            THEN("a prefix is asked first and only matching authors are listed") {
+                CHECK(output == "Select author:\nEnter author name prefix or empty line to cancel:\n"
+                                "1 John Tolkien\nEnter author # or empty line to cancel\n"
+                                "1 The Hobbit, 1937\n2 The Silmarillion, 1977\n");
+            }
+        }
+        WHEN("a book is selected") {
+            auto output = Run("DeleteBook\nthe\n2\nShowAuthorBooks\nJohn\n1\n", false);
+
+            THEN("a prefix is asked first and only matching books are listed") {
+                CHECK(output == "Enter book title prefix or empty line to cancel:\n"
+                                "1 The Hobbit by John Tolkien, 1937\n2 The Silmarillion by John Tolkien, 1977\n"
+                                "Enter the book # or empty line to cancel:\n"
+                                "Select author:\nEnter author name prefix or empty line to cancel:\n"
+                                "1 John Tolkien\nEnter author # or empty line to cancel\n"
+                                "1 The Hobbit, 1937\n");
+            }
+        }
+    }
+}
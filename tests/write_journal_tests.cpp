@@ -0,0 +1,173 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/app/use_cases_impl.h"
+#include "../src/app/write_journal.h"
+#include "../src/memory/memory_database.h"
+
+namespace {
+
+using namespace std::literals;
+
+// Хранилище в памяти: ошибки операций (std::logic_error) постоянны. Первые failures попыток
+// получают временную ошибку, как при потере соединения
+class MemoryTarget : public app::JournalTarget {
+public:
+    explicit MemoryTarget(app::UnitOfWorkFactory& factory)
+        : factory_{factory} {
+    }
+
+    std::unique_ptr<app::UnitOfWork> CreateUnitOfWork() override {
+        if (failures > 0) {
+            --failures;
+            throw std::runtime_error("Connection lost");
+        }
+        return factory_.CreateUnitOfWork();
+    }
+    bool IsPermanentError(const std::exception& error) const override {
+        return dynamic_cast<const std::logic_error*>(&error) != nullptr;
+    }
+    void Recover() override {
+        ++recoveries;
+    }
+
+    int failures = 0;
+    int recoveries = 0;
+
+private:
+    app::UnitOfWorkFactory& factory_;
+};
+
+struct Fixture {
+    memory::Database database;
+    memory::UnitOfWorkFactoryImpl factory{database};
+    MemoryTarget target{factory};
+    std::filesystem::path path = std::filesystem::temp_directory_path()
+                                 / ("bookypedia_journal_test_" + domain::BookId::New().ToString());
+
+    ~Fixture() {
+        std::filesystem::remove(path);
+    }
+
+    app::WriteJournalConfig Config() const {
+        return {path.string(), 256, 1ms};
+    }
+
+    std::vector<std::pair<std::string, std::string>> ReadAuthors() {
+        return factory.CreateUnitOfWork({.read_only = true})->Author()->Read();
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "Write-behind journal") {
+    GIVEN("Use cases writing through the journal") {
+        app::JournalUnitOfWorkFactory journal{target, factory, Config()};
+        app::UseCasesImpl use_cases{journal};
+
+        WHEN("books are added") {
+            auto tolkien = use_cases.AddAuthor("John Tolkien");
+            auto hobbit = use_cases.AddBook(tolkien, "The Hobbit", 1937);
+            use_cases.PatchBook(hobbit, std::nullopt, 1938, std::vector<std::string>{"fantasy"});
+
+            THEN("reads wait for the journal and see the writes") {
+                auto book = use_cases.ShowBookById(hobbit);
+                CHECK(book.publication_year == 1938);
+                CHECK(book.tags == std::vector<std::string>{"fantasy"});
+                journal.WaitApplied();
+                CHECK(ReadAuthors().size() == 1);
+            }
+        }
+        WHEN("a journaled operation fails when applied") {
+            use_cases.AddAuthor("John Tolkien");
+            use_cases.DeleteAuthorById(domain::AuthorId::New().ToString());
+            use_cases.AddAuthor("Joanne Rowling");
+            journal.WaitApplied();
+
+            THEN("only its unit of work is dropped") {
+                CHECK(journal.GetDroppedCount() == 1);
+                CHECK(ReadAuthors().size() == 2);
+            }
+        }
+        WHEN("the target is temporarily unavailable") {
+            target.failures = 3;
+            use_cases.AddAuthor("John Tolkien");
+            journal.WaitApplied();
+
+            THEN("the unit of work is retried after recovery, not dropped") {
+                CHECK(target.recoveries == 3);
+                CHECK(journal.GetDroppedCount() == 0);
+                CHECK(ReadAuthors().size() == 1);
+            }
+        }
+        WHEN("a dropped unit of work was already seen by the use cases") {
+            std::vector<app::ChangeEvent> events;
+            auto subscription = journal.Subscribe([&events](const app::ChangeEvent& event) {
+                events.push_back(event);
+            });
+            use_cases.DeleteAuthorById(domain::AuthorId::New().ToString());
+            journal.WaitApplied();
+            journal.Unsubscribe(subscription);
+
+            THEN("subscribers are told to reset the catalog") {
+                REQUIRE(events.size() == 1);
+                CHECK(events.at(0).entity == app::EntityType::kCatalog);
+                CHECK(events.at(0).op == app::ChangeOp::kReset);
+                CHECK_FALSE(events.at(0).local);
+            }
+        }
+        WHEN("a write unit of work reads") {
+            auto unit = journal.CreateUnitOfWork();
+            unit->Author()->Save({domain::AuthorId::New(), "John Tolkien"});
+
+            THEN("it sees its own writes and commits directly") {
+                CHECK(unit->Author()->Read().size() == 1);
+                unit->Commit();
+                CHECK(ReadAuthors().size() == 1);
+            }
+        }
+        WHEN("a write unit of work is destroyed without commit") {
+            journal.CreateUnitOfWork()->Author()->Save({domain::AuthorId::New(), "John Tolkien"});
+
+            THEN("nothing is written") {
+                journal.WaitApplied();
+                CHECK(ReadAuthors().empty());
+            }
+        }
+    }
+    GIVEN("A journal left by a stopped process") {
+        auto tolkien = domain::AuthorId::New().ToString();
+        auto rowling = domain::AuthorId::New().ToString();
+        {
+            std::ofstream file{path, std::ios::binary};
+            file << "U1 1\n3 11:author.save 36:" << tolkien << " 12:John Tolkien\n"
+                 << "C1\n"
+                 << "U2 1\n3 11:author.save 36:" << rowling << " 14:Joanne Rowling\n"
+                 << "U3 1\n2 11:author.save 36:" << tolkien.substr(0, 10);
+        }
+
+        WHEN("the journal is opened") {
+            {
+                app::JournalUnitOfWorkFactory journal{target, factory, Config()};
+                journal.WaitApplied();
+            }
+
+            THEN("unapplied records are replayed and the torn tail is discarded") {
+                auto authors = ReadAuthors();
+                REQUIRE(authors.size() == 1);
+                CHECK(authors.at(0).first == rowling);
+            }
+            THEN("the applied journal is truncated on shutdown") {
+                CHECK(std::filesystem::file_size(path) == 0);
+            }
+        }
+    }
+}